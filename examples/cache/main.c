@@ -0,0 +1,113 @@
+#include "memo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/time.h>
+
+/*
+ * Memoizes a slow function with caches of a few capacities, over a
+ * stream of keys where small keys are much more common than big ones,
+ * and compares them with calling the function every time
+ */
+
+#define NKEYS    (1U << 22)
+#define KEYSPACE (1U << 20)
+
+static double timediff (struct timeval start, struct timeval end)
+{
+    return (double) (end.tv_sec - start.tv_sec)
+        + (double) (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* xorshift32 */
+static unsigned next (unsigned * state)
+{
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/*
+ * Number of steps of the Collatz sequence of a (big) number
+ */
+static unsigned slow_func (unsigned key)
+{
+    unsigned long long n = (unsigned long long) key + 1000000007ULL;
+    unsigned steps = 0;
+
+    for (; n != 1; steps++)
+        n = (n % 2 == 0) ?
+            n / 2:
+            3 * n + 1;
+
+    return steps;
+}
+
+int main (void)
+{
+    static const unsigned capacities[] = { 1U << 8, 1U << 12, 1U << 16, 1U << 20 };
+    struct timeval tv[2] = {0};
+    unsigned * keys = malloc(sizeof(*keys) * NKEYS);
+    unsigned state = 2463534242U;
+    unsigned long long expected = 0;
+    int ret = EXIT_FAILURE;
+
+    if (keys == NULL)
+        goto out;
+
+    /* the smaller the key, the (much) more likely */
+    for (unsigned i = 0; i < NKEYS; i++) {
+        unsigned bound = next(&state) % KEYSPACE + 1;
+        bound = next(&state) % bound + 1;
+        keys[i] = next(&state) % bound;
+    }
+
+    printf("%u keys out of %u possible\n\n", NKEYS, KEYSPACE);
+    printf("%-10s %8s %8s %10s\n", "capacity", "time", "hits", "evictions");
+
+    gettimeofday(tv + 0, NULL);
+    for (unsigned i = 0; i < NKEYS; i++)
+        expected += slow_func(keys[i]);
+    gettimeofday(tv + 1, NULL);
+    printf("%-10s %8.3f\n", "none", timediff(tv[0], tv[1]));
+
+    for (unsigned c = 0; c < sizeof(capacities) / sizeof(*capacities); c++) {
+        struct memo memo = {0};
+        unsigned long long sum = 0;
+
+        if (!memo_new(&memo, capacities[c]))
+            goto out;
+
+        gettimeofday(tv + 0, NULL);
+        for (unsigned i = 0; i < NKEYS; i++) {
+            bool inserted = false;
+            unsigned * value = memo_entry(&memo, keys[i], &inserted);
+            if (value == NULL) {
+                memo = memo_free(memo);
+                goto out;
+            }
+            if (inserted)
+                *value = slow_func(keys[i]);
+            sum += *value;
+        }
+        gettimeofday(tv + 1, NULL);
+
+        printf("%-10u %8.3f %7.2f%% %10lu%s\n",
+                capacities[c],
+                timediff(tv[0], tv[1]),
+                100.0 * (double) memo.hits / (double) (memo.hits + memo.misses),
+                memo.evictions,
+                (sum == expected) ? "" : " (wrong results!)");
+
+        memo = memo_free(memo);
+    }
+
+    ret = EXIT_SUCCESS;
+
+out:
+    free(keys);
+    return ret;
+}
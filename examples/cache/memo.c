@@ -0,0 +1,13 @@
+static int unsigned_cmp (unsigned a, unsigned b)
+{
+    return (a < b) ?
+        -1:
+        (a > b) ?
+        1:
+        0;
+}
+
+#define MAP_CFG_KEY_CMP unsigned_cmp
+#define MAP_CFG_IMPLEMENTATION
+#define CACHE_CFG_IMPLEMENTATION
+#include "memo.h"
@@ -0,0 +1,19 @@
+#ifndef _MEMO_H
+#define _MEMO_H
+
+/* The index of the cache, from each key to its slot */
+#define MAP_CFG_MAP memoidx
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_HASH_INT
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_ROBIN_HOOD
+#include <utils/map.h>
+
+#define CACHE_CFG_MAP memoidx
+#define CACHE_CFG_CACHE memo
+#define CACHE_CFG_KEY_DATA_TYPE unsigned
+#define CACHE_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/cache.h>
+
+#endif /* _MEMO_H */
@@ -0,0 +1,8 @@
+#ifndef _CMAPBENCH_H
+#define _CMAPBENCH_H
+
+#include "maps/bigcmap.h"
+#include "maps/rwcmap.h"
+#include "maps/spincmap.h"
+
+#endif /* _CMAPBENCH_H */
@@ -0,0 +1,121 @@
+#include "cmapbench.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/time.h>
+
+/*
+ * Measures the throughput of a concurrent map under a mixed load (80%
+ * lookups, 10% insertions and 10% removals of random keys), with more
+ * and more threads. bigcmap has a single lock (the usual lock around a
+ * map), rwcmap and spincmap have 64 shards, with reader/writer locks and
+ * spinlocks respectively
+ */
+
+#define NKEYS (1U << 20)
+#define NOPS  (1U << 22)
+
+static double timediff (struct timeval start, struct timeval end)
+{
+    return (double) (end.tv_sec - start.tv_sec)
+        + (double) (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* xorshift32 */
+static unsigned next_rand (unsigned * state)
+{
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/*
+ * Fills the map with half of the keys, then starts @a nthreads threads,
+ * that run NOPS operations each. Prints the number of operations per
+ * second
+ */
+#define BENCH(CMAP)                                                     \
+    static struct CMAP CMAP##_shared = {0};                             \
+                                                                        \
+    static void * CMAP##_work (void * arg)                              \
+    {                                                                   \
+        unsigned state = (unsigned) (size_t) arg + 1;                   \
+        unsigned found = 0;                                             \
+                                                                        \
+        for (unsigned i = 0; i < NOPS; i++) {                           \
+            unsigned r = next_rand(&state);                             \
+            unsigned key = r % NKEYS;                                   \
+            unsigned op = (r >> 24) % 10;                               \
+                                                                        \
+            if (op == 0)                                                \
+                CMAP##_add(&CMAP##_shared, key, i);                     \
+            else if (op == 1)                                           \
+                CMAP##_remove(&CMAP##_shared, key, NULL);               \
+            else                                                        \
+                found += CMAP##_contains(&CMAP##_shared, key);          \
+        }                                                               \
+                                                                        \
+        return (void *) (size_t) found;                                 \
+    }                                                                   \
+                                                                        \
+    static void bench_##CMAP (unsigned nthreads)                        \
+    {                                                                   \
+        pthread_t * threads = malloc(sizeof(*threads) * nthreads);      \
+        struct timeval tv[2] = {0};                                     \
+        unsigned started = 0;                                           \
+                                                                        \
+        if (threads == NULL || !CMAP##_reserve(&CMAP##_shared, NKEYS))  \
+            goto out;                                                   \
+                                                                        \
+        for (unsigned i = 0; i < NKEYS; i += 2)                         \
+            CMAP##_add(&CMAP##_shared, i, i);                           \
+                                                                        \
+        gettimeofday(tv + 0, NULL);                                     \
+        for (; started < nthreads; started++)                           \
+            if (pthread_create(threads + started, NULL, CMAP##_work,    \
+                        (void *) (size_t) started) != 0)                \
+                break;                                                  \
+                                                                        \
+        for (unsigned i = 0; i < started; i++)                          \
+            pthread_join(threads[i], NULL);                             \
+        gettimeofday(tv + 1, NULL);                                     \
+                                                                        \
+        printf("%-9s %7u %10.6f %12.0f%s\n",                            \
+                #CMAP, nthreads,                                        \
+                timediff(tv[0], tv[1]),                                 \
+                (double) started * NOPS / timediff(tv[0], tv[1]),       \
+                (started == nthreads) ? "" : " (couldn't start all!)"); \
+                                                                        \
+    out:                                                                \
+        CMAP##_shared = CMAP##_free(CMAP##_shared);                     \
+        free(threads);                                                  \
+    }
+
+BENCH(bigcmap)
+BENCH(rwcmap)
+BENCH(spincmap)
+
+#undef BENCH
+
+int main (int argc, char ** argv)
+{
+    unsigned max_threads = (argc > 1) ?
+        (unsigned) strtoul(argv[1], NULL, 10):
+        8;
+
+    printf("%u operations per thread, times in seconds\n\n", NOPS);
+    printf("%-9s %7s %10s %12s\n", "map", "threads", "time", "ops/s");
+
+    for (unsigned n = 1; n <= max_threads; n *= 2) {
+        bench_bigcmap(n);
+        bench_rwcmap(n);
+        bench_spincmap(n);
+        putchar('\n');
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,17 @@
+#ifndef _BIG_CMAP_H
+#define _BIG_CMAP_H
+
+/* a single lock around a single map, the baseline */
+#define MAP_CFG_MAP bigshard
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#define CMAP_CFG_CMAP bigcmap
+#define CMAP_CFG_MAP bigshard
+#define CMAP_CFG_KEY_DATA_TYPE unsigned
+#define CMAP_CFG_VALUE_DATA_TYPE unsigned
+#define CMAP_CFG_SHARD_BITS 0
+#include <utils/cmap.h>
+
+#endif /* _BIG_CMAP_H */
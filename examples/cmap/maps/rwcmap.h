@@ -0,0 +1,16 @@
+#ifndef _RW_CMAP_H
+#define _RW_CMAP_H
+
+/* the default: 64 shards, each with a reader/writer lock */
+#define MAP_CFG_MAP rwshard
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#define CMAP_CFG_CMAP rwcmap
+#define CMAP_CFG_MAP rwshard
+#define CMAP_CFG_KEY_DATA_TYPE unsigned
+#define CMAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/cmap.h>
+
+#endif /* _RW_CMAP_H */
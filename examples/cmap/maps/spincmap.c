@@ -0,0 +1,21 @@
+/* a weak hash, the shards mix it before using it */
+static unsigned unsigned_hash (unsigned key)
+{
+    return key;
+}
+
+static int unsigned_cmp (unsigned a, unsigned b)
+{
+    return (a < b) ?
+        -1:
+        (a > b) ?
+        1:
+        0;
+}
+
+#define MAP_CFG_KEY_CMP unsigned_cmp
+#define MAP_CFG_HASH_FUNC unsigned_hash
+#define MAP_CFG_IMPLEMENTATION
+#define CMAP_CFG_HASH_FUNC unsigned_hash
+#define CMAP_CFG_IMPLEMENTATION
+#include "spincmap.h"
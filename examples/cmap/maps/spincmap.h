@@ -0,0 +1,17 @@
+#ifndef _SPIN_CMAP_H
+#define _SPIN_CMAP_H
+
+/* 64 shards, each with a spinlock */
+#define MAP_CFG_MAP spinshard
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#define CMAP_CFG_CMAP spincmap
+#define CMAP_CFG_MAP spinshard
+#define CMAP_CFG_KEY_DATA_TYPE unsigned
+#define CMAP_CFG_VALUE_DATA_TYPE unsigned
+#define CMAP_CFG_SPINLOCK
+#include <utils/cmap.h>
+
+#endif /* _SPIN_CMAP_H */
@@ -0,0 +1,232 @@
+#include <utils/hash.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/time.h>
+
+/*
+ * Measures the hash functions of `hash.h`: their throughput, and how
+ * well they spread a few kinds of keys that are common in practice
+ * (sequential and strided integers, the addresses of an array's
+ * elements, and strings like "key123") over a power of two table (low
+ * bits of the hash, MAP_CFG_POW2_MASK) and a prime sized table (`hash %
+ * size`, the default MAP_MOD()). The identity (for integers and
+ * pointers) and djb2 (for strings) are there to compare
+ */
+
+#define NKEYS   (1U << 20)
+#define NROUNDS 16
+
+/* 2^16 and the biggest prime smaller than it */
+#define POW2_SIZE  (1U << 16)
+#define PRIME_SIZE 65521U
+
+#define KEY_LEN 16
+
+static double timediff (struct timeval start, struct timeval end)
+{
+    return (double) (end.tv_sec - start.tv_sec)
+        + (double) (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static uint64_t hash_identity (uint64_t key, uint64_t seed)
+{
+    (void) seed;
+    return key;
+}
+
+static uint64_t hash_u32_wrap (uint64_t key, uint64_t seed)
+{
+    return hash_u32((uint32_t) key, seed);
+}
+
+static uint64_t hash_ptr_wrap (uint64_t key, uint64_t seed)
+{
+    return hash_ptr((const void *) (uintptr_t) key, seed);
+}
+
+static uint64_t hash_djb2 (const char * str, uint64_t seed)
+{
+    uint64_t h = 5381 ^ seed;
+    for (; *str != '\0'; str++)
+        h = h * 33 + (unsigned char) *str;
+    return h;
+}
+
+/*
+ * Hashes @a n 64-bit keys NROUNDS times, and prints the number of hashes
+ * per second
+ */
+static void bench_int (const char * name, uint64_t (* hash) (uint64_t, uint64_t), const uint64_t * keys, size_t n)
+{
+    struct timeval tv[2] = {0};
+    uint64_t sum = 0;
+
+    gettimeofday(tv + 0, NULL);
+    for (uint64_t r = 0; r < NROUNDS; r++)
+        for (size_t i = 0; i < n; i++)
+            sum += hash(keys[i], r);
+    gettimeofday(tv + 1, NULL);
+
+    printf("%-12s %8s %10.1f Mhash/s (%016llx)\n",
+            name, "-",
+            (double) n * NROUNDS / timediff(tv[0], tv[1]) / 1e6,
+            (unsigned long long) sum);
+}
+
+/*
+ * Hashes @a size bytes, @a len bytes at a time, NROUNDS times, and
+ * prints the number of bytes per second
+ */
+static void bench_bytes (const unsigned char * data, size_t size, size_t len)
+{
+    struct timeval tv[2] = {0};
+    uint64_t sum = 0;
+
+    gettimeofday(tv + 0, NULL);
+    for (uint64_t r = 0; r < NROUNDS; r++)
+        for (size_t i = 0; i + len <= size; i += len)
+            sum += hash_bytes(data + i, len, r);
+    gettimeofday(tv + 1, NULL);
+
+    printf("%-12s %8zu %10.3f GB/s    (%016llx)\n",
+            "hash_bytes", len,
+            (double) (size / len * len) * NROUNDS / timediff(tv[0], tv[1]) / 1e9,
+            (unsigned long long) sum);
+}
+
+/*
+ * Hashes the @a n strings of @a strs (KEY_LEN bytes apart) NROUNDS
+ * times, and prints the number of hashes per second
+ */
+static void bench_str (const char * name, uint64_t (* hash) (const char *, uint64_t), const char * strs, size_t n)
+{
+    struct timeval tv[2] = {0};
+    uint64_t sum = 0;
+
+    gettimeofday(tv + 0, NULL);
+    for (uint64_t r = 0; r < NROUNDS; r++)
+        for (size_t i = 0; i < n; i++)
+            sum += hash(strs + i * KEY_LEN, r);
+    gettimeofday(tv + 1, NULL);
+
+    printf("%-12s %8s %10.1f Mhash/s (%016llx)\n",
+            name, "\"key%u\"",
+            (double) n * NROUNDS / timediff(tv[0], tv[1]) / 1e6,
+            (unsigned long long) sum);
+}
+
+/*
+ * Prints the chi-squared statistic of the bucket counts of @a counts,
+ * divided by its expected value (so ~1 is as good as random, and bigger
+ * is worse), and the biggest bucket
+ */
+static void print_quality (const unsigned * counts, unsigned size, size_t n)
+{
+    double expected = (double) n / size;
+    double chi2 = 0;
+    unsigned max = 0;
+
+    for (unsigned i = 0; i < size; i++) {
+        double d = counts[i] - expected;
+        chi2 += d * d / expected;
+        if (counts[i] > max)
+            max = counts[i];
+    }
+
+    printf(" %10.2f %5u", chi2 / (size - 1), max);
+}
+
+/*
+ * Spreads the hashes of @a n keys over the power of two and the prime
+ * sized tables, and prints the quality of both
+ */
+static void quality (const char * name, const char * keys_name, const uint64_t * hashes, size_t n)
+{
+    static unsigned pow2[POW2_SIZE];
+    static unsigned prime[PRIME_SIZE];
+
+    memset(pow2, 0, sizeof(pow2));
+    memset(prime, 0, sizeof(prime));
+
+    for (size_t i = 0; i < n; i++) {
+        pow2[hashes[i] & (POW2_SIZE - 1)]++;
+        prime[hashes[i] % PRIME_SIZE]++;
+    }
+
+    printf("%-12s %-8s", name, keys_name);
+    print_quality(pow2, POW2_SIZE, n);
+    print_quality(prime, PRIME_SIZE, n);
+    putchar('\n');
+}
+
+int main (void)
+{
+    /* 64 byte elements, like a small struct */
+    struct { unsigned char pad[64]; } * elems = malloc(sizeof(*elems) * NKEYS);
+    uint64_t * seq = malloc(sizeof(*seq) * NKEYS);
+    uint64_t * stride = malloc(sizeof(*stride) * NKEYS);
+    uint64_t * ptrs = malloc(sizeof(*ptrs) * NKEYS);
+    uint64_t * hashes = malloc(sizeof(*hashes) * NKEYS);
+    char * strs = malloc(KEY_LEN * NKEYS);
+    int ret = EXIT_FAILURE;
+
+    if (elems == NULL || seq == NULL || stride == NULL || ptrs == NULL || hashes == NULL || strs == NULL)
+        goto out;
+
+    memset(elems, 0, sizeof(*elems) * NKEYS);
+    for (unsigned i = 0; i < NKEYS; i++) {
+        seq[i] = i;
+        stride[i] = (uint64_t) i << 10;
+        ptrs[i] = (uint64_t) (uintptr_t) (elems + i);
+        snprintf(strs + (size_t) i * KEY_LEN, KEY_LEN, "key%u", i);
+    }
+
+    printf("Throughput, %u keys %u times\n\n", NKEYS, NROUNDS);
+    printf("%-12s %8s %10s\n", "hash", "len", "speed");
+    bench_int("identity", hash_identity, seq, NKEYS);
+    bench_int("hash_u32", hash_u32_wrap, seq, NKEYS);
+    bench_int("hash_u64", hash_u64, seq, NKEYS);
+    bench_int("hash_ptr", hash_ptr_wrap, ptrs, NKEYS);
+    bench_str("djb2", hash_djb2, strs, NKEYS);
+    bench_str("hash_str", hash_str, strs, NKEYS);
+    for (size_t len = 4; len <= 4096; len *= 4)
+        bench_bytes((const unsigned char *) elems, sizeof(*elems) * NKEYS, len);
+
+    printf("\nDistribution of %u keys, chi-squared / expected (~1 is good) and biggest bucket\n\n", NKEYS);
+    printf("%-12s %-8s %10s %5s %10s %5s\n", "hash", "keys", "2^16", "max", "65521", "max");
+
+#define QUALITY(NAME, KEYS, EXPR)               \
+    do {                                        \
+        for (size_t i = 0; i < NKEYS; i++)      \
+            hashes[i] = (EXPR);                 \
+        quality(NAME, KEYS, hashes, NKEYS);     \
+    } while (0)
+
+    QUALITY("identity", "seq",    seq[i]);
+    QUALITY("identity", "stride", stride[i]);
+    QUALITY("identity", "ptr",    ptrs[i]);
+    QUALITY("hash_u32", "seq",    hash_u32((uint32_t) seq[i], 0));
+    QUALITY("hash_u32", "stride", hash_u32((uint32_t) stride[i], 0));
+    QUALITY("hash_u64", "seq",    hash_u64(seq[i], 0));
+    QUALITY("hash_u64", "stride", hash_u64(stride[i], 0));
+    QUALITY("hash_ptr", "ptr",    hash_ptr(elems + i, 0));
+    QUALITY("djb2",     "str",    hash_djb2(strs + i * KEY_LEN, 0));
+    QUALITY("hash_str", "str",    hash_str(strs + i * KEY_LEN, 0));
+
+#undef QUALITY
+
+    ret = EXIT_SUCCESS;
+
+out:
+    free(elems);
+    free(seq);
+    free(stride);
+    free(ptrs);
+    free(hashes);
+    free(strs);
+    return ret;
+}
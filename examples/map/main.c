@@ -53,12 +53,15 @@ int main (void)
 #endif
     }
 
+    /* the table grows as entries are added */
+    unsigned size = map.size;
+
     gtod();
     map = map_free(map);
     gtod();
 
     size_t min = map_data_mem_usage(MAP_NELEMS);
-    size_t used = map_expected_mem_usage(MAP_SIZE, MAP_NELEMS);
+    size_t used = map_expected_mem_usage(size, MAP_NELEMS);
     print(sizeof(struct map));
     printf("\n"
             "# of entries:           %u\n"
@@ -68,8 +71,8 @@ int main (void)
             "used:                   %zuB (%zuM)\n"
             "used/min:               %lf\n",
             MAP_NELEMS,
-            MAP_SIZE,
-            MAP_NELEMS / MAP_SIZE,
+            size,
+            MAP_NELEMS / size,
             min, min >> 20,
             used, used >> 20,
             (double) used / (double) min);
@@ -0,0 +1,447 @@
+#include "mapbench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/time.h>
+
+/*
+ * Compares the default MAP_MOD() index with the power of two table
+ * sizes of MAP_CFG_POW2 (Fibonacci hashing) and MAP_CFG_POW2_MASK (low
+ * bits of the hash). Every map uses the identity as hash function, so
+ * the strided keys show how each one copes with a weak hash
+ */
+
+#define NELEMS (1U << 20)
+#define STRIDE (1U << 10)
+
+/* bigger than the caches, so most lookups miss */
+#define BATCH_NELEMS (1U << 22)
+
+static double timediff (struct timeval start, struct timeval end)
+{
+    return (double) (end.tv_sec - start.tv_sec)
+        + (double) (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+static unsigned key_seq (unsigned i)
+{
+    return i;
+}
+
+static unsigned key_stride (unsigned i)
+{
+    return i * STRIDE;
+}
+
+/* xorshift32, a bijection, so there are no repeated keys */
+static unsigned key_rand (unsigned i)
+{
+    unsigned x = i + 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+/*
+ * Inserts NELEMS keys, looks all of them up, and looks up NELEMS keys
+ * that aren't in the map. Prints the time each step took, and the
+ * final table size
+ */
+#define BENCH(MAP)                                                      \
+    static void bench_##MAP (const char * name, unsigned (* key) (unsigned)) \
+    {                                                                   \
+        struct MAP map = {0};                                           \
+        struct timeval tv[4] = {0};                                     \
+        unsigned found = 0;                                             \
+                                                                        \
+        if (!MAP##_new(&map))                                           \
+            return;                                                     \
+                                                                        \
+        gettimeofday(tv + 0, NULL);                                     \
+        for (unsigned i = 0; i < NELEMS; i++)                           \
+            MAP##_add(&map, key(i), i);                                 \
+                                                                        \
+        gettimeofday(tv + 1, NULL);                                     \
+        for (unsigned i = 0; i < NELEMS; i++)                           \
+            found += MAP##_contains(&map, key(i));                      \
+                                                                        \
+        gettimeofday(tv + 2, NULL);                                     \
+        for (unsigned i = NELEMS; i < 2 * NELEMS; i++)                  \
+            found += MAP##_contains(&map, key(i));                      \
+                                                                        \
+        gettimeofday(tv + 3, NULL);                                     \
+                                                                        \
+        printf("%-8s %-8s %9u %10.6f %10.6f %10.6f %10.6f%s\n",         \
+                #MAP, name, map.size,                                   \
+                timediff(tv[0], tv[1]),                                 \
+                timediff(tv[1], tv[2]),                                 \
+                timediff(tv[2], tv[3]),                                 \
+                timediff(tv[0], tv[3]),                                 \
+                (found == NELEMS) ? "" : " (wrong count!)");            \
+                                                                        \
+        map = MAP##_free(map);                                          \
+    }
+
+BENCH(modmap)
+BENCH(fibmap)
+BENCH(maskmap)
+
+#undef BENCH
+
+/*
+ * Looks up BATCH_NELEMS random keys, half of them in the map, one at a
+ * time with modmap_contains(), and all at once with
+ * modmap_contains_many()
+ */
+static void bench_batch (void)
+{
+    struct modmap map = {0};
+    struct timeval tv[3] = {0};
+    unsigned * keys = malloc(sizeof(*keys) * BATCH_NELEMS);
+    bool * found = malloc(sizeof(*found) * BATCH_NELEMS);
+    unsigned n1 = 0;
+    unsigned n2 = 0;
+
+    if (keys == NULL || found == NULL || !modmap_reserve(&map, BATCH_NELEMS))
+        goto out;
+
+    for (unsigned i = 0; i < BATCH_NELEMS; i++)
+        modmap_add(&map, key_rand(i), i);
+
+    for (unsigned i = 0; i < BATCH_NELEMS; i++)
+        keys[i] = key_rand((unsigned) rand() % (2 * BATCH_NELEMS));
+
+    gettimeofday(tv + 0, NULL);
+    for (unsigned i = 0; i < BATCH_NELEMS; i++)
+        n1 += modmap_contains(&map, keys[i]);
+
+    gettimeofday(tv + 1, NULL);
+    n2 = modmap_contains_many(&map, keys, BATCH_NELEMS, found);
+    gettimeofday(tv + 2, NULL);
+
+    printf("%u lookups, %u entries\n"
+            "one at a time: %10.6f\n"
+            "batched:       %10.6f%s\n",
+            BATCH_NELEMS, modmap_cardinal(&map),
+            timediff(tv[0], tv[1]),
+            timediff(tv[1], tv[2]),
+            (n1 == n2) ? "" : " (wrong count!)");
+
+out:
+    map = modmap_free(map);
+    free(found);
+    free(keys);
+}
+
+/*
+ * Builds a map with BATCH_NELEMS random keys, adding them one at a time
+ * with modmap_add(), and all at once with modmap_from_arrays() and more
+ * and more threads
+ */
+static void bench_build (unsigned max_threads)
+{
+    struct modmap map = {0};
+    struct timeval tv[2] = {0};
+    unsigned * keys = malloc(sizeof(*keys) * BATCH_NELEMS);
+
+    if (keys == NULL)
+        return;
+
+    for (unsigned i = 0; i < BATCH_NELEMS; i++)
+        keys[i] = key_rand(i);
+
+    gettimeofday(tv + 0, NULL);
+    if (modmap_new(&map))
+        for (unsigned i = 0; i < BATCH_NELEMS; i++)
+            modmap_add(&map, keys[i], keys[i]);
+    gettimeofday(tv + 1, NULL);
+
+    printf("\n%u entries\n"
+            "one at a time:       %10.6f%s\n",
+            BATCH_NELEMS,
+            timediff(tv[0], tv[1]),
+            (modmap_cardinal(&map) == BATCH_NELEMS) ? "" : " (wrong count!)");
+    map = modmap_free(map);
+
+    for (unsigned n = 1; n <= max_threads; n *= 2) {
+        gettimeofday(tv + 0, NULL);
+        bool ok = modmap_from_arrays(&map, keys, keys, BATCH_NELEMS, n);
+        gettimeofday(tv + 1, NULL);
+
+        printf("from arrays, %2u thr: %10.6f%s\n",
+                n,
+                timediff(tv[0], tv[1]),
+                (ok && modmap_cardinal(&map) == BATCH_NELEMS) ? "" : " (wrong count!)");
+        map = modmap_free(map);
+    }
+
+    free(keys);
+}
+
+/*
+ * Doubles the size of a map with BATCH_NELEMS random keys, with
+ * modmap_resize(), and with modmap_resize_parallel() and more and more
+ * threads
+ */
+static void bench_resize (unsigned max_threads)
+{
+    struct modmap map = {0};
+    struct timeval tv[2] = {0};
+
+    if (!modmap_reserve(&map, BATCH_NELEMS))
+        return;
+
+    for (unsigned i = 0; i < BATCH_NELEMS; i++)
+        modmap_add(&map, key_rand(i), i);
+
+    unsigned size = map.size;
+
+    gettimeofday(tv + 0, NULL);
+    bool ok = modmap_resize(&map, 2 * size);
+    gettimeofday(tv + 1, NULL);
+
+    printf("\n%u entries, %u -> %u entry arrays\n"
+            "resize:              %10.6f%s\n",
+            BATCH_NELEMS, size, 2 * size,
+            timediff(tv[0], tv[1]),
+            (ok && modmap_cardinal(&map) == BATCH_NELEMS) ? "" : " (wrong count!)");
+
+    for (unsigned n = 1; n <= max_threads; n *= 2) {
+        /* back to the original size, without timing it */
+        ok = modmap_resize_parallel(&map, size, max_threads);
+
+        gettimeofday(tv + 0, NULL);
+        ok = ok && modmap_resize_parallel(&map, 2 * size, n);
+        gettimeofday(tv + 1, NULL);
+
+        printf("parallel, %2u thr:    %10.6f%s\n",
+                n,
+                timediff(tv[0], tv[1]),
+                (ok && modmap_cardinal(&map) == BATCH_NELEMS) ? "" : " (wrong count!)");
+    }
+
+    map = modmap_free(map);
+}
+
+/*
+ * Adds an entry to @a map for each of BATCH_NELEMS random keys, whose
+ * value is when it was added
+ */
+static bool fill_ages (struct modmap * map)
+{
+    bool ok = modmap_reserve(map, BATCH_NELEMS);
+    for (unsigned i = 0; ok && i < BATCH_NELEMS; i++)
+        ok = modmap_add(map, key_rand(i), i);
+    return ok;
+}
+
+/* whether an entry was added at or after `*ctx` */
+static bool is_fresh (const unsigned key, unsigned * value, void * ctx)
+{
+    (void) key;
+    return *value >= *(const unsigned *) ctx;
+}
+
+/*
+ * Expires the older half of the entries of a map with BATCH_NELEMS
+ * random keys: by collecting their keys with a cursor and removing
+ * them one at a time with modmap_remove(), and with a single call to
+ * modmap_retain()
+ */
+static void bench_retain (void)
+{
+    struct modmap map = {0};
+    struct timeval tv[3] = {0};
+    unsigned * keys = malloc(sizeof(*keys) * BATCH_NELEMS);
+    unsigned cutoff = BATCH_NELEMS / 2;
+    unsigned n1 = 0;
+    unsigned n2 = 0;
+
+    if (keys == NULL || !fill_ages(&map))
+        goto out;
+
+    gettimeofday(tv + 0, NULL);
+    {
+        struct modmap_cursor cur;
+        unsigned n = 0;
+
+        for (bool ok = modmap_cursor_begin(&map, &cur); ok; ok = modmap_cursor_next(&cur))
+            if (modmap_cursor_value(&cur) < cutoff)
+                keys[n++] = modmap_cursor_key(&cur);
+
+        for (unsigned i = 0; i < n; i++)
+            n1 += modmap_remove(&map, keys[i], NULL);
+    }
+    gettimeofday(tv + 1, NULL);
+
+    map = modmap_free(map);
+    if (!fill_ages(&map))
+        goto out;
+
+    gettimeofday(tv + 1, NULL);
+    n2 = modmap_retain(&map, is_fresh, &cutoff);
+    gettimeofday(tv + 2, NULL);
+
+    printf("\n%u entries, expiring %u\n"
+            "cursor + remove:     %10.6f\n"
+            "retain:              %10.6f%s\n",
+            BATCH_NELEMS, cutoff,
+            timediff(tv[0], tv[1]),
+            timediff(tv[1], tv[2]),
+            (n1 == cutoff && n2 == cutoff) ? "" : " (wrong count!)");
+
+out:
+    map = modmap_free(map);
+    free(keys);
+}
+
+/*
+ * Adds BATCH_NELEMS random keys to a map whose entry arrays are each
+ * allocated on their own (modmap), and to one whose entry arrays are in
+ * an arena (arenamap). Prints how long it took to add, look up and free
+ * them, and after MAP_RESIZE(), which lays the entry arrays of arenamap
+ * out in table order
+ */
+#define BENCH_ARENA(MAP)                                                \
+    static void bench_arena_##MAP (const unsigned * keys)               \
+    {                                                                   \
+        struct MAP map = {0};                                           \
+        struct timeval tv[5] = {0};                                     \
+        unsigned found = 0;                                             \
+                                                                        \
+        if (!MAP##_new(&map))                                           \
+            return;                                                     \
+                                                                        \
+        gettimeofday(tv + 0, NULL);                                     \
+        for (unsigned i = 0; i < BATCH_NELEMS; i++)                     \
+            MAP##_add(&map, keys[i], i);                                \
+                                                                        \
+        gettimeofday(tv + 1, NULL);                                     \
+        for (unsigned i = 0; i < BATCH_NELEMS; i++)                     \
+            found += MAP##_contains(&map, keys[i]);                     \
+                                                                        \
+        gettimeofday(tv + 2, NULL);                                     \
+        bool ok = MAP##_resize(&map, map.size + 1);                     \
+        for (unsigned i = 0; ok && i < BATCH_NELEMS; i++)               \
+            found += MAP##_contains(&map, keys[i]);                     \
+                                                                        \
+        gettimeofday(tv + 3, NULL);                                     \
+        map = MAP##_free(map);                                          \
+        gettimeofday(tv + 4, NULL);                                     \
+                                                                        \
+        printf("%-8s %10.6f %10.6f %10.6f %10.6f%s\n",                  \
+                #MAP,                                                   \
+                timediff(tv[0], tv[1]),                                 \
+                timediff(tv[1], tv[2]),                                 \
+                timediff(tv[2], tv[3]),                                 \
+                timediff(tv[3], tv[4]),                                 \
+                (ok && found == 2 * BATCH_NELEMS) ? "" : " (wrong count!)"); \
+    }
+
+BENCH_ARENA(modmap)
+BENCH_ARENA(arenamap)
+
+#undef BENCH_ARENA
+
+static void bench_arena (void)
+{
+    unsigned * keys = malloc(sizeof(*keys) * BATCH_NELEMS);
+
+    if (keys == NULL)
+        return;
+
+    for (unsigned i = 0; i < BATCH_NELEMS; i++)
+        keys[i] = key_rand(i);
+
+    printf("\n%u entries\n%-8s %10s %10s %10s %10s\n",
+            BATCH_NELEMS, "map", "insert", "hit", "resize+hit", "free");
+
+    bench_arena_modmap(keys);
+    bench_arena_arenamap(keys);
+
+    free(keys);
+}
+
+/*
+ * Fills a Robin Hood map (rhmap) with NELEMS slots up to more and more
+ * of its size, with random keys (and the identity as their hash). Prints the probe lengths (see
+ * rhmap_probe_stats()), and how long it took to look all the keys up,
+ * and as many keys that aren't in the map
+ */
+static void bench_probes (void)
+{
+    static const double loads[] = { 0.5, 0.75, 0.875, 0.9, 0.95, 0.99 };
+
+    printf("\n%-6s %9s %9s %9s %10s %10s\n",
+            "load", "entries", "max", "mean", "hit", "miss");
+
+    for (size_t l = 0; l < sizeof(loads) / sizeof(*loads); l++) {
+        struct rhmap map = {0};
+        struct timeval tv[3] = {0};
+        unsigned n = (unsigned) (loads[l] * NELEMS);
+        unsigned found = 0;
+
+        if (!rhmap_with_size(&map, NELEMS))
+            return;
+
+        for (unsigned i = 0; i < n; i++)
+            rhmap_add(&map, key_rand(i), i);
+
+        gettimeofday(tv + 0, NULL);
+        for (unsigned i = 0; i < n; i++)
+            found += rhmap_contains(&map, key_rand(i));
+
+        gettimeofday(tv + 1, NULL);
+        for (unsigned i = n; i < 2 * n; i++)
+            found += rhmap_contains(&map, key_rand(i));
+
+        gettimeofday(tv + 2, NULL);
+
+        struct rhmap_probe_stats stats = rhmap_probe_stats(&map);
+        printf("%-6.3f %9u %9u %9.3f %10.6f %10.6f%s\n",
+                loads[l], n, stats.max, stats.mean,
+                timediff(tv[0], tv[1]),
+                timediff(tv[1], tv[2]),
+                (found == n && map.size == NELEMS) ? "" : " (wrong count!)");
+
+        map = rhmap_free(map);
+    }
+}
+
+int main (int argc, char ** argv)
+{
+    unsigned max_threads = (argc > 1) ?
+        (unsigned) strtoul(argv[1], NULL, 10):
+        8;
+
+    static const struct {
+        const char * name;
+        unsigned (* key) (unsigned);
+    } keys[] = {
+        { "seq",    key_seq    },
+        { "stride", key_stride },
+        { "rand",   key_rand   },
+    };
+
+    printf("%u entries per run, times in seconds\n\n", NELEMS);
+    printf("%-8s %-8s %9s %10s %10s %10s %10s\n",
+            "map", "keys", "size", "insert", "hit", "miss", "total");
+
+    for (size_t i = 0; i < sizeof(keys) / sizeof(*keys); i++) {
+        bench_modmap(keys[i].name, keys[i].key);
+        bench_fibmap(keys[i].name, keys[i].key);
+        bench_maskmap(keys[i].name, keys[i].key);
+        putchar('\n');
+    }
+
+    bench_batch();
+    bench_build(max_threads);
+    bench_resize(max_threads);
+    bench_retain();
+    bench_arena();
+    bench_probes();
+
+    return EXIT_SUCCESS;
+}
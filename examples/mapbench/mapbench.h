@@ -0,0 +1,10 @@
+#ifndef _MAPBENCH_H
+#define _MAPBENCH_H
+
+#include "maps/arenamap.h"
+#include "maps/fibmap.h"
+#include "maps/maskmap.h"
+#include "maps/modmap.h"
+#include "maps/rhmap.h"
+
+#endif /* _MAPBENCH_H */
@@ -0,0 +1,11 @@
+#ifndef _ARENA_MAP_H
+#define _ARENA_MAP_H
+
+/* the default, with its entry arrays in an arena (MAP_CFG_ARENA) */
+#define MAP_CFG_MAP arenamap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_ARENA
+#include <utils/map.h>
+
+#endif /* _ARENA_MAP_H */
@@ -0,0 +1,10 @@
+#ifndef _FIB_MAP_H
+#define _FIB_MAP_H
+
+/* MAP_CFG_POW2, see fibmap.c */
+#define MAP_CFG_MAP fibmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#endif /* _FIB_MAP_H */
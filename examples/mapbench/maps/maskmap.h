@@ -0,0 +1,10 @@
+#ifndef _MASK_MAP_H
+#define _MASK_MAP_H
+
+/* MAP_CFG_POW2_MASK, see maskmap.c */
+#define MAP_CFG_MAP maskmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#endif /* _MASK_MAP_H */
@@ -0,0 +1,10 @@
+#ifndef _MOD_MAP_H
+#define _MOD_MAP_H
+
+/* the default: any table size, MAP_MOD() */
+#define MAP_CFG_MAP modmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#endif /* _MOD_MAP_H */
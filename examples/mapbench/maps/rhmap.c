@@ -0,0 +1,21 @@
+/* the identity, a weak hash on purpose */
+static unsigned unsigned_hash (unsigned key)
+{
+    return key;
+}
+
+static int unsigned_cmp (unsigned a, unsigned b)
+{
+    return (a < b) ?
+        -1:
+        (a > b) ?
+        1:
+        0;
+}
+
+/* open addressing with Robin Hood insertion, allowed to fill up */
+#define MAP_CFG_MAX_LOAD 0.99
+#define MAP_CFG_KEY_CMP unsigned_cmp
+#define MAP_CFG_HASH_FUNC unsigned_hash
+#define MAP_CFG_IMPLEMENTATION
+#include "rhmap.h"
@@ -0,0 +1,12 @@
+#ifndef _RH_MAP_H
+#define _RH_MAP_H
+
+/* MAP_CFG_ROBIN_HOOD, see rhmap.c */
+#define MAP_CFG_MAP rhmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_ROBIN_HOOD
+#include <utils/map.h>
+
+#endif /* _RH_MAP_H */
@@ -0,0 +1,11 @@
+#ifndef _IMG_MAP_H
+#define _IMG_MAP_H
+
+/* MAP_CFG_IMAGE, see imgmap.c */
+#define MAP_CFG_IMAGE
+#define MAP_CFG_MAP imgmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#include <utils/map.h>
+
+#endif /* _IMG_MAP_H */
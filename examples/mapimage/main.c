@@ -0,0 +1,85 @@
+#include "imgmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/time.h>
+
+/*
+ * Builds a map, writes its image to a file, and then compares building
+ * the map again with opening the image. Both are then used to look up
+ * every key
+ */
+
+#define NELEMS (1U << 22)
+
+static double timediff (struct timeval start, struct timeval end)
+{
+    return (double) (end.tv_sec - start.tv_sec)
+        + (double) (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* xorshift32, a bijection, so there are no repeated keys */
+static unsigned key_rand (unsigned i)
+{
+    unsigned x = i + 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+int main (int argc, char ** argv)
+{
+    const char * path = (argc > 1) ?
+        argv[1]:
+        "mapimage.img";
+    struct imgmap map = {0};
+    struct imgmap_image img = {0};
+    struct timeval tv[5] = {0};
+    unsigned n1 = 0;
+    unsigned n2 = 0;
+
+    gettimeofday(tv + 0, NULL);
+    if (!imgmap_reserve(&map, NELEMS))
+        return EXIT_FAILURE;
+    for (unsigned i = 0; i < NELEMS; i++)
+        imgmap_add(&map, key_rand(i), i);
+
+    gettimeofday(tv + 1, NULL);
+    for (unsigned i = 0; i < NELEMS; i++)
+        n1 += imgmap_contains(&map, key_rand(i));
+
+    if (!imgmap_image_write(&map, path)) {
+        fprintf(stderr, "couldn't write %s\n", path);
+        map = imgmap_free(map);
+        return EXIT_FAILURE;
+    }
+    map = imgmap_free(map);
+
+    gettimeofday(tv + 2, NULL);
+    if (!imgmap_image_open(&img, path)) {
+        fprintf(stderr, "couldn't open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    gettimeofday(tv + 3, NULL);
+    for (unsigned i = 0; i < NELEMS; i++)
+        n2 += imgmap_image_contains(&img, key_rand(i));
+    gettimeofday(tv + 4, NULL);
+
+    printf("%u entries, times in seconds\n\n"
+            "%-6s %10s %10s\n"
+            "%-6s %10.6f %10.6f\n"
+            "%-6s %10.6f %10.6f%s\n",
+            NELEMS,
+            "", "start", "lookups",
+            "map", timediff(tv[0], tv[1]), timediff(tv[1], tv[2]),
+            "image", timediff(tv[2], tv[3]), timediff(tv[3], tv[4]),
+            (n1 == NELEMS && n2 == NELEMS) ? "" : " (wrong count!)");
+
+    imgmap_image_close(&img);
+    remove(path);
+
+    return EXIT_SUCCESS;
+}
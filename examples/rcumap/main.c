@@ -0,0 +1,133 @@
+#include "table.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Publishes NVERSIONS versions of a map while reader threads look keys
+ * up in it, and checks what the readers see: every key of a version
+ * has the same value (the version number), and a reader never sees an
+ * older version after a newer one. The values of a version are freed
+ * when the version is, so build with `make tsan` (or
+ * `-fsanitize=address`) to also catch readers that use a version after
+ * it was freed
+ */
+
+#define NKEYS     64
+#define NREADERS  4
+#define NVERSIONS 2000
+
+static struct versions shared = {0};
+static atomic_bool done = false;
+
+/*
+ * Builds version @a number: every key has value @a number
+ */
+static bool make_version (struct table * next, unsigned number)
+{
+    if (!table_with_size(next, NKEYS))
+        return false;
+
+    for (unsigned key = 0; key < NKEYS; key++) {
+        version value = malloc(sizeof(*value));
+        if (value == NULL)
+            return false;
+
+        *value = number;
+        if (!table_add(next, key, value))
+            return free(value), false;
+    }
+
+    return true;
+}
+
+/*
+ * Checks a whole version at once, with versions_read_begin()
+ */
+static unsigned read_version (unsigned reader, unsigned * last)
+{
+    const struct table * map = versions_read_begin(&shared, reader);
+    unsigned errors = 0;
+
+    if (map == NULL)
+        return 0;
+
+    version first = NULL;
+    if (!table_lookup(map, 0, &first)) {
+        versions_read_end(&shared, reader);
+        return 1;
+    }
+
+    unsigned seen = *first;
+    errors += seen < *last;
+    *last = seen;
+
+    for (unsigned key = 1; key < NKEYS; key++) {
+        version value = NULL;
+        errors += !table_lookup(map, key, &value)
+            || *value != seen;
+    }
+
+    versions_read_end(&shared, reader);
+
+    return errors;
+}
+
+static void * reader_work (void * arg)
+{
+    unsigned reader = (unsigned) (size_t) arg;
+    unsigned last = 0;
+    size_t errors = 0;
+    size_t reads = 0;
+
+    while (!atomic_load(&done)) {
+        errors += read_version(reader, &last);
+
+        /* once a version was seen, every key is always there */
+        errors += last != 0
+            && !versions_contains(&shared, reader, (unsigned) (reads % NKEYS));
+        reads++;
+    }
+
+    return (void *) errors;
+}
+
+int main (void)
+{
+    pthread_t threads[NREADERS];
+    unsigned started = 0;
+    size_t errors = 0;
+    unsigned published = 0;
+
+    if (!versions_new(&shared))
+        return EXIT_FAILURE;
+
+    for (; started < NREADERS; started++)
+        if (pthread_create(threads + started, NULL, reader_work, (void *) (size_t) started) != 0)
+            break;
+
+    for (unsigned number = 1; number <= NVERSIONS; number++) {
+        struct table next = {0};
+        if (make_version(&next, number) && versions_publish(&shared, next))
+            published++;
+        else
+            next = table_free(next);
+    }
+
+    atomic_store(&done, true);
+    for (unsigned i = 0; i < started; i++) {
+        void * ret = NULL;
+        pthread_join(threads[i], &ret);
+        errors += (size_t) ret;
+    }
+
+    shared = versions_free(shared);
+
+    printf("%u readers, %u versions published, %zu errors\n", started, published, errors);
+
+    return (started == NREADERS && published == NVERSIONS && errors == 0) ?
+        EXIT_SUCCESS:
+        EXIT_FAILURE;
+}
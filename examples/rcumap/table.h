@@ -0,0 +1,23 @@
+#ifndef _TABLE_H
+#define _TABLE_H
+
+/*
+ * The published versions: each value is allocated on its own, and freed
+ * with the version, so a reader that uses a version after it was freed
+ * reads freed memory
+ */
+/* a type name, so that `const MAP_CFG_VALUE_DATA_TYPE` is a const pointer */
+typedef unsigned * version;
+
+#define MAP_CFG_MAP table
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE version
+#include <utils/map.h>
+
+#define RCUMAP_CFG_MAP table
+#define RCUMAP_CFG_RCUMAP versions
+#define RCUMAP_CFG_KEY_DATA_TYPE unsigned
+#define RCUMAP_CFG_VALUE_DATA_TYPE version
+#include <utils/rcumap.h>
+
+#endif /* _TABLE_H */
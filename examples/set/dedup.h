@@ -0,0 +1,17 @@
+#ifndef _DEDUP_H
+#define _DEDUP_H
+
+/* A map with a dummy value, the way sets used to be made */
+#define MAP_CFG_MAP charmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE char
+#define MAP_CFG_HASH_INT
+#include <utils/map.h>
+
+/* A set, without values */
+#define MAP_CFG_MAP uset
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_HASH_INT
+#include <utils/set.h>
+
+#endif /* _DEDUP_H */
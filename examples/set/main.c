@@ -0,0 +1,135 @@
+#include "dedup.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/time.h>
+
+/*
+ * Deduplicates a stream of keys with lots of repeats, with a map of
+ * dummy `char` values and with a set, and compares the time and memory
+ * each takes. Then times the set operations on two overlapping sets
+ */
+
+#define NKEYS    (1U << 22)
+#define KEYSPACE (1U << 20)
+
+static double timediff (struct timeval start, struct timeval end)
+{
+    return (double) (end.tv_sec - start.tv_sec)
+        + (double) (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/* xorshift32 */
+static unsigned next (unsigned * state)
+{
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/*
+ * The memory of a table of chained buckets: the buckets themselves, and
+ * the (allocated, not just used) entries of each
+ */
+#define MEMORY_FUNC(MAP)                                                \
+    static size_t MAP##_memory (const struct MAP * map)                 \
+    {                                                                   \
+        size_t mem = map->size * sizeof(*map->table);                   \
+        for (unsigned i = 0; i < map->size; i++)                        \
+            mem += map->table[i].capacity * sizeof(*map->table[i].entries); \
+        return mem;                                                     \
+    }
+
+MEMORY_FUNC(charmap)
+MEMORY_FUNC(uset)
+
+#undef MEMORY_FUNC
+
+static void report (const char * name, double secs, unsigned cardinal, size_t mem, size_t entsz)
+{
+    printf("%-8s %8.3f s %8u keys %10zu bytes %6.2f bytes/key (entry %zu bytes)\n",
+            name, secs, cardinal, mem, (double) mem / cardinal, entsz);
+}
+
+int main (void)
+{
+    struct timeval tv[2] = {0};
+    struct charmap map = {0};
+    struct uset set = {0};
+    struct uset a = {0};
+    struct uset b = {0};
+    unsigned * keys = malloc(sizeof(*keys) * NKEYS);
+    unsigned state = 2463534242U;
+    int ret = EXIT_FAILURE;
+
+    if (keys == NULL
+            || !charmap_new(&map)
+            || !uset_new(&set)
+            || !uset_new(&a)
+            || !uset_new(&b))
+        goto out;
+
+    for (unsigned i = 0; i < NKEYS; i++)
+        keys[i] = next(&state) % KEYSPACE;
+
+    printf("Deduplicating %u keys out of %u possible\n\n", NKEYS, KEYSPACE);
+
+    gettimeofday(tv + 0, NULL);
+    for (unsigned i = 0; i < NKEYS; i++)
+        if (!charmap_contains(&map, keys[i]) && !charmap_add(&map, keys[i], 0))
+            goto out;
+    gettimeofday(tv + 1, NULL);
+    report("charmap", timediff(tv[0], tv[1]), charmap_cardinal(&map), charmap_memory(&map), sizeof(*map.table->entries));
+
+    gettimeofday(tv + 0, NULL);
+    for (unsigned i = 0; i < NKEYS; i++)
+        if (!uset_contains(&set, keys[i]) && !uset_add(&set, keys[i]))
+            goto out;
+    gettimeofday(tv + 1, NULL);
+    report("uset", timediff(tv[0], tv[1]), uset_cardinal(&set), uset_memory(&set), sizeof(*set.table->entries));
+
+    /* a = multiples of 2, b = multiples of 3 */
+    for (unsigned i = 0; i < KEYSPACE; i += 2)
+        if (!uset_add(&a, i))
+            goto out;
+    for (unsigned i = 0; i < KEYSPACE; i += 3)
+        if (!uset_add(&b, i))
+            goto out;
+
+    printf("\n|a| = %u, |b| = %u\n", uset_cardinal(&a), uset_cardinal(&b));
+
+#define SETOP(NAME, OP)                                                 \
+    do {                                                                \
+        if (!uset_new(&set) || !uset_union(&set, &a))                   \
+            goto out;                                                   \
+        gettimeofday(tv + 0, NULL);                                     \
+        bool _ok = OP;                                                  \
+        gettimeofday(tv + 1, NULL);                                     \
+        if (!_ok)                                                       \
+            goto out;                                                   \
+        printf("%-16s %8.3f s %8u keys\n", NAME, timediff(tv[0], tv[1]), uset_cardinal(&set)); \
+    } while (0)
+
+    /* set = a, then set op= b */
+    set = uset_free(set);
+    SETOP("a union b",        uset_union(&set, &b));
+    set = uset_free(set);
+    SETOP("a intersection b", uset_intersection(&set, &b));
+    set = uset_free(set);
+    SETOP("a difference b",   uset_difference(&set, &b));
+
+#undef SETOP
+
+    ret = EXIT_SUCCESS;
+
+out:
+    free(keys);
+    map = charmap_free(map);
+    set = uset_free(set);
+    a = uset_free(a);
+    b = uset_free(b);
+    return ret;
+}
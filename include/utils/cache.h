@@ -0,0 +1,720 @@
+/* cache - v2026.10.18-0
+ *
+ * A bounded cache type, built on top of `map.h`: it holds at most a
+ * fixed number of entries, and when a new one doesn't fit, an old one
+ * is evicted with the CLOCK algorithm (an approximation of LRU). Every
+ * entry has a "referenced" bit, set when it is looked up, and a "hand"
+ * goes round the entries, clearing the bits it finds set, until it
+ * finds an entry whose bit was already clear, the victim.
+ *
+ * The map is only an index, from each key to the slot of its entry in a
+ * fixed array, so a look up is a single probe of the map, and there's
+ * no list to keep in order. Everything is allocated by CACHE_NEW(), and
+ * nothing after that.
+ *
+ * The most up to date version of this file can be found at
+ * `include/utils/cache.h` on [siiky/c-utils](https://github.com/siiky/c-utils)
+ * More usage examples can be found at `examples/cache` on the link above
+ *
+ * # Usage
+ *
+ * The map type of the index has to be created with `map.h` first, with
+ * the same key type, and values of CACHE_CFG_SIZE_TYPE (the slots). It
+ * must not have a MAP_CFG_KEY_DTOR(), the keys belong to the cache. With
+ * MAP_CFG_OPEN_ADDRESSING and MAP_CFG_ROBIN_HOOD the index doesn't
+ * allocate when entries come and go either (separate chaining may
+ * reallocate the entry arrays).
+ */
+
+# if 0
+static unsigned hash_func (unsigned key)
+{
+    return key;
+}
+
+static int cmp_func (unsigned a, unsigned b)
+{
+    return (a < b) ? -1 : (a > b);
+}
+
+// The index of the cache
+#define MAP_CFG_MAP index
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_HASH_FUNC hash_func
+#define MAP_CFG_KEY_CMP cmp_func
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_ROBIN_HOOD
+#define MAP_CFG_IMPLEMENTATION
+#include <utils/map.h>
+
+// Must be the struct identifier of the map above
+#define CACHE_CFG_MAP index
+#define CACHE_CFG_KEY_DATA_TYPE unsigned
+#define CACHE_CFG_VALUE_DATA_TYPE double
+
+// Optionally, define the struct identifier (defaults to `cache`) and a
+// prefix for the generated functions (defaults to `CACHE_CFG_CACHE_`)
+//#define CACHE_CFG_CACHE my_cache
+//#define CACHE_CFG_PREFIX my_
+
+#define CACHE_CFG_IMPLEMENTATION
+#include <utils/cache.h>
+
+static double slow_func (unsigned x);
+
+int main (void)
+{
+    struct cache cache = {0};
+
+    // At most 1024 entries
+    if (!cache_new(&cache, 1024))
+        return 1;
+
+    // Memoize slow_func()
+    for (unsigned i = 0; i < 1000000; i++) {
+        bool inserted = false;
+        double * value = cache_entry(&cache, i % 2000, &inserted);
+        if (value != NULL && inserted)
+            *value = slow_func(i % 2000);
+    }
+
+    // cache.hits, cache.misses, cache.evictions
+
+    cache = cache_free(cache);
+
+    return 0;
+}
+# endif /* EXAMPLE */
+
+/*
+ * <stdbool.h>
+ *  bool
+ *  false
+ *  true
+ */
+#include <stdbool.h>
+
+/*
+ * Magic from `sort.h`
+ */
+# define CACHE_CFG_CONCAT(A, B)    A ## B
+# define CACHE_CFG_MAKE_STR1(A, B) CACHE_CFG_CONCAT(A, B)
+# define CACHE_CFG_MAKE_STR(A)     CACHE_CFG_MAKE_STR1(CACHE_CFG_PREFIX, A)
+# define CACHE_CFG_MAKE_MAP_STR(A) CACHE_CFG_MAKE_STR1(CACHE_CFG_MAP_PREFIX, A)
+
+/*
+ * Struct identifier of the map type of the index, created with `map.h`
+ */
+# ifndef CACHE_CFG_MAP
+#  error "Must define CACHE_CFG_MAP"
+# endif /* CACHE_CFG_MAP */
+
+/*
+ * Type of the keys for the cache to hold (same as the index's)
+ */
+# ifndef CACHE_CFG_KEY_DATA_TYPE
+#  error "Must define CACHE_CFG_KEY_DATA_TYPE"
+# endif /* CACHE_CFG_KEY_DATA_TYPE */
+
+/*
+ * Type of the values for the cache to hold
+ */
+# ifndef CACHE_CFG_VALUE_DATA_TYPE
+#  error "Must define CACHE_CFG_VALUE_DATA_TYPE"
+# endif /* CACHE_CFG_VALUE_DATA_TYPE */
+
+/*
+ * Prefix of the functions of the map type of the index, if it was
+ * overwritten with MAP_CFG_PREFIX
+ */
+# ifndef CACHE_CFG_MAP_PREFIX
+#  define CACHE_CFG_MAP_PREFIX CACHE_CFG_MAKE_STR1(CACHE_CFG_MAP, _)
+# endif /* CACHE_CFG_MAP_PREFIX */
+
+/*
+ * If the cache name wasn't overwritten and the prefix wasn't
+ * defined, the cache name defaults to `cache`
+ */
+# ifndef CACHE_CFG_CACHE
+#  define CACHE_CFG_CACHE cache
+# endif /* CACHE_CFG_CACHE */
+
+/*
+ * If no prefix was defined, default to `cache_`
+ */
+# ifndef CACHE_CFG_PREFIX
+#  define CACHE_CFG_PREFIX CACHE_CFG_MAKE_STR1(CACHE_CFG_CACHE, _)
+# endif /* CACHE_CFG_PREFIX */
+
+/*
+ * Must be the same as the MAP_CFG_SIZE_TYPE (and the value type) of the
+ * index (`unsigned` by default, and with MAP_CFG_64BIT, `size_t`)
+ */
+# ifndef CACHE_CFG_SIZE_TYPE
+#  define CACHE_CFG_SIZE_TYPE unsigned
+# endif /* CACHE_CFG_SIZE_TYPE */
+
+/*
+ * Internal types
+ */
+# define _CACHE_SLOT CACHE_CFG_MAKE_STR(_slot)
+
+/**
+ * @brief An entry of the cache
+ */
+struct _CACHE_SLOT {
+    /** The key of the entry */
+    CACHE_CFG_KEY_DATA_TYPE key;
+
+    /** The value of the entry */
+    CACHE_CFG_VALUE_DATA_TYPE value;
+
+    /** Whether the entry was looked up since the hand last passed by */
+    bool referenced;
+};
+
+/**
+ * @brief The cache type
+ */
+struct CACHE_CFG_CACHE {
+    /** Maps the key of each entry to its slot */
+    struct CACHE_CFG_MAP index;
+
+    /** The entries, `capacity` of them, the first `length` in use */
+    struct _CACHE_SLOT * slots;
+
+    /** The maximum number of entries */
+    CACHE_CFG_SIZE_TYPE capacity;
+
+    /** The number of entries */
+    CACHE_CFG_SIZE_TYPE length;
+
+    /** The slot where the next search for a victim starts */
+    CACHE_CFG_SIZE_TYPE hand;
+
+    /** Number of look ups that found their key */
+    unsigned long hits;
+
+    /** Number of look ups that didn't find their key */
+    unsigned long misses;
+
+    /** Number of entries evicted to make room for new ones */
+    unsigned long evictions;
+};
+
+/*==========================================================
+ * Function names
+ *=========================================================*/
+#define CACHE_CARDINAL CACHE_CFG_MAKE_STR(cardinal)
+#define CACHE_CONTAINS CACHE_CFG_MAKE_STR(contains)
+#define CACHE_ENTRY    CACHE_CFG_MAKE_STR(entry)
+#define CACHE_FREE     CACHE_CFG_MAKE_STR(free)
+#define CACHE_GET      CACHE_CFG_MAKE_STR(get)
+#define CACHE_GET_PTR  CACHE_CFG_MAKE_STR(get_ptr)
+#define CACHE_NEW      CACHE_CFG_MAKE_STR(new)
+#define CACHE_PUT      CACHE_CFG_MAKE_STR(put)
+#define CACHE_REMOVE   CACHE_CFG_MAKE_STR(remove)
+
+/*==========================================================
+ * Function prototypes
+ *==========================================================*/
+CACHE_CFG_SIZE_TYPE         CACHE_CARDINAL (const struct CACHE_CFG_CACHE * self);
+CACHE_CFG_VALUE_DATA_TYPE * CACHE_ENTRY    (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, bool * inserted);
+CACHE_CFG_VALUE_DATA_TYPE * CACHE_GET_PTR  (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key);
+bool                        CACHE_CONTAINS (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key);
+bool                        CACHE_GET      (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, CACHE_CFG_VALUE_DATA_TYPE * value);
+bool                        CACHE_NEW      (struct CACHE_CFG_CACHE * self, CACHE_CFG_SIZE_TYPE capacity);
+bool                        CACHE_PUT      (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, const CACHE_CFG_VALUE_DATA_TYPE value);
+bool                        CACHE_REMOVE   (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, CACHE_CFG_VALUE_DATA_TYPE * value);
+struct CACHE_CFG_CACHE      CACHE_FREE     (struct CACHE_CFG_CACHE self);
+
+#ifdef CACHE_CFG_IMPLEMENTATION
+
+#define _CACHE_CLAIM  CACHE_CFG_MAKE_STR(_claim)
+#define _CACHE_INSERT CACHE_CFG_MAKE_STR(_insert)
+#define _CACHE_LOOKUP CACHE_CFG_MAKE_STR(_lookup)
+#define _CACHE_VICTIM CACHE_CFG_MAKE_STR(_victim)
+
+/*
+ * Functions of the map type of the index
+ */
+#define _CACHE_MAP_CONTAINS CACHE_CFG_MAKE_MAP_STR(contains)
+#define _CACHE_MAP_ENTRY    CACHE_CFG_MAKE_MAP_STR(entry)
+#define _CACHE_MAP_FREE     CACHE_CFG_MAKE_MAP_STR(free)
+#define _CACHE_MAP_GET_PTR  CACHE_CFG_MAKE_MAP_STR(get_ptr)
+#define _CACHE_MAP_REMOVE   CACHE_CFG_MAKE_MAP_STR(remove)
+#define _CACHE_MAP_RESERVE  CACHE_CFG_MAKE_MAP_STR(reserve)
+
+# ifdef CACHE_CFG_STATIC
+#  undef CACHE_CFG_STATIC
+#  define CACHE_CFG_STATIC static
+# else /* CACHE_CFG_STATIC */
+#  undef CACHE_CFG_STATIC
+#  define CACHE_CFG_STATIC
+# endif /* CACHE_CFG_STATIC */
+
+/*
+ * <stdlib.h>
+ *  calloc()
+ *  free()
+ *
+ * <string.h>
+ *  memset()
+ */
+#include <stdlib.h>
+#include <string.h>
+
+# ifndef CACHE_CFG_CALLOC
+#  define CACHE_CFG_CALLOC calloc
+# endif /* CACHE_CFG_CALLOC */
+
+# ifndef CACHE_CFG_FREE
+#  define CACHE_CFG_FREE free
+# endif /* CACHE_CFG_FREE */
+
+/*
+ * Optionally, define CACHE_CFG_KEY_DTOR() and CACHE_CFG_VALUE_DTOR() to
+ * free the keys and values of the entries that are evicted, replaced,
+ * removed, or left in the cache when it's freed
+ */
+
+/*==========================================================
+ * Function definitions
+ *=========================================================*/
+
+/**
+ * @brief Finds the next victim: goes round the slots from the hand,
+ *        clearing their referenced bits, until a slot whose bit was
+ *        already clear, and leaves the hand after it
+ * @param self The cache (full)
+ * @returns The slot of the victim
+ *
+ * Ends in at most one round, when every bit was set
+ */
+static CACHE_CFG_SIZE_TYPE _CACHE_VICTIM (struct CACHE_CFG_CACHE * self)
+{
+    CACHE_CFG_SIZE_TYPE hand = self->hand;
+
+    while (self->slots[hand].referenced) {
+        self->slots[hand].referenced = false;
+        hand = (hand + 1 < self->capacity) ? hand + 1 : 0;
+    }
+
+    self->hand = (hand + 1 < self->capacity) ? hand + 1 : 0;
+    return hand;
+}
+
+/**
+ * @brief Gets a slot for a new entry, evicting an old one if the cache
+ *        is full
+ * @param self The cache
+ * @param[in,out] slot_ptr The value of the new entry in the index. Its
+ *                slot is written here before the victim is removed
+ *                from the index, which may move it
+ * @returns The slot, with its old key and value already destroyed
+ */
+static CACHE_CFG_SIZE_TYPE _CACHE_CLAIM (struct CACHE_CFG_CACHE * self, CACHE_CFG_SIZE_TYPE * slot_ptr)
+{
+    if (self->length < self->capacity)
+        return *slot_ptr = self->length++;
+
+    CACHE_CFG_SIZE_TYPE slot = _CACHE_VICTIM(self);
+    struct _CACHE_SLOT * victim = self->slots + slot;
+
+    *slot_ptr = slot;
+    _CACHE_MAP_REMOVE(&self->index, victim->key, NULL);
+
+# ifdef CACHE_CFG_KEY_DTOR
+    CACHE_CFG_KEY_DTOR(victim->key);
+# endif /* CACHE_CFG_KEY_DTOR */
+# ifdef CACHE_CFG_VALUE_DTOR
+    CACHE_CFG_VALUE_DTOR(victim->value);
+# endif /* CACHE_CFG_VALUE_DTOR */
+
+    self->evictions++;
+    return slot;
+}
+
+/**
+ * @brief Finds the entry with key @a key, or adds one (with a zeroed
+ *        value), evicting an old one if needed
+ * @param self The cache
+ * @param key The key
+ * @param[out] inserted Whether the entry was added (!NULL)
+ * @returns The slot of the entry, or NULL if the cache isn't valid or
+ *          the index failed to add the key
+ */
+static struct _CACHE_SLOT * _CACHE_INSERT (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, bool * inserted)
+{
+    if (self == NULL || self->slots == NULL)
+        return NULL;
+
+    CACHE_CFG_SIZE_TYPE * slot_ptr = _CACHE_MAP_ENTRY(&self->index, key, inserted);
+    if (slot_ptr == NULL)
+        return NULL;
+
+    if (!*inserted)
+        return self->slots + *slot_ptr;
+
+    struct _CACHE_SLOT * slot = self->slots + _CACHE_CLAIM(self, slot_ptr);
+
+    memset(slot, 0, sizeof(*slot));
+    slot->key = key;
+
+    return slot;
+}
+
+/**
+ * @brief Looks up the entry with key @a key, and marks it referenced
+ * @param self The cache
+ * @param key The key
+ * @returns The slot of the entry, or NULL if there's none
+ */
+static struct _CACHE_SLOT * _CACHE_LOOKUP (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key)
+{
+    if (self == NULL || self->slots == NULL)
+        return NULL;
+
+    const CACHE_CFG_SIZE_TYPE * slot_ptr = _CACHE_MAP_GET_PTR(&self->index, key);
+
+    if (slot_ptr == NULL) {
+        self->misses++;
+        return NULL;
+    }
+
+    struct _CACHE_SLOT * slot = self->slots + *slot_ptr;
+    slot->referenced = true;
+    self->hits++;
+
+    return slot;
+}
+
+/**
+ * @brief Calculates the cardinal (number of entries) in the cache
+ * @param self The cache
+ * @returns The number of entries in the cache
+ */
+CACHE_CFG_STATIC CACHE_CFG_SIZE_TYPE CACHE_CARDINAL (const struct CACHE_CFG_CACHE * self)
+{
+    return (self != NULL) ?
+        self->length:
+        0;
+}
+
+/**
+ * @brief Checks if the cache contains an entry with a given key,
+ *        without counting it as a look up
+ * @param self The cache
+ * @param key The key
+ * @returns `true` if there's an entry with @a key
+ */
+CACHE_CFG_STATIC bool CACHE_CONTAINS (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key)
+{
+    return self != NULL
+        && self->slots != NULL
+        && _CACHE_MAP_CONTAINS(&self->index, key);
+}
+
+/**
+ * @brief Gets a pointer to the value of the entry with key @a key,
+ *        adding an entry with a zeroed value first if there's none
+ *        (and evicting another if the cache is full). A look up, that
+ *        hits if the entry was already there. E.g., to memoize a
+ *        function: `if (inserted) *value = func(key)`
+ * @param self The cache
+ * @param key The key. If the entry was already there, the cache keeps
+ *        its key, and @a key is destroyed with CACHE_CFG_KEY_DTOR()
+ * @param[out] inserted Whether the entry was added (may be NULL)
+ * @returns A pointer to the value, or NULL if the cache isn't valid or
+ *          it wasn't possible to add the entry. It is valid until the
+ *          entry is evicted or removed
+ */
+CACHE_CFG_STATIC CACHE_CFG_VALUE_DATA_TYPE * CACHE_ENTRY (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, bool * inserted)
+{
+    bool _inserted = false;
+    struct _CACHE_SLOT * slot = _CACHE_INSERT(self, key, &_inserted);
+
+    if (inserted != NULL)
+        *inserted = _inserted;
+
+    if (slot == NULL)
+        return NULL;
+
+    if (_inserted) {
+        self->misses++;
+    } else {
+# ifdef CACHE_CFG_KEY_DTOR
+        CACHE_CFG_KEY_DTOR(key);
+# endif /* CACHE_CFG_KEY_DTOR */
+        slot->referenced = true;
+        self->hits++;
+    }
+
+    return &slot->value;
+}
+
+/**
+ * @brief Gets the value associated with a given key, if there is one
+ * @param self The cache
+ * @param key The key
+ * @param[out] value Where to put the value. Left untouched if there's
+ *             no entry with @a key. May be NULL
+ * @returns `true` if there's an entry with @a key
+ */
+CACHE_CFG_STATIC bool CACHE_GET (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, CACHE_CFG_VALUE_DATA_TYPE * value)
+{
+    const struct _CACHE_SLOT * slot = _CACHE_LOOKUP(self, key);
+
+    if (slot == NULL)
+        return false;
+
+    if (value != NULL)
+        *value = slot->value;
+
+    return true;
+}
+
+/**
+ * @brief Gets a pointer to the value of the entry with key @a key,
+ *        which can be used to read or modify it in place
+ * @param self The cache
+ * @param key The key
+ * @returns A pointer to the value, or NULL if there's no entry with
+ *          key @a key. It is valid until the entry is evicted or
+ *          removed
+ */
+CACHE_CFG_STATIC CACHE_CFG_VALUE_DATA_TYPE * CACHE_GET_PTR (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key)
+{
+    struct _CACHE_SLOT * slot = _CACHE_LOOKUP(self, key);
+
+    return (slot != NULL) ?
+        &slot->value:
+        NULL;
+}
+
+/**
+ * @brief Initializes a cache, allocating everything it will need
+ * @param self The cache
+ * @param capacity The maximum number of entries (> 0)
+ * @returns `true` if it successfully initialized the cache
+ */
+CACHE_CFG_STATIC bool CACHE_NEW (struct CACHE_CFG_CACHE * self, CACHE_CFG_SIZE_TYPE capacity)
+{
+    if (self == NULL || capacity == 0 || capacity + 1 == 0)
+        return false;
+
+    *self = (struct CACHE_CFG_CACHE) {0};
+
+    /*
+     * _CACHE_INSERT() adds the new key to the index before it removes
+     * the victim's, so the index holds one more key for a moment
+     */
+    self->slots = CACHE_CFG_CALLOC(capacity, sizeof(*self->slots));
+    if (self->slots == NULL || !_CACHE_MAP_RESERVE(&self->index, capacity + 1)) {
+        *self = CACHE_FREE(*self);
+        return false;
+    }
+
+    self->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Adds an entry to the cache, or replaces the value of the entry
+ *        with the same key (evicting another if the cache is full).
+ *        Isn't a look up, and doesn't mark the entry referenced
+ * @param self The cache
+ * @param key The key. If the entry was already there, the cache keeps
+ *        its key, and @a key is destroyed with CACHE_CFG_KEY_DTOR()
+ * @param value The value. The replaced one is destroyed with
+ *        CACHE_CFG_VALUE_DTOR()
+ * @returns `true` if it successfully added the entry
+ */
+CACHE_CFG_STATIC bool CACHE_PUT (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, const CACHE_CFG_VALUE_DATA_TYPE value)
+{
+    bool inserted = false;
+    struct _CACHE_SLOT * slot = _CACHE_INSERT(self, key, &inserted);
+
+    if (slot == NULL)
+        return false;
+
+    if (!inserted) {
+# ifdef CACHE_CFG_KEY_DTOR
+        CACHE_CFG_KEY_DTOR(key);
+# endif /* CACHE_CFG_KEY_DTOR */
+# ifdef CACHE_CFG_VALUE_DTOR
+        CACHE_CFG_VALUE_DTOR(slot->value);
+# endif /* CACHE_CFG_VALUE_DTOR */
+    }
+
+    slot->value = value;
+    return true;
+}
+
+/**
+ * @brief Removes an entry from the cache. The last slot in use is moved
+ *        to its place, so the slots in use are always the first ones
+ * @param self The cache
+ * @param key The key
+ * @param[out] value Where to put the value of the removed entry. If
+ *             NULL, the value is destroyed with CACHE_CFG_VALUE_DTOR()
+ * @returns `true` if there was an entry with @a key
+ */
+CACHE_CFG_STATIC bool CACHE_REMOVE (struct CACHE_CFG_CACHE * self, const CACHE_CFG_KEY_DATA_TYPE key, CACHE_CFG_VALUE_DATA_TYPE * value)
+{
+    CACHE_CFG_SIZE_TYPE i = 0;
+
+    if (self == NULL || self->slots == NULL || !_CACHE_MAP_REMOVE(&self->index, key, &i))
+        return false;
+
+    struct _CACHE_SLOT * slot = self->slots + i;
+
+    if (value != NULL) {
+        *value = slot->value;
+    } else {
+# ifdef CACHE_CFG_VALUE_DTOR
+        CACHE_CFG_VALUE_DTOR(slot->value);
+# endif /* CACHE_CFG_VALUE_DTOR */
+    }
+
+# ifdef CACHE_CFG_KEY_DTOR
+    CACHE_CFG_KEY_DTOR(slot->key);
+# endif /* CACHE_CFG_KEY_DTOR */
+
+    CACHE_CFG_SIZE_TYPE last = --self->length;
+    if (i != last) {
+        *slot = self->slots[last];
+        *_CACHE_MAP_GET_PTR(&self->index, slot->key) = i;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Cleans and frees the cache, and its entries if
+ *        CACHE_CFG_KEY_DTOR() and CACHE_CFG_VALUE_DTOR() are defined
+ * @param self The cache
+ * @returns A new empty (clean) cache
+ */
+CACHE_CFG_STATIC struct CACHE_CFG_CACHE CACHE_FREE (struct CACHE_CFG_CACHE self)
+{
+    if (self.slots != NULL) {
+# if defined(CACHE_CFG_KEY_DTOR) || defined(CACHE_CFG_VALUE_DTOR)
+        for (CACHE_CFG_SIZE_TYPE i = 0; i < self.length; i++) {
+#  ifdef CACHE_CFG_KEY_DTOR
+            CACHE_CFG_KEY_DTOR(self.slots[i].key);
+#  endif /* CACHE_CFG_KEY_DTOR */
+#  ifdef CACHE_CFG_VALUE_DTOR
+            CACHE_CFG_VALUE_DTOR(self.slots[i].value);
+#  endif /* CACHE_CFG_VALUE_DTOR */
+        }
+# endif /* CACHE_CFG_KEY_DTOR || CACHE_CFG_VALUE_DTOR */
+
+        CACHE_CFG_FREE(self.slots);
+    }
+
+    self.index = _CACHE_MAP_FREE(self.index);
+
+    return (struct CACHE_CFG_CACHE) {0};
+}
+
+/*==========================================================
+ * Implementation clean up
+ *=========================================================*/
+
+/*
+ * Functions
+ */
+#undef _CACHE_CLAIM
+#undef _CACHE_INSERT
+#undef _CACHE_LOOKUP
+#undef _CACHE_VICTIM
+
+/*
+ * Functions of the index
+ */
+#undef _CACHE_MAP_CONTAINS
+#undef _CACHE_MAP_ENTRY
+#undef _CACHE_MAP_FREE
+#undef _CACHE_MAP_GET_PTR
+#undef _CACHE_MAP_REMOVE
+#undef _CACHE_MAP_RESERVE
+
+/*
+ * Other
+ */
+#undef CACHE_CFG_CALLOC
+#undef CACHE_CFG_FREE
+#undef CACHE_CFG_KEY_DTOR
+#undef CACHE_CFG_STATIC
+#undef CACHE_CFG_VALUE_DTOR
+
+#endif /* CACHE_CFG_IMPLEMENTATION */
+
+/*==========================================================
+ * Header clean up
+ *=========================================================*/
+
+/*
+ * Functions
+ */
+#undef CACHE_CARDINAL
+#undef CACHE_CONTAINS
+#undef CACHE_ENTRY
+#undef CACHE_FREE
+#undef CACHE_GET
+#undef CACHE_GET_PTR
+#undef CACHE_NEW
+#undef CACHE_PUT
+#undef CACHE_REMOVE
+
+/*
+ * Types
+ */
+#undef _CACHE_SLOT
+
+/*
+ * Other
+ */
+#undef CACHE_CFG_CACHE
+#undef CACHE_CFG_CONCAT
+#undef CACHE_CFG_KEY_DATA_TYPE
+#undef CACHE_CFG_MAKE_MAP_STR
+#undef CACHE_CFG_MAKE_STR
+#undef CACHE_CFG_MAKE_STR1
+#undef CACHE_CFG_MAP
+#undef CACHE_CFG_MAP_PREFIX
+#undef CACHE_CFG_PREFIX
+#undef CACHE_CFG_SIZE_TYPE
+#undef CACHE_CFG_VALUE_DATA_TYPE
+
+/*==========================================================
+ * License
+ *==========================================================
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
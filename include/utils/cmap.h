@@ -0,0 +1,821 @@
+/* cmap - v2026.10.17-0
+ *
+ * A concurrent Hash Map type, built on top of `map.h`: the entries are
+ * spread over a fixed number of shards, each one an independent map
+ * with its own lock, so threads working on different shards don't wait
+ * for each other
+ *
+ * The most up to date version of this file can be found at
+ * `include/utils/cmap.h` on [siiky/c-utils](https://github.com/siiky/c-utils)
+ * More usage examples can be found at `examples/cmap` on the link above
+ *
+ * # Usage
+ *
+ * The map type of the shards has to be created with `map.h` first,
+ * then the concurrent map type is created on top of it, with the same
+ * key, value, hash and size types. The keys are hashed once, with the
+ * shards' hash function, both to pick their shard and for the shard's
+ * map. Link with `-pthread`. Reader/writer locks are from POSIX.1-2001,
+ * so with `-std=c18` (and the like) define `_POSIX_C_SOURCE` as
+ * `200112L` (or bigger).
+ */
+
+# if 0
+static unsigned hash_func (unsigned key)
+{
+    return key;
+}
+
+static int cmp_func (unsigned a, unsigned b)
+{
+    return (a < b) ? -1 : (a > b);
+}
+
+// The map of each shard
+#define MAP_CFG_MAP shardmap
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_HASH_FUNC hash_func
+#define MAP_CFG_KEY_CMP cmp_func
+#define MAP_CFG_IMPLEMENTATION
+#include <utils/map.h>
+
+// Must be the struct identifier of the map above
+#define CMAP_CFG_MAP shardmap
+#define CMAP_CFG_KEY_DATA_TYPE unsigned
+#define CMAP_CFG_VALUE_DATA_TYPE unsigned
+
+// Optionally, the same hash function as the map's, to call it
+// directly. Without it, the keys are hashed with MAP_HASH() of the
+// shards, which works with any of the hash options of `map.h`
+// (MAP_CFG_HASH_INT, ...)
+//#define CMAP_CFG_HASH_FUNC hash_func
+
+// Must be defined if (and only if) the map has MAP_CFG_SEEDED_HASH
+//#define CMAP_CFG_SEEDED_HASH
+
+// Optionally, define the struct identifier (defaults to `cmap`) and a
+// prefix for the generated functions (defaults to `CMAP_CFG_CMAP_`)
+//#define CMAP_CFG_CMAP my_cmap
+//#define CMAP_CFG_PREFIX my_
+
+// Optionally, use 2^8 shards instead of 2^6
+//#define CMAP_CFG_SHARD_BITS 8
+
+// Optionally, use spinlocks instead of reader/writer locks
+//#define CMAP_CFG_SPINLOCK
+
+#define CMAP_CFG_IMPLEMENTATION
+#include <utils/cmap.h>
+
+int main (void)
+{
+    struct cmap cmap = {0};
+    unsigned value = 0;
+
+    if (!cmap_new(&cmap))
+        return 1;
+
+    // Safe to call from any number of threads at the same time
+    cmap_add(&cmap, 1, 2);
+    if (cmap_get(&cmap, 1, &value))
+        cmap_remove(&cmap, 1, NULL);
+
+    // But not while any other function is running
+    cmap = cmap_free(cmap);
+
+    return 0;
+}
+# endif /* EXAMPLE */
+
+/*
+ * <stdbool.h>
+ *  bool
+ *  false
+ *  true
+ */
+#include <stdbool.h>
+
+/*
+ * Magic from `sort.h`
+ */
+# define CMAP_CFG_CONCAT(A, B)    A ## B
+# define CMAP_CFG_MAKE_STR1(A, B) CMAP_CFG_CONCAT(A, B)
+# define CMAP_CFG_MAKE_STR(A)     CMAP_CFG_MAKE_STR1(CMAP_CFG_PREFIX, A)
+# define CMAP_CFG_MAKE_MAP_STR(A) CMAP_CFG_MAKE_STR1(CMAP_CFG_MAP_PREFIX, A)
+
+/*
+ * Struct identifier of the map type of the shards, created with
+ * `map.h`
+ */
+# ifndef CMAP_CFG_MAP
+#  error "Must define CMAP_CFG_MAP"
+# endif /* CMAP_CFG_MAP */
+
+/*
+ * Type of the keys for the map to hold (same as the shards')
+ */
+# ifndef CMAP_CFG_KEY_DATA_TYPE
+#  error "Must define CMAP_CFG_KEY_DATA_TYPE"
+# endif /* CMAP_CFG_KEY_DATA_TYPE */
+
+/*
+ * Type of the values for the map to hold (same as the shards')
+ */
+# ifndef CMAP_CFG_VALUE_DATA_TYPE
+#  error "Must define CMAP_CFG_VALUE_DATA_TYPE"
+# endif /* CMAP_CFG_VALUE_DATA_TYPE */
+
+/*
+ * Prefix of the functions of the map type of the shards, if it was
+ * overwritten with MAP_CFG_PREFIX
+ */
+# ifndef CMAP_CFG_MAP_PREFIX
+#  define CMAP_CFG_MAP_PREFIX CMAP_CFG_MAKE_STR1(CMAP_CFG_MAP, _)
+# endif /* CMAP_CFG_MAP_PREFIX */
+
+/*
+ * If the map name wasn't overwritten and the prefix wasn't
+ * defined, the map name defaults to `cmap`
+ */
+# ifndef CMAP_CFG_CMAP
+#  define CMAP_CFG_CMAP cmap
+# endif /* CMAP_CFG_CMAP */
+
+/*
+ * If no prefix was defined, default to `cmap_`
+ */
+# ifndef CMAP_CFG_PREFIX
+#  define CMAP_CFG_PREFIX CMAP_CFG_MAKE_STR1(CMAP_CFG_CMAP, _)
+# endif /* CMAP_CFG_PREFIX */
+
+/*
+ * Must be the same as the MAP_CFG_HASH_TYPE and MAP_CFG_SIZE_TYPE of
+ * the shards (`unsigned` by default, and with MAP_CFG_64BIT, `uint64_t`
+ * and `size_t`)
+ */
+# ifndef CMAP_CFG_HASH_TYPE
+#  define CMAP_CFG_HASH_TYPE unsigned
+# endif /* CMAP_CFG_HASH_TYPE */
+
+# ifndef CMAP_CFG_SIZE_TYPE
+#  define CMAP_CFG_SIZE_TYPE unsigned
+# endif /* CMAP_CFG_SIZE_TYPE */
+
+/*
+ * The map has 2^CMAP_CFG_SHARD_BITS shards. More shards means less
+ * contention, at the cost of some memory per shard. With 0, there is
+ * a single lock around a single map.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# ifndef CMAP_CFG_SHARD_BITS
+#  define CMAP_CFG_SHARD_BITS 6
+# endif /* CMAP_CFG_SHARD_BITS */
+
+# if CMAP_CFG_SHARD_BITS < 0 || CMAP_CFG_SHARD_BITS > 16
+#  error "CMAP_CFG_SHARD_BITS must be between 0 and 16"
+# endif /* CMAP_CFG_SHARD_BITS < 0 || CMAP_CFG_SHARD_BITS > 16 */
+
+/*
+ * Size of a cache line. Every shard starts on its own cache line, so
+ * taking the lock of a shard doesn't slow down threads working on the
+ * shards next to it
+ */
+# ifndef CMAP_CFG_CACHE_LINE
+#  define CMAP_CFG_CACHE_LINE 64
+# endif /* CMAP_CFG_CACHE_LINE */
+
+/*
+ * Each shard is guarded by a pthread reader/writer lock: lookups of
+ * the same shard run at the same time, and changes wait for them.
+ * Optionally, define CMAP_CFG_SPINLOCK to guard each shard with a
+ * spinlock (a C11 atomic) instead. Spinlocks are cheaper when the
+ * critical sections are as short as these, but every function takes
+ * them for exclusive use, and they waste CPU time if there are more
+ * threads than cores.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# ifdef CMAP_CFG_SPINLOCK
+/*
+ * <stdatomic.h>
+ *  atomic_bool
+ */
+#  include <stdatomic.h>
+# else /* CMAP_CFG_SPINLOCK */
+/*
+ * <pthread.h>
+ *  pthread_rwlock_t
+ */
+#  include <pthread.h>
+# endif /* CMAP_CFG_SPINLOCK */
+
+/*
+ * Internal types
+ */
+# define _CMAP_SHARD CMAP_CFG_MAKE_STR(_shard)
+
+/**
+ * @brief A shard of the map
+ */
+struct _CMAP_SHARD {
+    /** Guards `map` */
+# ifdef CMAP_CFG_SPINLOCK
+    _Alignas(CMAP_CFG_CACHE_LINE) atomic_bool lock;
+# else /* CMAP_CFG_SPINLOCK */
+    _Alignas(CMAP_CFG_CACHE_LINE) pthread_rwlock_t lock;
+# endif /* CMAP_CFG_SPINLOCK */
+
+    /** The entries whose hash falls in this shard */
+    struct CMAP_CFG_MAP map;
+};
+
+/**
+ * @brief The map type
+ */
+struct CMAP_CFG_CMAP {
+    /** The shards, 2^CMAP_CFG_SHARD_BITS of them */
+    struct _CMAP_SHARD * shards;
+
+# ifdef CMAP_CFG_SEEDED_HASH
+    /** An empty map with the seed of the shards, to hash keys without
+     *  locking a shard */
+    struct CMAP_CFG_MAP hasher;
+# endif /* CMAP_CFG_SEEDED_HASH */
+};
+
+/*==========================================================
+ * Function names
+ *=========================================================*/
+#define CMAP_ADD      CMAP_CFG_MAKE_STR(add)
+#define CMAP_CARDINAL CMAP_CFG_MAKE_STR(cardinal)
+#define CMAP_CONTAINS CMAP_CFG_MAKE_STR(contains)
+#define CMAP_FREE     CMAP_CFG_MAKE_STR(free)
+#define CMAP_GET      CMAP_CFG_MAKE_STR(get)
+#define CMAP_NEW      CMAP_CFG_MAKE_STR(new)
+#define CMAP_REMOVE   CMAP_CFG_MAKE_STR(remove)
+#define CMAP_RESERVE  CMAP_CFG_MAKE_STR(reserve)
+
+/*==========================================================
+ * Function prototypes
+ *==========================================================*/
+CMAP_CFG_SIZE_TYPE   CMAP_CARDINAL (struct CMAP_CFG_CMAP * self);
+bool                 CMAP_ADD      (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key, const CMAP_CFG_VALUE_DATA_TYPE value);
+bool                 CMAP_CONTAINS (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key);
+bool                 CMAP_GET      (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key, CMAP_CFG_VALUE_DATA_TYPE * value);
+bool                 CMAP_NEW      (struct CMAP_CFG_CMAP * self);
+bool                 CMAP_REMOVE   (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key, CMAP_CFG_VALUE_DATA_TYPE * value);
+bool                 CMAP_RESERVE  (struct CMAP_CFG_CMAP * self, CMAP_CFG_SIZE_TYPE n);
+struct CMAP_CFG_CMAP CMAP_FREE     (struct CMAP_CFG_CMAP self);
+
+#ifdef CMAP_CFG_IMPLEMENTATION
+
+#define _CMAP_HASH     CMAP_CFG_MAKE_STR(_hash)
+#define _CMAP_INIT     CMAP_CFG_MAKE_STR(_init)
+#define _CMAP_LOCK     CMAP_CFG_MAKE_STR(_lock)
+#define _CMAP_RDLOCK   CMAP_CFG_MAKE_STR(_rdlock)
+#define _CMAP_SEED     CMAP_CFG_MAKE_STR(_seed)
+#define _CMAP_SHARD_OF CMAP_CFG_MAKE_STR(_shard_of)
+#define _CMAP_UNLOCK   CMAP_CFG_MAKE_STR(_unlock)
+
+/*
+ * Functions of the map type of the shards
+ */
+#define _CMAP_MAP_ADD_WITH_HASH      CMAP_CFG_MAKE_MAP_STR(add_with_hash)
+#define _CMAP_MAP_CARDINAL           CMAP_CFG_MAKE_MAP_STR(cardinal)
+#define _CMAP_MAP_CONTAINS_WITH_HASH CMAP_CFG_MAKE_MAP_STR(contains_with_hash)
+#define _CMAP_MAP_FREE               CMAP_CFG_MAKE_MAP_STR(free)
+#define _CMAP_MAP_HASH               CMAP_CFG_MAKE_MAP_STR(hash)
+#define _CMAP_MAP_LOOKUP_WITH_HASH   CMAP_CFG_MAKE_MAP_STR(lookup_with_hash)
+#define _CMAP_MAP_NEW                CMAP_CFG_MAKE_MAP_STR(new)
+#define _CMAP_MAP_REMOVE_WITH_HASH   CMAP_CFG_MAKE_MAP_STR(remove_with_hash)
+#define _CMAP_MAP_RESERVE            CMAP_CFG_MAKE_MAP_STR(reserve)
+
+/*
+ * Define CMAP_CFG_SEEDED_HASH if the shards have MAP_CFG_SEEDED_HASH.
+ * Every shard then gets the seed of the first one, so that a key has
+ * the same hash in every shard, and the hash that picks its shard is
+ * also the one its shard uses.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+
+/*
+ * Optionally, define CMAP_CFG_HASH_FUNC as the shards' MAP_CFG_HASH_FUNC
+ * (without MAP_CFG_SEEDED_HASH) to call it directly. Otherwise the keys
+ * are hashed with MAP_HASH() of the shards
+ */
+# if defined(CMAP_CFG_HASH_FUNC) && defined(CMAP_CFG_SEEDED_HASH)
+#  error "CMAP_CFG_HASH_FUNC can't be used with CMAP_CFG_SEEDED_HASH, the hash needs the shards' seed"
+# endif /* CMAP_CFG_HASH_FUNC && CMAP_CFG_SEEDED_HASH */
+
+# ifdef CMAP_CFG_STATIC
+#  undef CMAP_CFG_STATIC
+#  define CMAP_CFG_STATIC static
+# else /* CMAP_CFG_STATIC */
+#  undef CMAP_CFG_STATIC
+#  define CMAP_CFG_STATIC
+# endif /* CMAP_CFG_STATIC */
+
+/*
+ * <limits.h>
+ *  CHAR_BIT
+ *
+ * <stdlib.h>
+ *  aligned_alloc()
+ *  free()
+ *
+ * <string.h>
+ *  memset()
+ */
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The shards have to be aligned to CMAP_CFG_CACHE_LINE, which malloc()
+ * doesn't guarantee
+ */
+# ifndef CMAP_CFG_ALIGNED_ALLOC
+#  define CMAP_CFG_ALIGNED_ALLOC aligned_alloc
+# endif /* CMAP_CFG_ALIGNED_ALLOC */
+
+# ifndef CMAP_CFG_FREE
+#  define CMAP_CFG_FREE free
+# endif /* CMAP_CFG_FREE */
+
+# define _CMAP_SHARDS ((CMAP_CFG_SIZE_TYPE) 1 << CMAP_CFG_SHARD_BITS)
+
+/*
+ * Tell the CPU it is waiting on a spinlock
+ */
+# if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define _CMAP_CPU_RELAX() __builtin_ia32_pause()
+# else
+#  define _CMAP_CPU_RELAX() ((void) 0)
+# endif
+
+/*==========================================================
+ * Function definitions
+ *=========================================================*/
+
+/**
+ * @brief Calculates the hash of a key, the same for every shard
+ * @param self The map
+ * @param key The key
+ * @returns The hash of @a key
+ *
+ * Only the seed of a shard's map is needed, and the maps of the shards
+ *     can be replaced (e.g., by MAP_RESIZE()) while holding their lock,
+ *     so it's read from a copy that never changes
+ */
+static inline CMAP_CFG_HASH_TYPE _CMAP_HASH (const struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key)
+{
+# if defined(CMAP_CFG_HASH_FUNC)
+    (void) self;
+    return CMAP_CFG_HASH_FUNC(key);
+# elif defined(CMAP_CFG_SEEDED_HASH)
+    return _CMAP_MAP_HASH(&self->hasher, key);
+# else /* CMAP_CFG_HASH_FUNC */
+    /* without a seed, MAP_HASH() doesn't look at the map */
+    (void) self;
+    return _CMAP_MAP_HASH(NULL, key);
+# endif /* CMAP_CFG_HASH_FUNC */
+}
+
+/**
+ * @brief Calculates the shard of an entry
+ * @param hash The hash of the key of the entry
+ * @returns The index of the shard
+ *
+ * The hash is mixed (with the finalizer of MurmurHash3) and the top bits
+ * are used, so that weak hashes are still spread over all the shards,
+ * and the keys of a shard aren't all in the same few entry arrays (or
+ * slots) of its map
+ */
+static inline CMAP_CFG_SIZE_TYPE _CMAP_SHARD_OF (CMAP_CFG_HASH_TYPE hash)
+{
+# if CMAP_CFG_SHARD_BITS == 0
+    (void) hash;
+    return 0;
+# else /* CMAP_CFG_SHARD_BITS == 0 */
+    unsigned long long h = hash;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return (CMAP_CFG_SIZE_TYPE) (h >> (sizeof(h) * CHAR_BIT - CMAP_CFG_SHARD_BITS));
+# endif /* CMAP_CFG_SHARD_BITS == 0 */
+}
+
+/**
+ * @brief Takes the lock of a shard for exclusive use, waiting for it
+ *        if needed
+ * @param shard The shard
+ */
+static inline void _CMAP_LOCK (struct _CMAP_SHARD * shard)
+{
+# ifdef CMAP_CFG_SPINLOCK
+    while (atomic_exchange_explicit(&shard->lock, true, memory_order_acquire))
+        while (atomic_load_explicit(&shard->lock, memory_order_relaxed))
+            _CMAP_CPU_RELAX();
+# else /* CMAP_CFG_SPINLOCK */
+    pthread_rwlock_wrlock(&shard->lock);
+# endif /* CMAP_CFG_SPINLOCK */
+}
+
+/**
+ * @brief Takes the lock of a shard for reading, waiting for it if
+ *        needed. Other readers may hold it at the same time (not with
+ *        CMAP_CFG_SPINLOCK)
+ * @param shard The shard
+ */
+static inline void _CMAP_RDLOCK (struct _CMAP_SHARD * shard)
+{
+# ifdef CMAP_CFG_SPINLOCK
+    _CMAP_LOCK(shard);
+# else /* CMAP_CFG_SPINLOCK */
+    pthread_rwlock_rdlock(&shard->lock);
+# endif /* CMAP_CFG_SPINLOCK */
+}
+
+/**
+ * @brief Releases the lock of a shard
+ * @param shard The shard
+ */
+static inline void _CMAP_UNLOCK (struct _CMAP_SHARD * shard)
+{
+# ifdef CMAP_CFG_SPINLOCK
+    atomic_store_explicit(&shard->lock, false, memory_order_release);
+# else /* CMAP_CFG_SPINLOCK */
+    pthread_rwlock_unlock(&shard->lock);
+# endif /* CMAP_CFG_SPINLOCK */
+}
+
+/**
+ * @brief Allocates the shards, with uninitialized (zeroed) maps
+ * @param self The map
+ * @returns `true` if it successfully allocated the shards and created
+ *          their locks
+ */
+static bool _CMAP_INIT (struct CMAP_CFG_CMAP * self)
+{
+    struct _CMAP_SHARD * shards = CMAP_CFG_ALIGNED_ALLOC(CMAP_CFG_CACHE_LINE, _CMAP_SHARDS * sizeof(*shards));
+
+    if (shards == NULL)
+        return false;
+
+    memset(shards, 0, _CMAP_SHARDS * sizeof(*shards));
+
+    for (CMAP_CFG_SIZE_TYPE i = 0; i < _CMAP_SHARDS; i++) {
+# ifdef CMAP_CFG_SPINLOCK
+        atomic_init(&shards[i].lock, false);
+# else /* CMAP_CFG_SPINLOCK */
+        if (pthread_rwlock_init(&shards[i].lock, NULL) != 0) {
+            while (i-- > 0)
+                pthread_rwlock_destroy(&shards[i].lock);
+            CMAP_CFG_FREE(shards);
+            return false;
+        }
+# endif /* CMAP_CFG_SPINLOCK */
+    }
+
+    self->shards = shards;
+    return true;
+}
+
+/**
+ * @brief Gives every shard, and the hasher, the seed of the first
+ *        shard (with CMAP_CFG_SEEDED_HASH). The shards must be empty
+ * @param self The map
+ */
+static void _CMAP_SEED (struct CMAP_CFG_CMAP * self)
+{
+# ifdef CMAP_CFG_SEEDED_HASH
+    self->hasher = (struct CMAP_CFG_MAP) { .seed = self->shards[0].map.seed };
+    for (CMAP_CFG_SIZE_TYPE i = 1; i < _CMAP_SHARDS; i++)
+        self->shards[i].map.seed = self->shards[0].map.seed;
+# else /* CMAP_CFG_SEEDED_HASH */
+    (void) self;
+# endif /* CMAP_CFG_SEEDED_HASH */
+}
+
+/**
+ * @brief Adds an entry to the map, or replaces the value of the entry
+ *        with the same key. Same as MAP_ADD() of the shard
+ * @param self The map
+ * @param key The key
+ * @param value The value
+ * @returns `true` if it successfully added the entry
+ */
+CMAP_CFG_STATIC bool CMAP_ADD (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key, const CMAP_CFG_VALUE_DATA_TYPE value)
+{
+    if (self == NULL || self->shards == NULL)
+        return false;
+
+    CMAP_CFG_HASH_TYPE hash = _CMAP_HASH(self, key);
+    struct _CMAP_SHARD * shard = self->shards + _CMAP_SHARD_OF(hash);
+
+    _CMAP_LOCK(shard);
+    bool ret = _CMAP_MAP_ADD_WITH_HASH(&shard->map, key, hash, value);
+    _CMAP_UNLOCK(shard);
+
+    return ret;
+}
+
+/**
+ * @brief Calculates the cardinal (number of entries) in the map
+ * @param self The map
+ * @returns The number of entries in the map
+ *
+ * The shards are counted one at a time, so entries added or removed
+ *     by other threads in the meantime may or may not be counted
+ */
+CMAP_CFG_STATIC CMAP_CFG_SIZE_TYPE CMAP_CARDINAL (struct CMAP_CFG_CMAP * self)
+{
+    if (self == NULL || self->shards == NULL)
+        return 0;
+
+    CMAP_CFG_SIZE_TYPE ret = 0;
+
+    for (CMAP_CFG_SIZE_TYPE i = 0; i < _CMAP_SHARDS; i++) {
+        struct _CMAP_SHARD * shard = self->shards + i;
+        _CMAP_RDLOCK(shard);
+        ret += _CMAP_MAP_CARDINAL(&shard->map);
+        _CMAP_UNLOCK(shard);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Checks if the map contains an entry with a given key
+ * @param self The map
+ * @param key The key
+ * @returns `true` if there's an entry with @a key
+ */
+CMAP_CFG_STATIC bool CMAP_CONTAINS (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key)
+{
+    if (self == NULL || self->shards == NULL)
+        return false;
+
+    CMAP_CFG_HASH_TYPE hash = _CMAP_HASH(self, key);
+    struct _CMAP_SHARD * shard = self->shards + _CMAP_SHARD_OF(hash);
+
+    _CMAP_RDLOCK(shard);
+    bool ret = _CMAP_MAP_CONTAINS_WITH_HASH(&shard->map, key, hash);
+    _CMAP_UNLOCK(shard);
+
+    return ret;
+}
+
+/**
+ * @brief Gets the value associated with a given key, if there is one.
+ *        Unlike MAP_GET(), the key doesn't have to be in the map, since
+ *        another thread may have just removed it
+ * @param self The map
+ * @param key The key
+ * @param[out] value Where to put the value. Left untouched if there's
+ *             no entry with @a key. May be NULL
+ * @returns `true` if there's an entry with @a key
+ */
+CMAP_CFG_STATIC bool CMAP_GET (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key, CMAP_CFG_VALUE_DATA_TYPE * value)
+{
+    if (self == NULL || self->shards == NULL)
+        return false;
+
+    CMAP_CFG_HASH_TYPE hash = _CMAP_HASH(self, key);
+    struct _CMAP_SHARD * shard = self->shards + _CMAP_SHARD_OF(hash);
+
+    _CMAP_RDLOCK(shard);
+    bool ret = _CMAP_MAP_LOOKUP_WITH_HASH(&shard->map, key, hash, value);
+    _CMAP_UNLOCK(shard);
+
+    return ret;
+}
+
+/**
+ * @brief Initializes a map, with the shards' default size
+ * @param self The map
+ * @returns `true` if it successfully initialized the map
+ *
+ * Not thread safe: no other function may use the map before this one
+ *     returns
+ */
+CMAP_CFG_STATIC bool CMAP_NEW (struct CMAP_CFG_CMAP * self)
+{
+    if (self == NULL || !_CMAP_INIT(self))
+        return false;
+
+    for (CMAP_CFG_SIZE_TYPE i = 0; i < _CMAP_SHARDS; i++) {
+        if (!_CMAP_MAP_NEW(&self->shards[i].map)) {
+            *self = CMAP_FREE(*self);
+            return false;
+        }
+    }
+
+    _CMAP_SEED(self);
+
+    return true;
+}
+
+/**
+ * @brief Removes an entry from the map. Same as MAP_REMOVE() of the
+ *        shard
+ * @param self The map
+ * @param key The key
+ * @param[out] value Where to put the value of the removed entry. If
+ *             NULL, the value is destroyed with MAP_CFG_VALUE_DTOR()
+ * @returns `true` if there was an entry with @a key
+ */
+CMAP_CFG_STATIC bool CMAP_REMOVE (struct CMAP_CFG_CMAP * self, const CMAP_CFG_KEY_DATA_TYPE key, CMAP_CFG_VALUE_DATA_TYPE * value)
+{
+    if (self == NULL || self->shards == NULL)
+        return false;
+
+    CMAP_CFG_HASH_TYPE hash = _CMAP_HASH(self, key);
+    struct _CMAP_SHARD * shard = self->shards + _CMAP_SHARD_OF(hash);
+
+    _CMAP_LOCK(shard);
+    bool ret = _CMAP_MAP_REMOVE_WITH_HASH(&shard->map, key, hash, value);
+    _CMAP_UNLOCK(shard);
+
+    return ret;
+}
+
+/**
+ * @brief Makes sure the map can hold at least @a n entries without
+ *        its shards having to grow. If the map hasn't been initialized
+ *        yet, it is initialized with big enough shards
+ * @param self The map
+ * @param n The expected number of entries
+ * @returns `true` if every shard can hold its share of @a n entries
+ *          without growing
+ *
+ * Thread safe only if the map was already initialized
+ */
+CMAP_CFG_STATIC bool CMAP_RESERVE (struct CMAP_CFG_CMAP * self, CMAP_CFG_SIZE_TYPE n)
+{
+    if (self == NULL)
+        return false;
+
+    bool initialized = self->shards != NULL;
+    if (!initialized && !_CMAP_INIT(self))
+        return false;
+
+    /* the keys don't split evenly, leave some room for that */
+    CMAP_CFG_SIZE_TYPE share = n / _CMAP_SHARDS;
+    share += share / 8 + 1;
+
+    bool ret = true;
+    for (CMAP_CFG_SIZE_TYPE i = 0; ret && i < _CMAP_SHARDS; i++) {
+        struct _CMAP_SHARD * shard = self->shards + i;
+        _CMAP_LOCK(shard);
+        ret = _CMAP_MAP_RESERVE(&shard->map, share);
+        _CMAP_UNLOCK(shard);
+    }
+
+    if (!ret && !initialized)
+        *self = CMAP_FREE(*self);
+    else if (!initialized)
+        _CMAP_SEED(self);
+
+    return ret;
+}
+
+/**
+ * @brief Cleans and frees the map, and the entries of every shard
+ *        (see MAP_FREE())
+ * @param self The map
+ * @returns A new empty (clean) map
+ *
+ * Not thread safe: no other function may be using the map
+ */
+CMAP_CFG_STATIC struct CMAP_CFG_CMAP CMAP_FREE (struct CMAP_CFG_CMAP self)
+{
+    if (self.shards != NULL) {
+        for (CMAP_CFG_SIZE_TYPE i = 0; i < _CMAP_SHARDS; i++) {
+            self.shards[i].map = _CMAP_MAP_FREE(self.shards[i].map);
+# ifndef CMAP_CFG_SPINLOCK
+            pthread_rwlock_destroy(&self.shards[i].lock);
+# endif /* CMAP_CFG_SPINLOCK */
+        }
+
+        CMAP_CFG_FREE(self.shards);
+    }
+
+    return (struct CMAP_CFG_CMAP) {0};
+}
+
+/*==========================================================
+ * Implementation clean up
+ *=========================================================*/
+
+/*
+ * Functions
+ */
+#undef _CMAP_HASH
+#undef _CMAP_INIT
+#undef _CMAP_LOCK
+#undef _CMAP_RDLOCK
+#undef _CMAP_SEED
+#undef _CMAP_SHARD_OF
+#undef _CMAP_UNLOCK
+
+/*
+ * Functions of the shards
+ */
+#undef _CMAP_MAP_ADD_WITH_HASH
+#undef _CMAP_MAP_CARDINAL
+#undef _CMAP_MAP_CONTAINS_WITH_HASH
+#undef _CMAP_MAP_FREE
+#undef _CMAP_MAP_HASH
+#undef _CMAP_MAP_LOOKUP_WITH_HASH
+#undef _CMAP_MAP_NEW
+#undef _CMAP_MAP_REMOVE_WITH_HASH
+#undef _CMAP_MAP_RESERVE
+
+/*
+ * Other
+ */
+#undef CMAP_CFG_ALIGNED_ALLOC
+#undef CMAP_CFG_FREE
+#undef CMAP_CFG_HASH_FUNC
+#undef CMAP_CFG_STATIC
+#undef _CMAP_CPU_RELAX
+#undef _CMAP_SHARDS
+
+#endif /* CMAP_CFG_IMPLEMENTATION */
+
+/*==========================================================
+ * Header clean up
+ *=========================================================*/
+
+/*
+ * Functions
+ */
+#undef CMAP_ADD
+#undef CMAP_CARDINAL
+#undef CMAP_CONTAINS
+#undef CMAP_FREE
+#undef CMAP_GET
+#undef CMAP_NEW
+#undef CMAP_REMOVE
+#undef CMAP_RESERVE
+
+/*
+ * Types
+ */
+#undef _CMAP_SHARD
+
+/*
+ * Other
+ */
+#undef CMAP_CFG_CACHE_LINE
+#undef CMAP_CFG_CMAP
+#undef CMAP_CFG_CONCAT
+#undef CMAP_CFG_HASH_TYPE
+#undef CMAP_CFG_KEY_DATA_TYPE
+#undef CMAP_CFG_MAKE_MAP_STR
+#undef CMAP_CFG_MAKE_STR
+#undef CMAP_CFG_MAKE_STR1
+#undef CMAP_CFG_MAP
+#undef CMAP_CFG_MAP_PREFIX
+#undef CMAP_CFG_PREFIX
+#undef CMAP_CFG_SEEDED_HASH
+#undef CMAP_CFG_SHARD_BITS
+#undef CMAP_CFG_SIZE_TYPE
+#undef CMAP_CFG_SPINLOCK
+#undef CMAP_CFG_VALUE_DATA_TYPE
+
+/*==========================================================
+ * License
+ *==========================================================
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
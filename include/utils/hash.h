@@ -0,0 +1,243 @@
+/* hash - v2026.10.18-0
+ *
+ * Hash functions for hash tables, for integers (hash_u32(),
+ * hash_u64()), pointers (hash_ptr()), NUL terminated strings
+ * (hash_str()) and byte spans (hash_bytes()). Every bit of the input
+ * affects every bit of the hash, so any bits of it (the low ones of a
+ * power of two table, or `hash % size`) are well distributed. See
+ * MAP_CFG_HASH_INT, ... in `map.h`, and `examples/hashbench`.
+ *
+ * Every hash depends on a 64-bit seed as well as on the input. When the
+ * keys of a hash table come from untrusted input, a random seed per
+ * table (see MAP_CFG_SEEDED_HASH in `map.h`) keeps anyone who doesn't
+ * know it from picking keys that collide (hash flooding). Use
+ * hash_bytes() or hash_str() for that: the integer hashes only mix the
+ * seed in with a xor, they are built for speed.
+ *
+ * hash_bytes() follows wyhash (by Wang Yi, public domain): the input is
+ * read 16 bytes (48 for long inputs, in 3 independent lanes) at a time,
+ * and mixed with 64x64 to 128 bit multiplications. It's fast, and good
+ * enough against flooding, but it isn't a cryptographic MAC. Inputs are
+ * read in the machine's byte order, so hashes differ between little
+ * and big endian machines.
+ *
+ * The most up to date version of this file can be found at
+ * `include/utils/hash.h` on [siiky/c-utils](https://github.com/siiky/c-utils)
+ */
+#ifndef _HASH_H
+#define _HASH_H
+
+/*
+ * <stddef.h>
+ *  size_t
+ *
+ * <stdint.h>
+ *  UINT64_C()
+ *  uint32_t
+ *  uint64_t
+ *  uint8_t
+ *  uintptr_t
+ *
+ * <string.h>
+ *  memcpy()
+ *  strlen()
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * The default secret of wyhash, odd numbers with 32 bits set
+ */
+#define _HASH_SECRET0 UINT64_C(0x2d358dccaa6c78a5)
+#define _HASH_SECRET1 UINT64_C(0x8bb84b93962eacc9)
+#define _HASH_SECRET2 UINT64_C(0x4b33a62ed433d4a3)
+#define _HASH_SECRET3 UINT64_C(0x4d5a2da51de1aa47)
+
+/**
+ * @brief Multiplies @a a and @a b
+ * @param[in,out] a Gets the low 64 bits of the 128 bit product
+ * @param[in,out] b Gets the high 64 bits of the 128 bit product
+ */
+static inline void _hash_mul (uint64_t * a, uint64_t * b)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 r = (unsigned __int128) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = *a >> 32;
+    uint64_t hb = *b >> 32;
+    uint64_t la = (uint32_t) *a;
+    uint64_t lb = (uint32_t) *b;
+    uint64_t rm0 = ha * lb;
+    uint64_t rm1 = hb * la;
+    uint64_t rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32);
+    *b = ha * hb + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    *a = lo;
+#endif
+}
+
+/**
+ * @brief Multiplies @a a and @a b, and folds the 128 bit product
+ * @returns The low 64 bits of the product xor the high 64 bits
+ */
+static inline uint64_t _hash_mix (uint64_t a, uint64_t b)
+{
+    _hash_mul(&a, &b);
+    return a ^ b;
+}
+
+/**
+ * @brief Reads 8 bytes from @a p (unaligned)
+ */
+static inline uint64_t _hash_read8 (const uint8_t * p)
+{
+    uint64_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+/**
+ * @brief Reads 4 bytes from @a p (unaligned)
+ */
+static inline uint64_t _hash_read4 (const uint8_t * p)
+{
+    uint32_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+/**
+ * @brief Reads the first, middle and last of @a len (1 to 3) bytes
+ *        from @a p
+ */
+static inline uint64_t _hash_read3 (const uint8_t * p, size_t len)
+{
+    return ((uint64_t) p[0] << 16)
+        | ((uint64_t) p[len >> 1] << 8)
+        | p[len - 1];
+}
+
+/**
+ * @brief Hashes @a len bytes from @a data, with seed @a seed
+ * @param data The bytes (may be NULL if @a len is 0)
+ * @param len The number of bytes
+ * @param seed The seed
+ * @returns The hash
+ */
+static inline uint64_t hash_bytes (const void * data, size_t len, uint64_t seed)
+{
+    const uint8_t * p = data;
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    seed ^= _hash_mix(seed ^ _HASH_SECRET0, _HASH_SECRET1);
+
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t mid = (len >> 3) << 2;
+            a = (_hash_read4(p) << 32) | _hash_read4(p + mid);
+            b = (_hash_read4(p + len - 4) << 32) | _hash_read4(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = _hash_read3(p, len);
+        }
+    } else {
+        size_t i = len;
+
+        if (i > 48) {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+
+            do {
+                seed = _hash_mix(_hash_read8(p) ^ _HASH_SECRET1, _hash_read8(p + 8) ^ seed);
+                seed1 = _hash_mix(_hash_read8(p + 16) ^ _HASH_SECRET2, _hash_read8(p + 24) ^ seed1);
+                seed2 = _hash_mix(_hash_read8(p + 32) ^ _HASH_SECRET3, _hash_read8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        for (; i > 16; i -= 16, p += 16)
+            seed = _hash_mix(_hash_read8(p) ^ _HASH_SECRET1, _hash_read8(p + 8) ^ seed);
+
+        /* the last 16 bytes, even if some were already read */
+        a = _hash_read8(p + i - 16);
+        b = _hash_read8(p + i - 8);
+    }
+
+    a ^= _HASH_SECRET1;
+    b ^= seed;
+
+    _hash_mul(&a, &b);
+
+    return _hash_mix(a ^ _HASH_SECRET0 ^ (uint64_t) len, b ^ _HASH_SECRET1);
+}
+
+/**
+ * @brief Hashes the 32-bit integer @a key, with seed @a seed
+ * @param key The integer
+ * @param seed The seed
+ * @returns The hash
+ *
+ * A single multiply-xorshift: the product of the (64-bit) key and an
+ *     odd constant, with its high half folded into the low half
+ */
+static inline uint64_t hash_u32 (uint32_t key, uint64_t seed)
+{
+    uint64_t x = (key ^ seed) * UINT64_C(0x9e3779b97f4a7c15);
+    return x ^ (x >> 32);
+}
+
+/**
+ * @brief Hashes the 64-bit integer @a key, with seed @a seed
+ * @param key The integer
+ * @param seed The seed
+ * @returns The hash
+ *
+ * Two rounds of multiply-xorshift (the moremur mixer, by Pelle
+ *     Evensen). Each step can be undone, so different keys (with the
+ *     same seed) never have the same hash
+ */
+static inline uint64_t hash_u64 (uint64_t key, uint64_t seed)
+{
+    uint64_t x = key ^ seed;
+    x ^= x >> 27;
+    x *= UINT64_C(0x3c79ac492ba7b653);
+    x ^= x >> 33;
+    x *= UINT64_C(0x1c69b3f74ac4ae35);
+    x ^= x >> 27;
+    return x;
+}
+
+/**
+ * @brief Hashes the address @a ptr, with seed @a seed
+ * @param ptr The address
+ * @param seed The seed
+ * @returns The hash
+ *
+ * Addresses have their low bits (alignment) and high bits mostly the
+ *     same, that's why they need a mixer more than most integers
+ */
+static inline uint64_t hash_ptr (const void * ptr, uint64_t seed)
+{
+    return hash_u64((uint64_t) (uintptr_t) ptr, seed);
+}
+
+/**
+ * @brief Hashes the NUL terminated string @a str, with seed @a seed
+ * @param str The string (!NULL)
+ * @param seed The seed
+ * @returns The hash
+ */
+static inline uint64_t hash_str (const char * str, uint64_t seed)
+{
+    /* strlen() is vectorized by the C library, and leaves it in cache */
+    return hash_bytes(str, strlen(str), seed);
+}
+
+#endif /* _HASH_H */
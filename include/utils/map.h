@@ -17,6 +17,13 @@
  */
 #include <stdbool.h>
 
+/*
+ * <stdint.h>
+ *  SIZE_MAX
+ *  uint16_t
+ */
+#include <stdint.h>
+
 /*
  * Magic from `sort.h`
  */
@@ -32,11 +39,23 @@
 # endif /* MAP_CFG_KEY_DATA_TYPE */
 
 /*
- * Type of the values for the map to hold
+ * Type of the values for the map to hold.
+ * Alternatively, define MAP_CFG_NO_VALUE to make a set instead: entries
+ * only have a key (and its hash), so they take no more memory than
+ * that. MAP_ADD(), MAP_REMOVE() and MAP_FROM_ARRAYS() take no values,
+ * the functions that only deal with values (MAP_GET(), MAP_LOOKUP(),
+ * MAP_ENTRY(), ...) aren't there, and MAP_UNION(), MAP_INTERSECTION()
+ * and MAP_DIFFERENCE() are. MAP_UNION() isn't there with
+ * MAP_CFG_KEY_DTOR: it would have to copy keys that both sets then own
+ * (and destroy). See `set.h`.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
  */
-# ifndef MAP_CFG_VALUE_DATA_TYPE
+# if defined(MAP_CFG_NO_VALUE) && (defined(MAP_CFG_VALUE_DATA_TYPE) || defined(MAP_CFG_VALUE_DTOR))
+#  error "MAP_CFG_NO_VALUE can't be used with MAP_CFG_VALUE_DATA_TYPE or MAP_CFG_VALUE_DTOR"
+# elif !defined(MAP_CFG_NO_VALUE) && !defined(MAP_CFG_VALUE_DATA_TYPE)
 #  error "Must define MAP_CFG_VALUE_DATA_TYPE"
-# endif /* MAP_CFG_VALUE_DATA_TYPE */
+# endif /* MAP_CFG_NO_VALUE && (MAP_CFG_VALUE_DATA_TYPE || MAP_CFG_VALUE_DTOR) */
 
 /*
  * If the map name wasn't overwritten and the prefix wasn't
@@ -53,121 +72,685 @@
 #  define MAP_CFG_PREFIX MAP_CFG_MAKE_STR1(MAP_CFG_MAP, _)
 # endif /* MAP_CFG_PREFIX */
 
+/*
+ * Optionally, define MAP_CFG_OPEN_ADDRESSING to store all entries in
+ * a single flat array of slots (with a power of two size), instead of
+ * an array of separately allocated entry arrays. Every slot has a
+ * control byte, that holds 7 bits of the hash of its key (or whether
+ * it is empty or deleted). Lookups compare a whole group of control
+ * bytes at once (16 with SSE2, 32 with AVX2), and only compare keys
+ * of slots whose control byte matches.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+
+/*
+ * Optionally, with MAP_CFG_OPEN_ADDRESSING, define MAP_CFG_ROBIN_HOOD
+ * to probe one slot at a time instead (linear probing), with Robin Hood
+ * insertion: a new entry takes the slot of the first entry that is
+ * closer to its own home slot (the slot its hash maps to), and the
+ * rest of the run of full slots moves one slot forward. Every run stays
+ * sorted by home slot, so a lookup stops as soon as it reaches an entry
+ * closer to its home than the key would be. Removing an entry moves the
+ * rest of the run one slot back (backward-shift deletion) instead of
+ * leaving a tombstone. Probe lengths stay short and even at high loads
+ * (MAP_CFG_MAX_LOAD defaults to 0.9), see MAP_PROBE_STATS().
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# if defined(MAP_CFG_ROBIN_HOOD) && !defined(MAP_CFG_OPEN_ADDRESSING)
+#  error "MAP_CFG_ROBIN_HOOD needs MAP_CFG_OPEN_ADDRESSING"
+# endif /* MAP_CFG_ROBIN_HOOD && !MAP_CFG_OPEN_ADDRESSING */
+
+/*
+ * Optionally, define MAP_CFG_INCREMENTAL_RESIZE (separate chaining
+ * only) to make MAP_RESIZE() only allocate the new table. The entries
+ * are then moved a few entry arrays at a time, by the functions that
+ * change the map (MAP_ADD(), MAP_ENTRY(), MAP_GET_PTR(), MAP_REMOVE(),
+ * ...), so no single call pays for the whole resize. Lookups look in
+ * both tables instead. Only those functions move entries: the lookups
+ * that take a const map (MAP_GET(), MAP_LOOKUP(), MAP_CONTAINS(), ...)
+ * don't, so a map that is only read after a resize keeps both tables
+ * (and looks in both) until it's changed again, or MAP_ITER() or
+ * MAP_RESIZE() finish the resize.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# if defined(MAP_CFG_INCREMENTAL_RESIZE) && defined(MAP_CFG_OPEN_ADDRESSING)
+#  error "MAP_CFG_INCREMENTAL_RESIZE can't be used with MAP_CFG_OPEN_ADDRESSING"
+# endif /* MAP_CFG_INCREMENTAL_RESIZE && MAP_CFG_OPEN_ADDRESSING */
+
+/*
+ * Optionally, define MAP_CFG_ARENA (separate chaining only) to carve the
+ * entry arrays out of big chunks (of MAP_CFG_ARENA_CHUNK bytes, 64KiB by
+ * default) owned by the map, instead of allocating each one on its own.
+ * Entry arrays have a power of two capacity (but the ones made by
+ * MAP_FROM_ARRAYS(), that fit exactly), and the ones that shrink or
+ * grow go back to a free list of their size, for the next entry array
+ * that needs one. A map with a million entry arrays is then a few dozen
+ * allocations, MAP_FREE() only frees the chunks (and the table), and
+ * entry arrays allocated one after the other are next to each other in
+ * memory. MAP_RESIZE() and MAP_FROM_ARRAYS() lay out the entry arrays
+ * in table order. The memory of the chunks is only given back by
+ * MAP_FREE() (and MAP_RESIZE(), without MAP_CFG_INCREMENTAL_RESIZE).
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# if defined(MAP_CFG_ARENA) && defined(MAP_CFG_OPEN_ADDRESSING)
+#  error "MAP_CFG_ARENA can't be used with MAP_CFG_OPEN_ADDRESSING"
+# endif /* MAP_CFG_ARENA && MAP_CFG_OPEN_ADDRESSING */
+
+/*
+ * Optionally, define MAP_CFG_SEEDED_HASH to give every map a random
+ * seed, that MAP_CFG_HASH_FUNC() gets along with the key. Use it when
+ * the keys come from untrusted input: with a keyed hash (e.g.,
+ * hash_bytes() of `hash.h`, see MAP_CFG_HASH_BYTES), keys can't be
+ * picked to all land in the same entry array without knowing the seed.
+ * Hashes depend on the map, get them with MAP_HASH() for the
+ * `*_WITH_HASH()` functions.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+
+/*
+ * Optionally, define MAP_CFG_HASH_TYPE as the (unsigned integer) type
+ * returned by MAP_CFG_HASH_FUNC(), and MAP_CFG_SIZE_TYPE as the
+ * (unsigned integer) type of table sizes, entry counts and indices.
+ * Both default to `unsigned`, which limits a map to less than 4G
+ * entries, and makes hash collisions (each one costs a key comparison)
+ * common way before that.
+ * Define MAP_CFG_64BIT to default to `uint64_t` hashes and `size_t`
+ * sizes instead.
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# ifdef MAP_CFG_64BIT
+/*
+ * <stddef.h>
+ *  size_t
+ *
+ * <stdint.h>
+ *  uint64_t
+ */
+#  include <stddef.h>
+#  include <stdint.h>
+
+#  ifndef MAP_CFG_HASH_TYPE
+#   define MAP_CFG_HASH_TYPE uint64_t
+#  endif /* MAP_CFG_HASH_TYPE */
+
+#  ifndef MAP_CFG_SIZE_TYPE
+#   define MAP_CFG_SIZE_TYPE size_t
+#  endif /* MAP_CFG_SIZE_TYPE */
+# endif /* MAP_CFG_64BIT */
+
+# ifndef MAP_CFG_HASH_TYPE
+#  define MAP_CFG_HASH_TYPE unsigned
+# endif /* MAP_CFG_HASH_TYPE */
+
+# ifndef MAP_CFG_SIZE_TYPE
+#  define MAP_CFG_SIZE_TYPE unsigned
+# endif /* MAP_CFG_SIZE_TYPE */
+
+/*
+ * Internal types
+ */
+# define _MAP_ARENA  MAP_CFG_MAKE_STR(_arena)
+# define _MAP_BUCKET MAP_CFG_MAKE_STR(_bucket)
+# define _MAP_ENTRY  MAP_CFG_MAKE_STR(_entry)
+
+/**
+ * @brief An entry of the map
+ */
+struct _MAP_ENTRY {
+    /** The hash of the key of this entry */
+    MAP_CFG_HASH_TYPE hash;
+
+    /** The key of this entry */
+    MAP_CFG_KEY_DATA_TYPE key;
+
+# ifndef MAP_CFG_NO_VALUE
+    /** The value of this entry */
+    MAP_CFG_VALUE_DATA_TYPE value;
+# endif /* MAP_CFG_NO_VALUE */
+};
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief An entry array of the map
+ */
+struct _MAP_BUCKET {
+    /** An array of entries */
+    struct _MAP_ENTRY * entries;
+
+    /** Number of entries in this entry array */
+    MAP_CFG_SIZE_TYPE length;
+
+    /*
+     * since a call to realloc() (even if decreasing size)
+     * may fail, the total capacity has to be kept
+     * (maybe could be free slots?)
+     */
+    /** Maximum number of entries the array can hold */
+    MAP_CFG_SIZE_TYPE capacity;
+};
+
+#  ifdef MAP_CFG_ARENA
+/*
+ * <stddef.h>
+ *  size_t
+ */
+#   include <stddef.h>
+
+/**
+ * @brief Where the entry arrays of a map come from, see MAP_CFG_ARENA
+ */
+struct _MAP_ARENA {
+    /** The chunks, each one starting with a pointer to the next */
+    void * chunks;
+
+    /** The part of the newest chunk that wasn't used yet */
+    unsigned char * next;
+
+    /** Size of `next`, in bytes */
+    size_t left;
+
+    /**
+     * Entry arrays that aren't in use, by capacity: each one of
+     * `free[c]` has room for 2^c entries, and starts with a pointer to
+     * the next one
+     */
+    void * free[sizeof(MAP_CFG_SIZE_TYPE) * 8];
+};
+#  endif /* MAP_CFG_ARENA */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
 /**
  * @brief The map type
  */
 struct MAP_CFG_MAP {
-    /** The map, an array of arrays of entries */
-    struct {
-        /** An array of entries */
-        struct {
-            /** The hash of the key of this entry */
-            unsigned hash;
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    /** Control bytes, one per slot (same allocation as `slots`) */
+    unsigned char * ctrl;
 
-            /** The key of this entry */
-            MAP_CFG_KEY_DATA_TYPE key;
+    /** The map, a flat array of slots */
+    struct _MAP_ENTRY * slots;
 
-            /** The value of this entry */
-            MAP_CFG_VALUE_DATA_TYPE value;
-        } * entries;
+    /** Number of slots (always a power of two) */
+    MAP_CFG_SIZE_TYPE size;
 
-        /** Number of entries in this entry array */
-        unsigned length;
+    /** Number of entries stored currently */
+    MAP_CFG_SIZE_TYPE cardinal;
 
-        /*
-         * since a call to realloc() (even if decreasing size)
-         * may fail, the total capacity has to be kept
-         * (maybe could be free slots?)
-         */
-        /** Maximum number of entries the array can hold */
-        unsigned capacity;
-    } * table;
+    /** Number of deleted slots (tombstones, always 0 with MAP_CFG_ROBIN_HOOD) */
+    MAP_CFG_SIZE_TYPE deleted;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    /** The map, an array of arrays of entries */
+    struct _MAP_BUCKET * table;
 
-    /** Table size (fixed on initialization) */
-    unsigned size;
+    /** Table size (grows with the number of entries, see MAP_CFG_MAX_LOAD) */
+    MAP_CFG_SIZE_TYPE size;
 
     /** Number of entries stored currently */
-    unsigned cardinal;
+    MAP_CFG_SIZE_TYPE cardinal;
 
-    /** A little cache */
-    struct {
-        /** Whether the following info is still valid */
-        bool valid;
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    /** The table being moved into `table` (NULL if not resizing) */
+    struct _MAP_BUCKET * old_table;
+
+    /** Size of `old_table` */
+    MAP_CFG_SIZE_TYPE old_size;
+
+    /** Entry arrays of `old_table` before this index are already empty */
+    MAP_CFG_SIZE_TYPE migrated;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
 
-        /** Hash of the last entry that has been updated/looked up */
-        unsigned hash;
+#  ifdef MAP_CFG_ARENA
+    /** Where the entry arrays (of both tables) come from */
+    struct _MAP_ARENA arena;
+#  endif /* MAP_CFG_ARENA */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
 
-        /** Index of the entry in the entry array */
-        unsigned idx;
-    } lc;
+# ifdef MAP_CFG_SEEDED_HASH
+    /** Seed of the hash function, picked when the map is initialized */
+    uint64_t seed;
+# endif /* MAP_CFG_SEEDED_HASH */
 
     /** An iterator */
     struct {
         /** Whether it is iterating */
         bool ing;
 
-        /** The table index */
-        unsigned tblidx;
+        /** The table index (slot index with open addressing) */
+        MAP_CFG_SIZE_TYPE tblidx;
 
         /** The entry index */
-        unsigned entidx;
+        MAP_CFG_SIZE_TYPE entidx;
     } iter;
 };
 
+# define MAP_LC MAP_CFG_MAKE_STR(lc)
+
+/**
+ * @brief A lookup cache, owned by the caller, for MAP_GET_LC() and
+ *        MAP_CONTAINS_LC(). Remembers where the last entry found was,
+ *        so looking up the same key again skips the search. Must be
+ *        zero initialized. It may go stale when the map changes, which
+ *        only costs a search
+ */
+struct MAP_LC {
+    /** Whether the following info is valid */
+    bool valid;
+
+    /** Hash of the last entry found */
+    MAP_CFG_HASH_TYPE hash;
+
+    /** Index of the entry in its entry array (or its slot) */
+    MAP_CFG_SIZE_TYPE idx;
+};
+
+# define MAP_CURSOR MAP_CFG_MAKE_STR(cursor)
+# define MAP_FROZEN MAP_CFG_MAKE_STR(frozen)
+# define MAP_IMAGE  MAP_CFG_MAKE_STR(image)
+
+# ifdef MAP_CFG_ROBIN_HOOD
+#  define MAP_PROBE_STATS MAP_CFG_MAKE_STR(probe_stats)
+
+/**
+ * @brief Probe length statistics of a map, see MAP_PROBE_STATS()
+ */
+struct MAP_PROBE_STATS {
+    /** Most slots looked at to find an entry */
+    MAP_CFG_SIZE_TYPE max;
+
+    /** Mean number of slots looked at to find an entry */
+    double mean;
+};
+# endif /* MAP_CFG_ROBIN_HOOD */
+
+/**
+ * @brief A cursor over (part of) a map, owned by the caller. Unlike the
+ *        map's own iterator, it doesn't change the map, so any number of
+ *        cursors can go over the same map at the same time (nested, or
+ *        from different threads). The map must not change while a
+ *        cursor is in use
+ */
+struct MAP_CURSOR {
+    /** The map */
+    const struct MAP_CFG_MAP * map;
+
+    /*
+     * with MAP_CFG_INCREMENTAL_RESIZE, the entry arrays of `old_table`
+     * come first, then the ones of `table`
+     */
+    /** The table index (slot index with open addressing) */
+    MAP_CFG_SIZE_TYPE tblidx;
+
+    /** The entry index */
+    MAP_CFG_SIZE_TYPE entidx;
+
+    /** The table index where this cursor stops */
+    MAP_CFG_SIZE_TYPE end;
+};
+
+/**
+ * @brief A frozen map, made by MAP_FREEZE(). It can't be changed, but
+ *        finding a key takes a single slot and key comparison: the
+ *        entries are placed with a minimal perfect hash function
+ *        (PTHash style). Keys are split in buckets, and each bucket has
+ *        a pilot, that picks positions for its keys that no other key
+ *        has. Positions past the last slot are remapped to the free
+ *        slots, so every slot has an entry. The few entries that can't
+ *        be placed (see `overflow`) are binary searched by hash, after
+ *        a key isn't found in its slot
+ */
+struct MAP_FROZEN {
+    /** The pilot of each bucket */
+    uint16_t * pilots;
+
+    /** The entries, one per slot */
+    struct _MAP_ENTRY * slots;
+
+    /** The slot of each position from `nslots` on */
+    MAP_CFG_SIZE_TYPE * remap;
+
+    /**
+     * Entries that couldn't be placed (keys with the same hash as
+     * another key, or a bucket with no pilot that works), sorted by
+     * hash
+     */
+    struct _MAP_ENTRY * overflow;
+
+    /** Number of buckets */
+    MAP_CFG_SIZE_TYPE nbuckets;
+
+    /** Number of positions (a little more than the number of entries) */
+    MAP_CFG_SIZE_TYPE npos;
+
+    /** Number of slots */
+    MAP_CFG_SIZE_TYPE nslots;
+
+    /** Number of entries in `overflow` */
+    MAP_CFG_SIZE_TYPE noverflow;
+
+# ifdef MAP_CFG_SEEDED_HASH
+    /** Seed of the hash function, the same as the map's */
+    uint64_t seed;
+# endif /* MAP_CFG_SEEDED_HASH */
+};
+
+/*
+ * Optionally, define MAP_CFG_IMAGE to be able to save a map to a file
+ * (an image) with MAP_IMAGE_WRITE(), and look keys up straight from
+ * the file with MAP_IMAGE_OPEN() and MAP_IMAGE_GET(), which maps it to
+ * memory (mmap()) instead of reading it. Nothing is built when an
+ * image is opened, and processes that open the same image share the
+ * same pages. Keys and values must be plain data (no pointers), and
+ * images can only be opened by programs built with the same types,
+ * hash function and ABI as the one that wrote them.
+ * Needs POSIX (e.g., `_POSIX_C_SOURCE 200112L` with `-std=c18`).
+ * Must be defined (or not) both where the header is included and where
+ * the implementation is created
+ */
+# ifdef MAP_CFG_IMAGE
+/*
+ * <stddef.h>
+ *  size_t
+ */
+#  include <stddef.h>
+
+/**
+ * @brief A map image opened with MAP_IMAGE_OPEN(). The entries with
+ *        the same `hash % nbuckets` are together, from
+ *        `entries[starts[i]]` to `entries[starts[i + 1]]`
+ */
+struct MAP_IMAGE {
+    /** Where the file is mapped */
+    void * base;
+
+    /** Length of the file */
+    size_t length;
+
+    /** Where the entries of each bucket start (`nbuckets + 1`) */
+    const MAP_CFG_SIZE_TYPE * starts;
+
+    /** The entries */
+    const struct _MAP_ENTRY * entries;
+
+    /** Number of buckets */
+    MAP_CFG_SIZE_TYPE nbuckets;
+
+    /** Number of entries */
+    MAP_CFG_SIZE_TYPE cardinal;
+
+#  ifdef MAP_CFG_SEEDED_HASH
+    /** Seed of the hash function, the same as the map's */
+    uint64_t seed;
+#  endif /* MAP_CFG_SEEDED_HASH */
+};
+# endif /* MAP_CFG_IMAGE */
+
 /*==========================================================
  * Function names
  *=========================================================*/
-#define MAP_ADD       MAP_CFG_MAKE_STR(add)
-#define MAP_CARDINAL  MAP_CFG_MAKE_STR(cardinal)
-#define MAP_CONTAINS  MAP_CFG_MAKE_STR(contains)
-#define MAP_FREE      MAP_CFG_MAKE_STR(free)
-#define MAP_GET       MAP_CFG_MAKE_STR(get)
-#define MAP_IS_EMPTY  MAP_CFG_MAKE_STR(is_empty)
-#define MAP_ITER      MAP_CFG_MAKE_STR(iter)
-#define MAP_ITERING   MAP_CFG_MAKE_STR(itering)
-#define MAP_ITER_END  MAP_CFG_MAKE_STR(iter_end)
-#define MAP_ITER_KEY  MAP_CFG_MAKE_STR(iter_key)
-#define MAP_ITER_NEXT MAP_CFG_MAKE_STR(iter_next)
-#define MAP_ITER_VAL  MAP_CFG_MAKE_STR(iter_val)
-#define MAP_NEW       MAP_CFG_MAKE_STR(new)
-#define MAP_REMOVE    MAP_CFG_MAKE_STR(remove)
-#define MAP_RESIZE    MAP_CFG_MAKE_STR(resize)
-#define MAP_WITH_SIZE MAP_CFG_MAKE_STR(with_size)
+#define MAP_ADD                MAP_CFG_MAKE_STR(add)
+#define MAP_ADD_WITH_HASH      MAP_CFG_MAKE_STR(add_with_hash)
+#define MAP_CARDINAL           MAP_CFG_MAKE_STR(cardinal)
+#define MAP_CONTAINS           MAP_CFG_MAKE_STR(contains)
+#define MAP_CONTAINS_LC        MAP_CFG_MAKE_STR(contains_lc)
+#define MAP_CONTAINS_MANY      MAP_CFG_MAKE_STR(contains_many)
+#define MAP_CONTAINS_WITH_HASH MAP_CFG_MAKE_STR(contains_with_hash)
+#define MAP_CURSOR_BEGIN       MAP_CFG_MAKE_STR(cursor_begin)
+#define MAP_CURSOR_KEY         MAP_CFG_MAKE_STR(cursor_key)
+#define MAP_CURSOR_NEXT        MAP_CFG_MAKE_STR(cursor_next)
+#define MAP_CURSOR_SPLIT       MAP_CFG_MAKE_STR(cursor_split)
+#define MAP_CURSOR_VALID       MAP_CFG_MAKE_STR(cursor_valid)
+#define MAP_CURSOR_VALUE       MAP_CFG_MAKE_STR(cursor_value)
+#define MAP_DIFFERENCE         MAP_CFG_MAKE_STR(difference)
+#define MAP_ENTRY              MAP_CFG_MAKE_STR(entry)
+#define MAP_ENTRY_WITH_HASH    MAP_CFG_MAKE_STR(entry_with_hash)
+#define MAP_FREE               MAP_CFG_MAKE_STR(free)
+#define MAP_FREEZE             MAP_CFG_MAKE_STR(freeze)
+#define MAP_FROM_ARRAYS        MAP_CFG_MAKE_STR(from_arrays)
+#define MAP_FROZEN_CONTAINS    MAP_CFG_MAKE_STR(frozen_contains)
+#define MAP_FROZEN_FREE        MAP_CFG_MAKE_STR(frozen_free)
+#define MAP_FROZEN_GET         MAP_CFG_MAKE_STR(frozen_get)
+#define MAP_GET                MAP_CFG_MAKE_STR(get)
+#define MAP_GET_LC             MAP_CFG_MAKE_STR(get_lc)
+#define MAP_GET_MANY           MAP_CFG_MAKE_STR(get_many)
+#define MAP_GET_PTR            MAP_CFG_MAKE_STR(get_ptr)
+#define MAP_GET_PTR_WITH_HASH  MAP_CFG_MAKE_STR(get_ptr_with_hash)
+#define MAP_GET_WITH_HASH      MAP_CFG_MAKE_STR(get_with_hash)
+#define MAP_HASH               MAP_CFG_MAKE_STR(hash)
+#define MAP_IMAGE_CLOSE        MAP_CFG_MAKE_STR(image_close)
+#define MAP_IMAGE_CONTAINS     MAP_CFG_MAKE_STR(image_contains)
+#define MAP_IMAGE_GET          MAP_CFG_MAKE_STR(image_get)
+#define MAP_IMAGE_OPEN         MAP_CFG_MAKE_STR(image_open)
+#define MAP_IMAGE_WRITE        MAP_CFG_MAKE_STR(image_write)
+#define MAP_INTERSECTION       MAP_CFG_MAKE_STR(intersection)
+#define MAP_IS_EMPTY           MAP_CFG_MAKE_STR(is_empty)
+#define MAP_ITER               MAP_CFG_MAKE_STR(iter)
+#define MAP_ITERING            MAP_CFG_MAKE_STR(itering)
+#define MAP_ITER_END           MAP_CFG_MAKE_STR(iter_end)
+#define MAP_ITER_KEY           MAP_CFG_MAKE_STR(iter_key)
+#define MAP_ITER_NEXT          MAP_CFG_MAKE_STR(iter_next)
+#define MAP_ITER_VAL           MAP_CFG_MAKE_STR(iter_val)
+#define MAP_LOOKUP             MAP_CFG_MAKE_STR(lookup)
+#define MAP_LOOKUP_WITH_HASH   MAP_CFG_MAKE_STR(lookup_with_hash)
+#define MAP_NEW                MAP_CFG_MAKE_STR(new)
+#define MAP_REMOVE             MAP_CFG_MAKE_STR(remove)
+#define MAP_REMOVE_WITH_HASH   MAP_CFG_MAKE_STR(remove_with_hash)
+#define MAP_RESERVE            MAP_CFG_MAKE_STR(reserve)
+#define MAP_RESIZE             MAP_CFG_MAKE_STR(resize)
+#define MAP_RESIZE_PARALLEL    MAP_CFG_MAKE_STR(resize_parallel)
+#define MAP_RETAIN             MAP_CFG_MAKE_STR(retain)
+#define MAP_UNION              MAP_CFG_MAKE_STR(union)
+#define MAP_UPSERT             MAP_CFG_MAKE_STR(upsert)
+#define MAP_UPSERT_WITH_HASH   MAP_CFG_MAKE_STR(upsert_with_hash)
+#define MAP_WITH_SIZE          MAP_CFG_MAKE_STR(with_size)
 
 /*==========================================================
  * Function prototypes
  *==========================================================*/
-MAP_CFG_KEY_DATA_TYPE   MAP_ITER_KEY  (const struct MAP_CFG_MAP * self);
-MAP_CFG_VALUE_DATA_TYPE MAP_GET       (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
-MAP_CFG_VALUE_DATA_TYPE MAP_ITER_VAL  (const struct MAP_CFG_MAP * self);
-bool                    MAP_ADD       (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value);
-bool                    MAP_CONTAINS  (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
-bool                    MAP_IS_EMPTY  (const struct MAP_CFG_MAP * self);
-bool                    MAP_ITER      (struct MAP_CFG_MAP * self);
-bool                    MAP_ITERING   (const struct MAP_CFG_MAP * self);
-bool                    MAP_ITER_END  (struct MAP_CFG_MAP * self);
-bool                    MAP_ITER_NEXT (struct MAP_CFG_MAP * self);
-bool                    MAP_NEW       (struct MAP_CFG_MAP * self);
-bool                    MAP_REMOVE    (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value);
-bool                    MAP_RESIZE    (struct MAP_CFG_MAP * self, unsigned new_size);
-bool                    MAP_WITH_SIZE (struct MAP_CFG_MAP * self, unsigned size);
-struct MAP_CFG_MAP      MAP_FREE      (struct MAP_CFG_MAP self);
-unsigned                MAP_CARDINAL  (const struct MAP_CFG_MAP * self);
+
+/*
+ * Functions that take a `const` map (MAP_GET(), MAP_CONTAINS(),
+ * MAP_LOOKUP(), ...) don't change it, so any number of threads can call
+ * them on the same map at the same time, as long as none changes it
+ */
+MAP_CFG_HASH_TYPE         MAP_HASH               (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
+MAP_CFG_KEY_DATA_TYPE     MAP_CURSOR_KEY         (const struct MAP_CURSOR * cur);
+MAP_CFG_KEY_DATA_TYPE     MAP_ITER_KEY           (const struct MAP_CFG_MAP * self);
+MAP_CFG_SIZE_TYPE         MAP_CARDINAL           (const struct MAP_CFG_MAP * self);
+MAP_CFG_SIZE_TYPE         MAP_CURSOR_SPLIT       (const struct MAP_CFG_MAP * self, struct MAP_CURSOR * cursors, MAP_CFG_SIZE_TYPE k);
+MAP_CFG_SIZE_TYPE         MAP_CONTAINS_MANY      (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, bool * out_found);
+bool                      MAP_CONTAINS           (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
+bool                      MAP_CONTAINS_LC        (const struct MAP_CFG_MAP * self, struct MAP_LC * lc, const MAP_CFG_KEY_DATA_TYPE key);
+bool                      MAP_CONTAINS_WITH_HASH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash);
+bool                      MAP_CURSOR_BEGIN       (const struct MAP_CFG_MAP * self, struct MAP_CURSOR * cur);
+bool                      MAP_CURSOR_NEXT        (struct MAP_CURSOR * cur);
+bool                      MAP_CURSOR_VALID       (const struct MAP_CURSOR * cur);
+bool                      MAP_FREEZE             (struct MAP_CFG_MAP * self, struct MAP_FROZEN * frozen);
+bool                      MAP_FROZEN_CONTAINS    (const struct MAP_FROZEN * frozen, const MAP_CFG_KEY_DATA_TYPE key);
+bool                      MAP_IS_EMPTY           (const struct MAP_CFG_MAP * self);
+bool                      MAP_ITER               (struct MAP_CFG_MAP * self);
+bool                      MAP_ITERING            (const struct MAP_CFG_MAP * self);
+bool                      MAP_ITER_END           (struct MAP_CFG_MAP * self);
+bool                      MAP_ITER_NEXT          (struct MAP_CFG_MAP * self);
+bool                      MAP_NEW                (struct MAP_CFG_MAP * self);
+bool                      MAP_RESERVE            (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE n);
+bool                      MAP_RESIZE             (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE new_size);
+bool                      MAP_RESIZE_PARALLEL    (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE new_size, MAP_CFG_SIZE_TYPE nthreads);
+bool                      MAP_WITH_SIZE          (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE size);
+struct MAP_CFG_MAP        MAP_FREE               (struct MAP_CFG_MAP self);
+struct MAP_FROZEN         MAP_FROZEN_FREE        (struct MAP_FROZEN frozen);
+
+# ifdef MAP_CFG_NO_VALUE
+bool                      MAP_ADD                (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
+bool                      MAP_ADD_WITH_HASH      (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash);
+bool                      MAP_DIFFERENCE         (struct MAP_CFG_MAP * self, const struct MAP_CFG_MAP * other);
+bool                      MAP_FROM_ARRAYS        (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, MAP_CFG_SIZE_TYPE nthreads);
+bool                      MAP_INTERSECTION       (struct MAP_CFG_MAP * self, const struct MAP_CFG_MAP * other);
+bool                      MAP_REMOVE             (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
+bool                      MAP_REMOVE_WITH_HASH   (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash);
+MAP_CFG_SIZE_TYPE         MAP_RETAIN             (struct MAP_CFG_MAP * self, bool (* pred) (const MAP_CFG_KEY_DATA_TYPE key, void * ctx), void * ctx);
+#  ifndef MAP_CFG_KEY_DTOR
+bool                      MAP_UNION              (struct MAP_CFG_MAP * self, const struct MAP_CFG_MAP * other);
+#  endif /* MAP_CFG_KEY_DTOR */
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_VALUE_DATA_TYPE   MAP_GET_LC             (const struct MAP_CFG_MAP * self, struct MAP_LC * lc, const MAP_CFG_KEY_DATA_TYPE key);
+MAP_CFG_SIZE_TYPE         MAP_GET_MANY           (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, MAP_CFG_VALUE_DATA_TYPE * out_values, bool * out_found);
+MAP_CFG_SIZE_TYPE         MAP_RETAIN             (struct MAP_CFG_MAP * self, bool (* pred) (const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value, void * ctx), void * ctx);
+MAP_CFG_VALUE_DATA_TYPE   MAP_GET                (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
+MAP_CFG_VALUE_DATA_TYPE   MAP_GET_WITH_HASH      (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash);
+MAP_CFG_VALUE_DATA_TYPE   MAP_CURSOR_VALUE       (const struct MAP_CURSOR * cur);
+MAP_CFG_VALUE_DATA_TYPE   MAP_ITER_VAL           (const struct MAP_CFG_MAP * self);
+MAP_CFG_VALUE_DATA_TYPE * MAP_ENTRY              (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, bool * inserted);
+MAP_CFG_VALUE_DATA_TYPE * MAP_ENTRY_WITH_HASH    (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, bool * inserted);
+MAP_CFG_VALUE_DATA_TYPE * MAP_GET_PTR            (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key);
+MAP_CFG_VALUE_DATA_TYPE * MAP_GET_PTR_WITH_HASH  (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash);
+MAP_CFG_VALUE_DATA_TYPE * MAP_UPSERT             (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value);
+MAP_CFG_VALUE_DATA_TYPE * MAP_UPSERT_WITH_HASH   (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, const MAP_CFG_VALUE_DATA_TYPE value);
+bool                      MAP_ADD                (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value);
+bool                      MAP_ADD_WITH_HASH      (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, const MAP_CFG_VALUE_DATA_TYPE value);
+bool                      MAP_FROM_ARRAYS        (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, const MAP_CFG_VALUE_DATA_TYPE * values, MAP_CFG_SIZE_TYPE n, MAP_CFG_SIZE_TYPE nthreads);
+bool                      MAP_FROZEN_GET         (const struct MAP_FROZEN * frozen, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value);
+bool                      MAP_LOOKUP             (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value);
+bool                      MAP_LOOKUP_WITH_HASH   (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_VALUE_DATA_TYPE * value);
+bool                      MAP_REMOVE             (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value);
+bool                      MAP_REMOVE_WITH_HASH   (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_VALUE_DATA_TYPE * value);
+# endif /* MAP_CFG_NO_VALUE */
+
+# ifdef MAP_CFG_IMAGE
+bool                      MAP_IMAGE_CLOSE        (struct MAP_IMAGE * img);
+bool                      MAP_IMAGE_CONTAINS     (const struct MAP_IMAGE * img, const MAP_CFG_KEY_DATA_TYPE key);
+#  ifndef MAP_CFG_NO_VALUE
+bool                      MAP_IMAGE_GET          (const struct MAP_IMAGE * img, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value);
+#  endif /* MAP_CFG_NO_VALUE */
+bool                      MAP_IMAGE_OPEN         (struct MAP_IMAGE * img, const char * path);
+bool                      MAP_IMAGE_WRITE        (const struct MAP_CFG_MAP * self, const char * path);
+# endif /* MAP_CFG_IMAGE */
+
+# ifdef MAP_CFG_ROBIN_HOOD
+struct MAP_PROBE_STATS    MAP_PROBE_STATS        (const struct MAP_CFG_MAP * self);
+# endif /* MAP_CFG_ROBIN_HOOD */
 
 #ifdef MAP_CFG_IMPLEMENTATION
 
+#define _MAP_ARENA_ALLOC       MAP_CFG_MAKE_STR(_arena_alloc)
+#define _MAP_ARENA_CHUNK       MAP_CFG_MAKE_STR(_arena_chunk)
+#define _MAP_ARENA_CLASS       MAP_CFG_MAKE_STR(_arena_class)
+#define _MAP_ARENA_FREE        MAP_CFG_MAKE_STR(_arena_free)
+#define _MAP_ARENA_RELEASE     MAP_CFG_MAKE_STR(_arena_release)
+#define _MAP_BUCKET_SEARCH     MAP_CFG_MAKE_STR(_bucket_search)
+#define _MAP_BUILD             MAP_CFG_MAKE_STR(_build)
+#define _MAP_BUILD_AT          MAP_CFG_MAKE_STR(_build_at)
+#define _MAP_BUILD_CHUNK       MAP_CFG_MAKE_STR(_build_chunk)
+#define _MAP_BUILD_COUNT       MAP_CFG_MAKE_STR(_build_count)
+#define _MAP_BUILD_FILL        MAP_CFG_MAKE_STR(_build_fill)
+#define _MAP_BUILD_HASH        MAP_CFG_MAKE_STR(_build_hash)
+#define _MAP_BUILD_JOB         MAP_CFG_MAKE_STR(_build_job)
+#define _MAP_BUILD_MOVE        MAP_CFG_MAKE_STR(_build_move)
+#define _MAP_BUILD_PART        MAP_CFG_MAKE_STR(_build_part)
+#define _MAP_BUILD_RUN         MAP_CFG_MAKE_STR(_build_run)
+#define _MAP_BUILD_SCATTER     MAP_CFG_MAKE_STR(_build_scatter)
+#define _MAP_BUILD_SPREAD      MAP_CFG_MAKE_STR(_build_spread)
+#define _MAP_CHANGE_CAPACITY   MAP_CFG_MAKE_STR(_change_capacity)
+#define _MAP_CTZ               MAP_CFG_MAKE_STR(_ctz)
+#define _MAP_CURSOR_BUCKET     MAP_CFG_MAKE_STR(_cursor_bucket)
+#define _MAP_CURSOR_ENTRY      MAP_CFG_MAKE_STR(_cursor_entry)
+#define _MAP_CURSOR_PART       MAP_CFG_MAKE_STR(_cursor_part)
+#define _MAP_CURSOR_SEEK       MAP_CFG_MAKE_STR(_cursor_seek)
 #define _MAP_DECREASE_CAPACITY MAP_CFG_MAKE_STR(_decrease_capacity)
 #define _MAP_ENTRY_CMP         MAP_CFG_MAKE_STR(_entry_cmp)
+#define _MAP_FILTER            MAP_CFG_MAKE_STR(_filter)
+#define _MAP_FILTER_BUCKET     MAP_CFG_MAKE_STR(_filter_bucket)
+#define _MAP_FIB               MAP_CFG_MAKE_STR(_fib)
+#define _MAP_FIND              MAP_CFG_MAKE_STR(_find)
+#define _MAP_FIND_OR_INSERT    MAP_CFG_MAKE_STR(_find_or_insert)
+#define _MAP_FREE_TABLE        MAP_CFG_MAKE_STR(_free_table)
+#define _MAP_FROZEN_BUCKET     MAP_CFG_MAKE_STR(_frozen_bucket)
+#define _MAP_FROZEN_CMP        MAP_CFG_MAKE_STR(_frozen_cmp)
+#define _MAP_FROZEN_FIND       MAP_CFG_MAKE_STR(_frozen_find)
+#define _MAP_FROZEN_POS        MAP_CFG_MAKE_STR(_frozen_pos)
+#define _MAP_GROUP_FREE        MAP_CFG_MAKE_STR(_group_free)
+#define _MAP_GROUP_MATCH       MAP_CFG_MAKE_STR(_group_match)
+#define _MAP_GROW              MAP_CFG_MAKE_STR(_grow)
+#define _MAP_H2                MAP_CFG_MAKE_STR(_h2)
+#define _MAP_HASH_KEY          MAP_CFG_MAKE_STR(_hash_key)
+#define _MAP_IMAGE_ALIGN       MAP_CFG_MAKE_STR(_image_align)
+#define _MAP_IMAGE_FIND        MAP_CFG_MAKE_STR(_image_find)
+#define _MAP_IMAGE_HEADER      MAP_CFG_MAKE_STR(_image_header)
 #define _MAP_INCREASE_CAPACITY MAP_CFG_MAKE_STR(_increase_capacity)
+#define _MAP_INDEX             MAP_CFG_MAKE_STR(_index)
+#define _MAP_INSERT_AT         MAP_CFG_MAKE_STR(_insert_at)
 #define _MAP_INSERT_SORTED     MAP_CFG_MAKE_STR(_insert_sorted)
+#define _MAP_KEEP_IN           MAP_CFG_MAKE_STR(_keep_in)
+#define _MAP_KEEP_NOT_IN       MAP_CFG_MAKE_STR(_keep_not_in)
+#define _MAP_KEEP_PRED         MAP_CFG_MAKE_STR(_keep_pred)
+#define _MAP_LOAD_LIMIT        MAP_CFG_MAKE_STR(_load_limit)
+#define _MAP_LOOKUP_MANY       MAP_CFG_MAKE_STR(_lookup_many)
+#define _MAP_MIGRATE           MAP_CFG_MAKE_STR(_migrate)
+#define _MAP_MIGRATE_BUCKET    MAP_CFG_MAKE_STR(_migrate_bucket)
+#define _MAP_MIGRATE_STEP      MAP_CFG_MAKE_STR(_migrate_step)
+#define _MAP_MIX64             MAP_CFG_MAKE_STR(_mix64)
+#define _MAP_OA_ALLOC          MAP_CFG_MAKE_STR(_oa_alloc)
+#define _MAP_OA_DIST           MAP_CFG_MAKE_STR(_oa_dist)
+#define _MAP_OA_ERASE          MAP_CFG_MAKE_STR(_oa_erase)
+#define _MAP_OA_GROW           MAP_CFG_MAKE_STR(_oa_grow)
+#define _MAP_OA_MAKE_ROOM      MAP_CFG_MAKE_STR(_oa_make_room)
+#define _MAP_OA_REHASH         MAP_CFG_MAKE_STR(_oa_rehash)
+#define _MAP_OA_SEARCH         MAP_CFG_MAKE_STR(_oa_search)
+#define _MAP_POW2              MAP_CFG_MAKE_STR(_pow2)
+#define _MAP_REHASH            MAP_CFG_MAKE_STR(_rehash)
+#define _MAP_RETAIN            MAP_CFG_MAKE_STR(_retain)
 #define _MAP_SEARCH            MAP_CFG_MAKE_STR(_search)
+#define _MAP_SEED              MAP_CFG_MAKE_STR(_seed)
+#define _MAP_SIZE_FOR          MAP_CFG_MAKE_STR(_size_for)
 
 /*
- * Hash function for the keys
+ * Hash function for the keys. With MAP_CFG_SEEDED_HASH it is called
+ * with the seed of the map as well, `MAP_CFG_HASH_FUNC(key, seed)`,
+ * with a `uint64_t` seed.
+ * Alternatively, define one of the following to use a hash function of
+ * `hash.h`, seeded with the seed of the map (or 0):
+ *  * MAP_CFG_HASH_INT for integer keys (hash_u32() or hash_u64())
+ *  * MAP_CFG_HASH_PTR for pointer keys, hashing the address (hash_ptr())
+ *  * MAP_CFG_HASH_STR for NUL terminated string keys (hash_str())
+ *  * MAP_CFG_HASH_BYTES to hash the bytes of the keys (hash_bytes()),
+ *    for keys that are plain data without padding
+ */
+# if defined(MAP_CFG_HASH_FUNC) + defined(MAP_CFG_HASH_BYTES) + defined(MAP_CFG_HASH_INT) + defined(MAP_CFG_HASH_PTR) + defined(MAP_CFG_HASH_STR) > 1
+#  error "Only one of MAP_CFG_HASH_FUNC, MAP_CFG_HASH_BYTES, MAP_CFG_HASH_INT, MAP_CFG_HASH_PTR and MAP_CFG_HASH_STR can be defined"
+# elif defined(MAP_CFG_HASH_BYTES) || defined(MAP_CFG_HASH_INT) || defined(MAP_CFG_HASH_PTR) || defined(MAP_CFG_HASH_STR)
+/*
+ * "hash.h"
+ *  hash_bytes()
+ *  hash_ptr()
+ *  hash_str()
+ *  hash_u32()
+ *  hash_u64()
  */
-# ifndef MAP_CFG_HASH_FUNC
+#  include "hash.h"
+#  define _MAP_HASH_BUILTIN
+#  ifdef MAP_CFG_SEEDED_HASH
+#   define MAP_CFG_HASH_FUNC _MAP_HASH_KEY
+#  else /* MAP_CFG_SEEDED_HASH */
+#   define MAP_CFG_HASH_FUNC(key) _MAP_HASH_KEY(key, 0)
+#  endif /* MAP_CFG_SEEDED_HASH */
+# elif !defined(MAP_CFG_HASH_FUNC)
 #  error "Must define MAP_CFG_HASH_FUNC"
-# endif /* MAP_CFG_HASH_FUNC */
+# endif /* MAP_CFG_HASH_FUNC + ... > 1 */
+
+/*
+ * Hash of @a key, given @a obj (a map, or anything else with the same
+ * seed, maybe NULL)
+ */
+# ifdef MAP_CFG_SEEDED_HASH
+#  define _MAP_HASH(obj, key) MAP_CFG_HASH_FUNC(key, ((obj) != NULL) ? (obj)->seed : 0)
+# else /* MAP_CFG_SEEDED_HASH */
+#  define _MAP_HASH(obj, key) MAP_CFG_HASH_FUNC(key)
+# endif /* MAP_CFG_SEEDED_HASH */
 
 /*
  * How to compare keys (like `strcmp()`)
@@ -188,10 +771,14 @@ unsigned                MAP_CARDINAL  (const struct MAP_CFG_MAP * self);
  * <assert.h>
  *  assert()
  *
+ * <limits.h>
+ *  CHAR_BIT
+ *
  * <stdlib.h>
  *  calloc()
  *  free()
  *  malloc()
+ *  qsort()
  *  realloc()
  *
  * <string.h>
@@ -199,9 +786,50 @@ unsigned                MAP_CARDINAL  (const struct MAP_CFG_MAP * self);
  *  memset()
  */
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+# ifdef MAP_CFG_IMAGE
+/*
+ * <fcntl.h>
+ *  O_RDONLY
+ *  open()
+ *
+ * <stdint.h>
+ *  uint32_t
+ *  uint64_t
+ *
+ * <stdio.h>
+ *  FILE
+ *  SEEK_SET
+ *  fclose()
+ *  fopen()
+ *  fseeko()
+ *  fwrite()
+ *
+ * <sys/mman.h>
+ *  MAP_FAILED
+ *  MAP_SHARED
+ *  PROT_READ
+ *  mmap()
+ *  munmap()
+ *
+ * <sys/stat.h>
+ *  fstat()
+ *  struct stat
+ *
+ * <unistd.h>
+ *  close()
+ */
+#  include <fcntl.h>
+#  include <stdint.h>
+#  include <stdio.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+# endif /* MAP_CFG_IMAGE */
+
 # ifndef MAP_CFG_MALLOC
 #  define MAP_CFG_MALLOC malloc
 # endif /* MAP_CFG_MALLOC */
@@ -234,555 +862,4289 @@ unsigned                MAP_CARDINAL  (const struct MAP_CFG_MAP * self);
 #  define MAP_MOD(hash, size) ((hash) % (size))
 # endif /* MAP_MOD */
 
-/**
- * @brief Tries to decrease the total capacity of an entry array to
- *        its length
- * @param self The map
- * @param tblidx The index of the entry array
- * @returns `true` if the array was already at the minimum capacity or
- *          it successfully decreased it, `false` otherwise
+/*
+ * With separate chaining, define MAP_CFG_POW2 to keep the table size a
+ * power of two (sizes given to MAP_WITH_SIZE(), MAP_RESIZE(), ... and
+ * MAP_CFG_DEFAULT_SIZE are rounded up), and pick the entry array with
+ * a multiplicative (Fibonacci) hash of the top bits instead of
+ * MAP_MOD(). Every bit of the hash affects the index, so weak hashes
+ * (e.g., the identity, or multiples of some power of two) are still
+ * spread over the table, without a division.
+ *
+ * Define MAP_CFG_POW2_MASK as well (it implies MAP_CFG_POW2) to use
+ * only the low bits of the hash, which is even cheaper but should only
+ * be used with a hash whose low bits are already well distributed
  */
-static bool _MAP_DECREASE_CAPACITY (struct MAP_CFG_MAP * self, unsigned tblidx)
-{
-    if (self->table[tblidx].length == self->table[tblidx].capacity)
-        return true;
+# if defined(MAP_CFG_POW2_MASK) && !defined(MAP_CFG_POW2)
+#  define MAP_CFG_POW2
+# endif /* MAP_CFG_POW2_MASK && !MAP_CFG_POW2 */
 
-    if (self->table[tblidx].length == 0) { /* avoid double free */
-        MAP_CFG_FREE(self->table[tblidx].entries);
-        self->table[tblidx].entries = NULL;
-        self->table[tblidx].capacity = 0;
-        return true;
-    }
+/*
+ * Maximum load factor: the average number of entries per entry array
+ * or, with open addressing, the fraction of slots in use. MAP_ADD()
+ * grows the table when a new entry would go over it.
+ * With separate chaining, define it as 0 to keep the table size fixed
+ */
+/*
+ * Optionally, define MAP_CFG_THREADS to make MAP_FROM_ARRAYS() and
+ * MAP_RESIZE_PARALLEL() use POSIX threads (<pthread.h>). Otherwise,
+ * they do the same work in the calling thread
+ */
+/*
+ * With MAP_CFG_SEEDED_HASH, define MAP_CFG_SEED_FUNC() (no arguments,
+ * returns a `uint64_t`) to pick the seed of new maps from a proper
+ * random source (e.g., getrandom() or arc4random()). By default the
+ * seed mixes the time, the processor time, and the addresses of the
+ * map and the stack, which is hard to guess from outside the process
+ * (with ASLR), but isn't cryptographically random
+ */
+# if defined(MAP_CFG_SEEDED_HASH) && !defined(MAP_CFG_SEED_FUNC)
+/*
+ * <time.h>
+ *  clock()
+ *  time()
+ */
+#  include <time.h>
+# endif /* MAP_CFG_SEEDED_HASH && !MAP_CFG_SEED_FUNC */
 
-    unsigned cap = self->table[tblidx].length;
-    void * entries = MAP_CFG_REALLOC(self->table[tblidx].entries,
-            sizeof(*self->table[tblidx].entries) * cap);
-    bool ret = entries != NULL;
+# ifdef MAP_CFG_THREADS
+/*
+ * <pthread.h>
+ *  pthread_create()
+ *  pthread_join()
+ *  pthread_t
+ */
+#  include <pthread.h>
+# endif /* MAP_CFG_THREADS */
 
-    if (ret) {
-        self->table[tblidx].entries = entries;
-        self->table[tblidx].capacity = cap;
-    }
+/*
+ * How many keys MAP_GET_MANY() and MAP_CONTAINS_MANY() hash and
+ * prefetch before looking any of them up
+ */
+# ifndef MAP_CFG_BATCH
+#  define MAP_CFG_BATCH 16
+# endif /* MAP_CFG_BATCH */
 
-    return ret;
-}
+/*
+ * Hint that @a addr will be read soon
+ */
+# if defined(__GNUC__)
+#  define _MAP_PREFETCH(addr) __builtin_prefetch(addr)
+# else
+#  define _MAP_PREFETCH(addr) ((void) (addr))
+# endif
+
+/*
+ * Biggest value of MAP_CFG_SIZE_TYPE
+ */
+# define _MAP_SIZE_MAX ((MAP_CFG_SIZE_TYPE) -1)
+
+# ifndef MAP_CFG_MAX_LOAD
+#  ifdef MAP_CFG_ROBIN_HOOD
+#   define MAP_CFG_MAX_LOAD 0.9
+#  elif defined(MAP_CFG_OPEN_ADDRESSING)
+#   define MAP_CFG_MAX_LOAD 0.875
+#  else /* MAP_CFG_ROBIN_HOOD */
+#   define MAP_CFG_MAX_LOAD 2.0
+#  endif /* MAP_CFG_ROBIN_HOOD */
+# endif /* MAP_CFG_MAX_LOAD */
+
+/*
+ * With separate chaining, the new capacity of a full entry array of
+ * capacity @a cap. Must be bigger than @a cap
+ */
+# ifndef MAP_CFG_BUCKET_GROW
+/* new_cap = (cap * 1.5) + 1 */
+#  define MAP_CFG_BUCKET_GROW(cap) ((cap) + ((cap) >> 1) + 1)
+# endif /* MAP_CFG_BUCKET_GROW */
+
+/*
+ * With separate chaining, whether an entry array with @a len entries
+ * and capacity @a cap should shrink (to MAP_CFG_BUCKET_GROW(len), or
+ * be freed if empty). Leave enough of a gap between growing and
+ * shrinking so adding and removing the same entry doesn't reallocate
+ * every time
+ */
+# ifndef MAP_CFG_BUCKET_SHRINK
+/* less than a quarter of the capacity in use? */
+#  define MAP_CFG_BUCKET_SHRINK(len, cap) ((len) < ((cap) >> 2))
+# endif /* MAP_CFG_BUCKET_SHRINK */
 
 /**
- * @brief Compares two entries based on hash and key
- * @param ha Hash of the first entry
- * @param ka Key of the first entry
- * @param hb Hash of the second entry
- * @param kb Key of the second entry
- * @returns <0 if (ha, ka) < (hb, kb), or
- *          >0 if (ha, ka) > (hb, kb), or
- *           0 if (ha, ka) == (hb, kb).
- *           The keys are compared with MAP_CFG_KEY_CMP()
- *
- * entryCmp (ha, ka) (hb, kb)
- *     | ha < hb   = LT
- *     | ha > hb   = GT
- *     | otherwise = keyCmp ka kb
- *
- * This function establishes a strict total order on entries iff
- * MAP_CFG_KEY_CMP() establishes a strict total order on keys
+ * @brief Calculates how many entries a table of size @a size may hold
+ *        before it has to grow, according to MAP_CFG_MAX_LOAD
+ * @param size The table size
+ * @returns The maximum number of entries (at least 1)
  */
-static inline int _MAP_ENTRY_CMP (unsigned ha, const MAP_CFG_KEY_DATA_TYPE ka, unsigned hb, const MAP_CFG_KEY_DATA_TYPE kb)
+static inline MAP_CFG_SIZE_TYPE _MAP_LOAD_LIMIT (MAP_CFG_SIZE_TYPE size)
 {
-    return (ha < hb) ?
-        -1:
-        (ha > hb) ?
+    double limit = (double) size * MAP_CFG_MAX_LOAD;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    /* at least one slot must always be empty */
+    if (limit > (double) (size - 1))
+        limit = (double) (size - 1);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    return (limit >= (double) _MAP_SIZE_MAX) ?
+        _MAP_SIZE_MAX:
+        (limit < 1) ?
         1:
-        MAP_CFG_KEY_CMP(ka, kb);
+        (MAP_CFG_SIZE_TYPE) limit;
 }
 
 /**
- * @brief Tries to increase the total capacity of an entry array to
- *        fit another entry
- * @param self The map
- * @param tblidx The index of the entry array
- * @returns `true` if it successfully increased the capacity or wasn't
- *          necessary, `false` otherwise
+ * @brief Mixes the bits of @a x (the finalizer of MurmurHash3), so
+ *        every bit of the result depends on every bit of @a x
+ * @param x The number
+ * @returns The mixed number
  */
-static bool _MAP_INCREASE_CAPACITY (struct MAP_CFG_MAP * self, unsigned tblidx)
+static inline uint64_t _MAP_MIX64 (uint64_t x)
 {
-    if (self->table[tblidx].length < self->table[tblidx].capacity)
-        return true;
-
-    unsigned cap = self->table[tblidx].capacity + 1;
-    void * entries = MAP_CFG_REALLOC(self->table[tblidx].entries,
-            sizeof(*self->table[tblidx].entries) * cap);
-    bool ret = entries != NULL;
-
-    if (ret) {
-        self->table[tblidx].entries = entries;
-        self->table[tblidx].capacity++;
-    }
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= UINT64_C(0xc4ceb9fe1a85ec53);
+    x ^= x >> 33;
+    return x;
+}
 
+# ifdef MAP_CFG_SEEDED_HASH
+/**
+ * @brief Picks the seed of a new map
+ * @param self The map
+ * @returns The seed
+ */
+static uint64_t _MAP_SEED (const struct MAP_CFG_MAP * self)
+{
+#  ifdef MAP_CFG_SEED_FUNC
+    (void) self;
+    return MAP_CFG_SEED_FUNC();
+#  else /* MAP_CFG_SEED_FUNC */
+    uint64_t ret = _MAP_MIX64((uint64_t) time(NULL));
+    ret = _MAP_MIX64(ret ^ (uint64_t) clock());
+    ret = _MAP_MIX64(ret ^ (uint64_t) (uintptr_t) self);
+    ret = _MAP_MIX64(ret ^ (uint64_t) (uintptr_t) &ret);
     return ret;
+#  endif /* MAP_CFG_SEED_FUNC */
 }
+# endif /* MAP_CFG_SEEDED_HASH */
 
+# ifdef _MAP_HASH_BUILTIN
 /**
- * @brief Searches for an entry with key @a key and hash @a hash in
- *        the entry array with index @a tblidx
- * @param self The map
+ * @brief Hashes @a key with the hash function of `hash.h` picked with
+ *        MAP_CFG_HASH_INT, ...
  * @param key The key
- * @param hash The hash of @a key
- * @param tblidx The index of the entry array
- * @param[out] _i The index of the entry in the entry array (!NULL)
- * @returns `true` if there was an entry with key @a key, and sets
- *          @a _i to the index of the entry in the entry array.
- *          `false` if there was no entry with key @a key, and sets
- *          @a _i to the index in the entry array where an entry
- *          with key @a key should be inserted
- *
- * This function assumes the entry arrays are sorted according to
- *     _MAP_ENTRY_CMP(). This means MAP_CFG_KEY_CMP() must be defined similarly
- *     strcmp(), the only difference being the arguments are not pointers to,
- *     but values of type MAP_CFG_KEY_DATA_TYPE. It may be defined either as a
- *     macro or a function, but must behave as if it was a function of the
- *     following type:
- *
- * int MAP_CFG_KEY_CMP (MAP_CFG_KEY_DATA_TYPE, MAP_CFG_KEY_DATA_TYPE)
+ * @param seed The seed
+ * @returns The hash (maybe truncated to MAP_CFG_HASH_TYPE)
  */
-static bool _MAP_SEARCH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, unsigned hash, unsigned tblidx, unsigned * _i)
+static inline MAP_CFG_HASH_TYPE _MAP_HASH_KEY (const MAP_CFG_KEY_DATA_TYPE key, uint64_t seed)
 {
-    bool ret = false;
-    unsigned i = 0;
-    unsigned size = self->table[tblidx].length;
-    unsigned base = 0;
-
-    if (size == 0)
-        goto out;
+#  if defined(MAP_CFG_HASH_INT)
+    uint64_t ret = (sizeof(key) <= sizeof(uint32_t)) ?
+        hash_u32((uint32_t) key, seed):
+        hash_u64((uint64_t) key, seed);
+#  elif defined(MAP_CFG_HASH_PTR)
+    uint64_t ret = hash_ptr(key, seed);
+#  elif defined(MAP_CFG_HASH_STR)
+    uint64_t ret = hash_str(key, seed);
+#  else /* MAP_CFG_HASH_INT */
+    uint64_t ret = hash_bytes(&key, sizeof(key), seed);
+#  endif /* MAP_CFG_HASH_INT */
+    return (MAP_CFG_HASH_TYPE) ret;
+}
+# endif /* _MAP_HASH_BUILTIN */
 
-    if (self->lc.valid
-            && self->lc.hash == hash
-            && MAP_CFG_KEY_CMP(key, self->table[tblidx].entries[self->lc.idx].key) == 0)
-    {
-        i = self->lc.idx;
-        ret = true;
-        goto out;
-    }
+# ifdef MAP_CFG_OPEN_ADDRESSING
 
-    while (size > 1) {
-        unsigned half = size >> 1;
-        unsigned mid = base + half;
+/*
+ * <emmintrin.h> / <immintrin.h>
+ *  _mm*_cmpeq_epi8()
+ *  _mm*_loadu_si*()
+ *  _mm*_movemask_epi8()
+ *  _mm*_set1_epi8()
+ *
+ * Define MAP_CFG_NO_SIMD to always use the scalar version
+ */
+#  if !defined(MAP_CFG_NO_SIMD) && defined(__AVX2__)
+#   include <immintrin.h>
+#   define _MAP_GROUP_WIDTH 32
+#  elif !defined(MAP_CFG_NO_SIMD) && defined(__SSE2__)
+#   include <emmintrin.h>
+#   define _MAP_GROUP_WIDTH 16
+#  else
+#   define _MAP_GROUP_WIDTH 16
+#  endif
 
-        int cmp = _MAP_ENTRY_CMP(hash, key,
-                self->table[tblidx].entries[mid].hash,
-                self->table[tblidx].entries[mid].key);
+/*
+ * Control bytes: a full slot has the 7 bits of its hash given by
+ * _MAP_H2(); empty and deleted slots have the high bit set
+ */
+#  define _MAP_CTRL_EMPTY   0x80
+#  define _MAP_CTRL_DELETED 0xFE
+#  define _MAP_CTRL_FULL(c) (((c) & 0x80) == 0)
 
-        base = (cmp > 0) ?
-            base :
-            mid;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
 
-        size -= half;
-    }
+# if defined(MAP_CFG_OPEN_ADDRESSING) || defined(MAP_CFG_POW2)
 
-    int cmp = _MAP_ENTRY_CMP(hash, key,
-            self->table[tblidx].entries[base].hash,
-            self->table[tblidx].entries[base].key);
+/**
+ * @brief Counts the trailing zeros of a (non-zero) bit mask
+ */
+static inline unsigned _MAP_CTZ (unsigned long long mask)
+{
+    assert(mask != 0);
+#  if defined(__GNUC__)
+    return (unsigned) __builtin_ctzll(mask);
+#  else
+    unsigned ret = 0;
+    for (; (mask & 1) == 0; mask >>= 1)
+        ret++;
+    return ret;
+#  endif
+}
 
-    ret = cmp == 0;
+/**
+ * @brief Rounds @a size up to a power of two (at least one group with
+ *        open addressing, or 4)
+ * @param size The requested size
+ * @returns The smallest power of two not less than @a size, or 0 if
+ *          it isn't representable
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_POW2 (MAP_CFG_SIZE_TYPE size)
+{
+#  ifdef MAP_CFG_OPEN_ADDRESSING
+    MAP_CFG_SIZE_TYPE ret = _MAP_GROUP_WIDTH;
+#  else /* MAP_CFG_OPEN_ADDRESSING */
+    MAP_CFG_SIZE_TYPE ret = 4;
+#  endif /* MAP_CFG_OPEN_ADDRESSING */
+    while (ret != 0 && ret < size)
+        ret <<= 1;
+    return ret;
+}
 
-    i = base + (!ret && cmp < 0);
+/**
+ * @brief Maps @a hash to an index of a power of two table with
+ *        Fibonacci hashing: the top log2(@a size) bits of the hash
+ *        multiplied by 2^bits / phi. Every bit of the hash changes the
+ *        index, so hashes that only differ in their high bits (e.g.,
+ *        strided integers with an identity hash) don't pile up
+ * @param hash The hash
+ * @param size The table size (a power of two, at least 2)
+ * @returns An index in range [ 0, @a size [
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_FIB (MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE size)
+{
+    unsigned bits = (unsigned) sizeof(hash) * CHAR_BIT;
+    MAP_CFG_HASH_TYPE fib = (bits > 32) ?
+        (MAP_CFG_HASH_TYPE) 11400714819323198485ull:
+        (MAP_CFG_HASH_TYPE) 2654435769ul;
+    return (MAP_CFG_SIZE_TYPE) ((MAP_CFG_HASH_TYPE) (hash * fib) >> (bits - _MAP_CTZ(size)));
+}
 
-    if (ret) {
-        self->lc.valid = true;
-        self->lc.hash = hash;
-        self->lc.idx = i;
+# endif /* MAP_CFG_OPEN_ADDRESSING || MAP_CFG_POW2 */
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+
+/**
+ * @brief Calculates the 7 bits of @a hash to keep in a control byte.
+ *        Every bit of the hash is folded in, so both the low bits
+ *        (used for the slot index) and the high bits contribute
+ */
+static inline unsigned char _MAP_H2 (MAP_CFG_HASH_TYPE hash)
+{
+    /* (two shifts so it's still valid for 32-bit hashes) */
+    if (sizeof(hash) > 4)
+        hash ^= hash >> 16 >> 16;
+    hash ^= hash >> 16;
+    hash ^= hash >> 8;
+    return (unsigned char) ((hash ^ (hash >> 7)) & 0x7F);
+}
+
+/**
+ * @brief Compares every control byte of a group with @a byte
+ * @param ctrl The first control byte of the group
+ * @param byte The control byte to look for
+ * @returns A mask with bit `i` set iff `ctrl[i] == byte`
+ */
+static inline unsigned _MAP_GROUP_MATCH (const unsigned char * ctrl, unsigned char byte)
+{
+#  if !defined(MAP_CFG_NO_SIMD) && defined(__AVX2__)
+    __m256i group = _mm256_loadu_si256((const __m256i *) ctrl);
+    return (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8((char) byte)));
+#  elif !defined(MAP_CFG_NO_SIMD) && defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) byte)));
+#  else
+    unsigned ret = 0;
+    for (unsigned i = 0; i < _MAP_GROUP_WIDTH; i++)
+        ret |= (unsigned) (ctrl[i] == byte) << i;
+    return ret;
+#  endif
+}
+
+/**
+ * @brief Finds the empty and deleted slots of a group
+ * @param ctrl The first control byte of the group
+ * @returns A mask with bit `i` set iff slot `i` of the group is
+ *          either empty or deleted
+ */
+static inline unsigned _MAP_GROUP_FREE (const unsigned char * ctrl)
+{
+#  if !defined(MAP_CFG_NO_SIMD) && defined(__AVX2__)
+    return (unsigned) _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *) ctrl));
+#  elif !defined(MAP_CFG_NO_SIMD) && defined(__SSE2__)
+    return (unsigned) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+#  else
+    unsigned ret = 0;
+    for (unsigned i = 0; i < _MAP_GROUP_WIDTH; i++)
+        ret |= (unsigned) (ctrl[i] >> 7) << i;
+    return ret;
+#  endif
+}
+
+#  ifdef MAP_CFG_ROBIN_HOOD
+
+/**
+ * @brief Calculates how far the entry of (full) slot @a i is from its
+ *        home slot (given by _MAP_FIB())
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_OA_DIST (const struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE i)
+{
+    return (i - _MAP_FIB(self->slots[i].hash, self->size)) & (self->size - 1);
+}
+
+/**
+ * @brief Searches for an entry with key @a key and hash @a hash
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key
+ * @param[out] _i The index of the slot (!NULL)
+ * @returns `true` if there was an entry with key @a key, and sets
+ *          @a _i to the index of its slot.
+ *          `false` if there was no entry with key @a key, and sets
+ *          @a _i to the index of the slot where an entry with key
+ *          @a key should be inserted (see _MAP_OA_MAKE_ROOM())
+ *
+ * The probe sequence starts at slot `_MAP_FIB(hash, size)` (the home
+ *     slot) and goes one slot at a time, until an empty slot, or an
+ *     entry closer to its home slot than @a key would be there. Since
+ *     the runs of full slots are sorted by home slot, @a key can't be
+ *     past that point
+ */
+static bool _MAP_OA_SEARCH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE * _i)
+{
+    MAP_CFG_SIZE_TYPE mask = self->size - 1;
+    MAP_CFG_SIZE_TYPE i = _MAP_FIB(hash, self->size);
+
+    for (MAP_CFG_SIZE_TYPE dist = 0;
+            _MAP_CTRL_FULL(self->ctrl[i]) && _MAP_OA_DIST(self, i) >= dist;
+            dist++, i = (i + 1) & mask)
+    {
+        if (self->slots[i].hash == hash
+                && MAP_CFG_KEY_CMP(key, self->slots[i].key) == 0) {
+            *_i = i;
+            return true;
+        }
     }
 
-out:
     *_i = i;
+    return false;
+}
+
+/**
+ * @brief Frees slot @a i for a new entry, moving the rest of its run
+ *        one slot forward
+ * @param self The map (with at least one empty slot)
+ * @param i The slot, as given by _MAP_OA_SEARCH()
+ */
+static void _MAP_OA_MAKE_ROOM (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE i)
+{
+    MAP_CFG_SIZE_TYPE mask = self->size - 1;
+    MAP_CFG_SIZE_TYPE j = i;
+
+    while (_MAP_CTRL_FULL(self->ctrl[j]))
+        j = (j + 1) & mask;
+
+    for (; j != i; j = (j - 1) & mask) {
+        self->ctrl[j] = self->ctrl[(j - 1) & mask];
+        self->slots[j] = self->slots[(j - 1) & mask];
+    }
+}
+
+#  else /* MAP_CFG_ROBIN_HOOD */
+
+/**
+ * @brief Searches for an entry with key @a key and hash @a hash
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key
+ * @param[out] _i The index of the slot (!NULL)
+ * @returns `true` if there was an entry with key @a key, and sets
+ *          @a _i to the index of its slot.
+ *          `false` if there was no entry with key @a key, and sets
+ *          @a _i to the index of the slot where an entry with key
+ *          @a key should be inserted (the first empty or deleted slot
+ *          of the probe sequence)
+ *
+ * The slots are split in groups of _MAP_GROUP_WIDTH. The probe sequence
+ *     starts at the group of slot `_MAP_FIB(hash, size)` and goes through
+ *     the groups in triangular steps (+1, +2, +3, ...), which visits
+ *     every group of a power of two table, until a group with an empty
+ *     slot is found. The growth policy (see _MAP_OA_GROW()) makes sure
+ *     there is always at least one empty slot.
+ *     MAP_CFG_KEY_CMP() is only called for slots whose control byte
+ *     and hash match
+ */
+static bool _MAP_OA_SEARCH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE * _i)
+{
+    MAP_CFG_SIZE_TYPE size = self->size;
+    MAP_CFG_SIZE_TYPE ngroups = size / _MAP_GROUP_WIDTH;
+    MAP_CFG_SIZE_TYPE group = _MAP_FIB(hash, size) / _MAP_GROUP_WIDTH;
+    unsigned char h2 = _MAP_H2(hash);
+    MAP_CFG_SIZE_TYPE free_slot = size;
+
+    for (MAP_CFG_SIZE_TYPE step = 1; step <= ngroups; step++) {
+        MAP_CFG_SIZE_TYPE base = group * _MAP_GROUP_WIDTH;
+        const unsigned char * ctrl = self->ctrl + base;
+
+        for (unsigned match = _MAP_GROUP_MATCH(ctrl, h2); match != 0; match &= match - 1) {
+            MAP_CFG_SIZE_TYPE i = base + _MAP_CTZ(match);
+            if (self->slots[i].hash == hash
+                    && MAP_CFG_KEY_CMP(key, self->slots[i].key) == 0) {
+                *_i = i;
+                return true;
+            }
+        }
+
+        unsigned free_mask = _MAP_GROUP_FREE(ctrl);
+        if (free_slot == size && free_mask != 0)
+            free_slot = base + _MAP_CTZ(free_mask);
+
+        if (_MAP_GROUP_MATCH(ctrl, _MAP_CTRL_EMPTY) != 0)
+            break;
+
+        group = (group + step) & (ngroups - 1);
+    }
+
+    *_i = free_slot;
+    return false;
+}
+
+#  endif /* MAP_CFG_ROBIN_HOOD */
+
+/**
+ * @brief Allocates the slots and control bytes of a map with
+ *        @a size slots, all of them empty
+ * @param self The map
+ * @param size The number of slots (a power of two)
+ * @returns `true` if it successfully allocated the slot array
+ *
+ * The control bytes come right after the slots, in the same allocation
+ */
+static bool _MAP_OA_ALLOC (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE size)
+{
+    size_t nbytes = (size_t) size * (sizeof(*self->slots) + 1);
+    void * slots = MAP_CFG_MALLOC(nbytes);
+    if (slots == NULL)
+        return false;
+
+    self->slots = slots;
+    self->ctrl = (unsigned char *) (self->slots + size);
+    self->size = size;
+    self->deleted = 0;
+    memset(self->ctrl, _MAP_CTRL_EMPTY, size);
+
+    return true;
+}
+
+/**
+ * @brief Moves every entry into a new slot array of size @a new_size
+ * @param self The map
+ * @param new_size The new number of slots (a power of two, bigger
+ *        than the number of entries)
+ * @returns `true` if it successfully rehashed the map, `false`
+ *          otherwise, in which case the map is left untouched
+ *
+ * Deleted slots are dropped along the way, so this is also used to
+ *     clean up a map with too many tombstones
+ */
+static bool _MAP_OA_REHASH (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE new_size)
+{
+    assert(new_size > self->cardinal);
+
+    struct MAP_CFG_MAP ret = *self;
+    if (!_MAP_OA_ALLOC(&ret, new_size))
+        return false;
+
+#  ifdef MAP_CFG_ROBIN_HOOD
+    for (MAP_CFG_SIZE_TYPE i = 0; i < self->size; i++) {
+        if (!_MAP_CTRL_FULL(self->ctrl[i]))
+            continue;
+
+        /* the keys are all different, the search only finds the slot */
+        MAP_CFG_SIZE_TYPE j = 0;
+        _MAP_OA_SEARCH(&ret, self->slots[i].key, self->slots[i].hash, &j);
+        _MAP_OA_MAKE_ROOM(&ret, j);
+        ret.ctrl[j] = self->ctrl[i];
+        ret.slots[j] = self->slots[i];
+    }
+#  else /* MAP_CFG_ROBIN_HOOD */
+    MAP_CFG_SIZE_TYPE ngroups = new_size / _MAP_GROUP_WIDTH;
+    for (MAP_CFG_SIZE_TYPE i = 0; i < self->size; i++) {
+        if (!_MAP_CTRL_FULL(self->ctrl[i]))
+            continue;
+
+        MAP_CFG_HASH_TYPE hash = self->slots[i].hash;
+        MAP_CFG_SIZE_TYPE group = _MAP_FIB(hash, new_size) / _MAP_GROUP_WIDTH;
+        unsigned free_mask = 0;
+
+        for (MAP_CFG_SIZE_TYPE step = 1; (free_mask = _MAP_GROUP_FREE(ret.ctrl + group * _MAP_GROUP_WIDTH)) == 0; step++)
+            group = (group + step) & (ngroups - 1);
+
+        MAP_CFG_SIZE_TYPE j = group * _MAP_GROUP_WIDTH + _MAP_CTZ(free_mask);
+        ret.ctrl[j] = self->ctrl[i];
+        ret.slots[j] = self->slots[i];
+    }
+#  endif /* MAP_CFG_ROBIN_HOOD */
+
+    if (self->slots != NULL)
+        MAP_CFG_FREE(self->slots);
+
+    return (*self = ret), true;
+}
+
+/**
+ * @brief Makes sure there is room for another entry, growing the slot
+ *        array if necessary
+ * @param self The map
+ * @returns `true` if there is room for another entry, `false` if it
+ *          was necessary to grow but it wasn't possible
+ *
+ * The number of slots in use (full or deleted) may not go over the
+ *     limit given by MAP_CFG_MAX_LOAD. If most of the used slots are
+ *     tombstones, the map is rehashed with the same size, otherwise
+ *     the size is doubled
+ */
+static bool _MAP_OA_GROW (struct MAP_CFG_MAP * self)
+{
+    MAP_CFG_SIZE_TYPE used = self->cardinal + self->deleted + 1;
+    MAP_CFG_SIZE_TYPE limit = _MAP_LOAD_LIMIT(self->size);
+    if (used <= limit)
+        return true;
+
+    MAP_CFG_SIZE_TYPE new_size = ((self->cardinal + 1) <= (limit >> 1)) ?
+        self->size:
+        self->size << 1;
+
+    return new_size != 0
+        && _MAP_OA_REHASH(self, new_size);
+}
+
+# else /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief Calculates the index of the entry array for @a hash (see
+ *        MAP_CFG_POW2)
+ * @param hash The hash
+ * @param size The table size
+ * @returns An index in range [ 0, @a size [
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_INDEX (MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE size)
+{
+#  if defined(MAP_CFG_POW2_MASK)
+    return (MAP_CFG_SIZE_TYPE) (hash & (size - 1));
+#  elif defined(MAP_CFG_POW2)
+    return _MAP_FIB(hash, size);
+#  else
+    return (MAP_CFG_SIZE_TYPE) MAP_MOD(hash, size);
+#  endif
+}
+
+#  ifdef MAP_CFG_ARENA
+
+#   ifndef MAP_CFG_ARENA_CHUNK
+/*
+ * Size of the chunks of the arena of a map, in bytes. Entry arrays
+ * bigger than a quarter of it get a chunk of their own
+ */
+#    define MAP_CFG_ARENA_CHUNK 65536
+#   endif /* MAP_CFG_ARENA_CHUNK */
+
+/*
+ * Where the entry arrays of a chunk start: after the pointer to the next
+ * chunk, aligned for entries
+ */
+#   define _MAP_ARENA_HEADER \
+    ((sizeof(void *) + _Alignof(struct _MAP_ENTRY) - 1) / _Alignof(struct _MAP_ENTRY) * _Alignof(struct _MAP_ENTRY))
+
+/**
+ * @brief Calculates the size class of an entry array
+ * @param cap The number of entries it needs room for
+ * @returns The smallest c such that 2^c entries are at least @a cap,
+ *          and take at least the memory of a pointer (for the free
+ *          lists)
+ */
+static inline unsigned _MAP_ARENA_CLASS (MAP_CFG_SIZE_TYPE cap)
+{
+    unsigned c = 0;
+
+    while (((MAP_CFG_SIZE_TYPE) 1 << c) < cap
+            || ((size_t) 1 << c) * sizeof(struct _MAP_ENTRY) < sizeof(void *))
+        c++;
+
+    return c;
+}
+
+/**
+ * @brief Allocates a chunk, and adds it to the arena
+ * @param arena The arena
+ * @param size The number of bytes for entry arrays
+ * @returns Where the entry arrays go, or NULL if it wasn't possible to
+ *          allocate the chunk
+ */
+static unsigned char * _MAP_ARENA_CHUNK (struct _MAP_ARENA * arena, size_t size)
+{
+    unsigned char * chunk = MAP_CFG_MALLOC(_MAP_ARENA_HEADER + size);
+
+    if (chunk == NULL)
+        return NULL;
+
+    memcpy(chunk, &arena->chunks, sizeof(arena->chunks));
+    arena->chunks = chunk;
+
+    return chunk + _MAP_ARENA_HEADER;
+}
+
+/**
+ * @brief Puts an entry array that isn't used anymore in the free list
+ *        of the biggest size class that fits in it
+ * @param arena The arena
+ * @param entries The entry array (may be NULL)
+ * @param cap Its capacity
+ * @returns How many of its entries the free list got (2^c), or 0 if
+ *          it's too small for any free list
+ */
+static MAP_CFG_SIZE_TYPE _MAP_ARENA_FREE (struct _MAP_ARENA * arena, void * entries, MAP_CFG_SIZE_TYPE cap)
+{
+    unsigned nclasses = (unsigned) (sizeof(arena->free) / sizeof(*arena->free));
+    unsigned c = 0;
+
+    if (entries == NULL || cap == 0)
+        return 0;
+
+    while (c + 1 < nclasses && ((MAP_CFG_SIZE_TYPE) 1 << (c + 1)) <= cap)
+        c++;
+
+    if (((size_t) 1 << c) * sizeof(struct _MAP_ENTRY) < sizeof(void *))
+        return 0;
+
+    memcpy(entries, &arena->free[c], sizeof(arena->free[c]));
+    arena->free[c] = entries;
+
+    return (MAP_CFG_SIZE_TYPE) 1 << c;
+}
+
+/**
+ * @brief Gets an entry array from the arena: from the free list of its
+ *        size class, or else from the newest chunk
+ * @param arena The arena
+ * @param c The size class (see _MAP_ARENA_CLASS())
+ * @returns An entry array with room for 2^@a c entries, or NULL if it
+ *          wasn't possible to allocate a chunk for it
+ */
+static struct _MAP_ENTRY * _MAP_ARENA_ALLOC (struct _MAP_ARENA * arena, unsigned c)
+{
+    void * ret = arena->free[c];
+
+    if (ret != NULL) {
+        memcpy(&arena->free[c], ret, sizeof(arena->free[c]));
+        return ret;
+    }
+
+    size_t size = ((size_t) 1 << c) * sizeof(struct _MAP_ENTRY);
+
+    /* big entry arrays get a chunk of their own */
+    if (size > MAP_CFG_ARENA_CHUNK / 4)
+        return (void *) _MAP_ARENA_CHUNK(arena, size);
+
+    if (size > arena->left) {
+        /* the rest of the newest chunk goes to the free lists */
+        MAP_CFG_SIZE_TYPE n = 0;
+        while ((n = _MAP_ARENA_FREE(arena, arena->next, (MAP_CFG_SIZE_TYPE) (arena->left / sizeof(struct _MAP_ENTRY)))) > 0) {
+            arena->next += n * sizeof(struct _MAP_ENTRY);
+            arena->left -= n * sizeof(struct _MAP_ENTRY);
+        }
+
+        arena->next = _MAP_ARENA_CHUNK(arena, MAP_CFG_ARENA_CHUNK);
+        arena->left = (arena->next != NULL) ?
+            MAP_CFG_ARENA_CHUNK:
+            0;
+        if (arena->next == NULL)
+            return NULL;
+    }
+
+    ret = arena->next;
+    arena->next += size;
+    arena->left -= size;
+
+    return ret;
+}
+
+/**
+ * @brief Frees every chunk of the arena, and with them every entry array
+ * @param arena The arena
+ */
+static void _MAP_ARENA_RELEASE (struct _MAP_ARENA * arena)
+{
+    while (arena->chunks != NULL) {
+        void * next = NULL;
+        memcpy(&next, arena->chunks, sizeof(next));
+        MAP_CFG_FREE(arena->chunks);
+        arena->chunks = next;
+    }
+
+    *arena = (struct _MAP_ARENA) {0};
+}
+
+#  endif /* MAP_CFG_ARENA */
+
+/**
+ * @brief Tries to change the capacity of an entry array to @a cap
+ * @param self The map
+ * @param bucket The entry array
+ * @param cap The new capacity (must not be smaller than its length).
+ *        With MAP_CFG_ARENA, it is rounded up to a power of two
+ * @returns `true` if the operation was successful, `false` otherwise
+ */
+static bool _MAP_CHANGE_CAPACITY (struct MAP_CFG_MAP * self, struct _MAP_BUCKET * bucket, MAP_CFG_SIZE_TYPE cap)
+{
+#  ifdef MAP_CFG_ARENA
+    if (cap == 0) {
+        _MAP_ARENA_FREE(&self->arena, bucket->entries, bucket->capacity);
+        bucket->entries = NULL;
+        bucket->capacity = 0;
+        return true;
+    }
+
+    unsigned c = _MAP_ARENA_CLASS(cap);
+    if (((MAP_CFG_SIZE_TYPE) 1 << c) == bucket->capacity)
+        return true;
+
+    struct _MAP_ENTRY * entries = _MAP_ARENA_ALLOC(&self->arena, c);
+    if (entries == NULL)
+        return false;
+
+    if (bucket->length > 0)
+        memcpy(entries, bucket->entries, sizeof(*entries) * bucket->length);
+    _MAP_ARENA_FREE(&self->arena, bucket->entries, bucket->capacity);
+
+    bucket->entries = entries;
+    bucket->capacity = (MAP_CFG_SIZE_TYPE) 1 << c;
+
+    return true;
+#  else /* MAP_CFG_ARENA */
+    (void) self;
+
+    if (cap == 0) { /* avoid double free */
+        MAP_CFG_FREE(bucket->entries);
+        bucket->entries = NULL;
+        bucket->capacity = 0;
+        return true;
+    }
+
+    void * entries = MAP_CFG_REALLOC(bucket->entries,
+            sizeof(*bucket->entries) * cap);
+    bool ret = entries != NULL;
+
+    if (ret) {
+        bucket->entries = entries;
+        bucket->capacity = cap;
+    }
+
     return ret;
+#  endif /* MAP_CFG_ARENA */
+}
+
+/**
+ * @brief Checks if an entry array has too much unused memory (see
+ *        MAP_CFG_BUCKET_SHRINK()) and tries to decrease it
+ * @param self The map
+ * @param tblidx The index of the entry array
+ * @returns `false` if the array has too much unused memory but it
+ *          couldn't decrease it, `true` otherwise
+ */
+static bool _MAP_DECREASE_CAPACITY (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE tblidx)
+{
+    struct _MAP_BUCKET * bucket = self->table + tblidx;
+    MAP_CFG_SIZE_TYPE len = bucket->length;
+
+    return bucket->capacity <= 1
+        || !MAP_CFG_BUCKET_SHRINK(len, bucket->capacity)
+        || _MAP_CHANGE_CAPACITY(self, bucket, (len == 0) ? 0 : MAP_CFG_BUCKET_GROW(len));
+}
+
+/**
+ * @brief Compares two entries based on hash and key
+ * @param ha Hash of the first entry
+ * @param ka Key of the first entry
+ * @param hb Hash of the second entry
+ * @param kb Key of the second entry
+ * @returns <0 if (ha, ka) < (hb, kb), or
+ *          >0 if (ha, ka) > (hb, kb), or
+ *           0 if (ha, ka) == (hb, kb).
+ *           The keys are compared with MAP_CFG_KEY_CMP()
+ *
+ * entryCmp (ha, ka) (hb, kb)
+ *     | ha < hb   = LT
+ *     | ha > hb   = GT
+ *     | otherwise = keyCmp ka kb
+ *
+ * This function establishes a strict total order on entries iff
+ * MAP_CFG_KEY_CMP() establishes a strict total order on keys
+ */
+static inline int _MAP_ENTRY_CMP (MAP_CFG_HASH_TYPE ha, const MAP_CFG_KEY_DATA_TYPE ka, MAP_CFG_HASH_TYPE hb, const MAP_CFG_KEY_DATA_TYPE kb)
+{
+    return (ha < hb) ?
+        -1:
+        (ha > hb) ?
+        1:
+        MAP_CFG_KEY_CMP(ka, kb);
+}
+
+/**
+ * @brief Doubles the size of the table
+ * @param self The map
+ * @returns `true` if it successfully resized the map
+ */
+static bool _MAP_GROW (struct MAP_CFG_MAP * self)
+{
+#  ifdef MAP_CFG_POW2
+    return self->size <= _MAP_SIZE_MAX / 2
+        && MAP_RESIZE(self, self->size << 1);
+#  else /* MAP_CFG_POW2 */
+    return self->size <= (_MAP_SIZE_MAX - 1) / 2
+        && MAP_RESIZE(self, self->size * 2 + 1);
+#  endif /* MAP_CFG_POW2 */
+}
+
+/**
+ * @brief Tries to increase the total capacity of an entry array to
+ *        fit another entry (see MAP_CFG_BUCKET_GROW())
+ * @param self The map
+ * @param tblidx The index of the entry array
+ * @returns `true` if it successfully increased the capacity or wasn't
+ *          necessary, `false` otherwise
+ */
+static bool _MAP_INCREASE_CAPACITY (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE tblidx)
+{
+    struct _MAP_BUCKET * bucket = self->table + tblidx;
+
+    return bucket->length < bucket->capacity
+        || _MAP_CHANGE_CAPACITY(self, bucket, MAP_CFG_BUCKET_GROW(bucket->capacity));
 }
 
-/**
- * @brief Inserts or updates an entry
- * @param self The map
- * @param key The key
- * @param value The value
- * @param hash The hash of @a key
- * @param tblidx The index of the entry array where the entry should
- *        be put
- * @returns `false` if there was no entry with key @a key and it wasn't
- *          possible to insert it, `true` otherwise
- */
-static bool _MAP_INSERT_SORTED (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value, unsigned hash, unsigned tblidx)
-{
-    unsigned i = 0;
-    bool exists = _MAP_SEARCH(self, key, hash, tblidx, &i);
+/**
+ * @brief Searches for an entry with key @a key and hash @a hash in
+ *        the entry array @a bucket
+ * @param bucket The entry array
+ * @param key The key
+ * @param hash The hash of @a key
+ * @param[out] _i The index of the entry in the entry array (!NULL)
+ * @returns `true` if there was an entry with key @a key, and sets
+ *          @a _i to the index of the entry in the entry array.
+ *          `false` if there was no entry with key @a key, and sets
+ *          @a _i to the index in the entry array where an entry
+ *          with key @a key should be inserted
+ *
+ * This function assumes the entry arrays are sorted according to
+ *     _MAP_ENTRY_CMP(). This means MAP_CFG_KEY_CMP() must be defined similarly
+ *     strcmp(), the only difference being the arguments are not pointers to,
+ *     but values of type MAP_CFG_KEY_DATA_TYPE. It may be defined either as a
+ *     macro or a function, but must behave as if it was a function of the
+ *     following type:
+ *
+ * int MAP_CFG_KEY_CMP (MAP_CFG_KEY_DATA_TYPE, MAP_CFG_KEY_DATA_TYPE)
+ */
+static bool _MAP_BUCKET_SEARCH (const struct _MAP_BUCKET * bucket, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE * _i)
+{
+    MAP_CFG_SIZE_TYPE size = bucket->length;
+    MAP_CFG_SIZE_TYPE base = 0;
+
+    if (size == 0)
+        return (*_i = 0), false;
+
+    while (size > 1) {
+        MAP_CFG_SIZE_TYPE half = size >> 1;
+        MAP_CFG_SIZE_TYPE mid = base + half;
+
+        int cmp = _MAP_ENTRY_CMP(hash, key,
+                bucket->entries[mid].hash,
+                bucket->entries[mid].key);
+
+        base = (cmp > 0) ?
+            base :
+            mid;
+
+        size -= half;
+    }
+
+    int cmp = _MAP_ENTRY_CMP(hash, key,
+            bucket->entries[base].hash,
+            bucket->entries[base].key);
+
+    bool ret = cmp == 0;
+
+    *_i = base + (!ret && cmp < 0);
+    return ret;
+}
+
+/**
+ * @brief Searches for an entry with key @a key and hash @a hash in
+ *        the entry array with index @a tblidx
+ * @param self The map
+ * @param lc A lookup cache (may be NULL)
+ * @param key The key
+ * @param hash The hash of @a key
+ * @param tblidx The index of the entry array
+ * @param[out] _i The index of the entry in the entry array (!NULL)
+ * @returns The same as _MAP_BUCKET_SEARCH()
+ *
+ * Checks @a lc first, and updates it if the entry is found. The index
+ *     in @a lc is checked against the entry array, since the map may
+ *     have changed since it was saved
+ */
+static bool _MAP_SEARCH (const struct MAP_CFG_MAP * self, struct MAP_LC * lc, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE tblidx, MAP_CFG_SIZE_TYPE * _i)
+{
+    const struct _MAP_BUCKET * bucket = self->table + tblidx;
+
+    if (lc != NULL
+            && lc->valid
+            && lc->hash == hash
+            && lc->idx < bucket->length
+            && bucket->entries[lc->idx].hash == hash
+            && MAP_CFG_KEY_CMP(key, bucket->entries[lc->idx].key) == 0)
+    {
+        *_i = lc->idx;
+        return true;
+    }
+
+    bool ret = _MAP_BUCKET_SEARCH(bucket, key, hash, _i);
+
+    if (ret && lc != NULL) {
+        lc->valid = true;
+        lc->hash = hash;
+        lc->idx = *_i;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Makes room for a new entry in an entry array. Only the hash
+ *        of the new entry is set
+ * @param self The map
+ * @param hash The hash of the new entry
+ * @param tblidx The index of the entry array
+ * @param i The index of the new entry in the entry array, as given by
+ *        _MAP_SEARCH()
+ * @returns `false` if it wasn't possible to get space for the new
+ *          entry, `true` otherwise
+ */
+static bool _MAP_INSERT_AT (struct MAP_CFG_MAP * self, MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE tblidx, MAP_CFG_SIZE_TYPE i)
+{
+    if (!_MAP_INCREASE_CAPACITY(self, tblidx))
+        return false;
+
+    /* move entries to the right */
+    MAP_CFG_SIZE_TYPE len = self->table[tblidx].length;
+    if (i < len)
+        memmove(&self->table[tblidx].entries[i + 1],
+                &self->table[tblidx].entries[i],
+                sizeof(*self->table[tblidx].entries) * (len - i));
+
+    self->table[tblidx].entries[i].hash = hash;
+    self->table[tblidx].length++;
+    self->cardinal++;
+
+    return true;
+}
+
+/**
+ * @brief Inserts or updates an entry
+ * @param self The map
+ * @param entry The entry (its hash, key and value)
+ * @param tblidx The index of the entry array where the entry should
+ *        be put
+ * @returns `false` if there was no entry with the key of @a entry and
+ *          it wasn't possible to insert it, `true` otherwise
+ */
+static bool _MAP_INSERT_SORTED (struct MAP_CFG_MAP * self, const struct _MAP_ENTRY * entry, MAP_CFG_SIZE_TYPE tblidx)
+{
+    MAP_CFG_SIZE_TYPE i = 0;
+    bool exists = _MAP_SEARCH(self, NULL, entry->key, entry->hash, tblidx, &i);
+
+    if (!exists && !_MAP_INSERT_AT(self, entry->hash, tblidx, i))
+        return false;
+
+    self->table[tblidx].entries[i] = *entry;
+
+    return true;
+}
+
+/**
+ * @brief Frees every entry array of a table, and the table itself. It
+ *        also frees keys and values if MAP_CFG_KEY_DTOR() and
+ *        MAP_CFG_VALUE_DTOR() are defined
+ * @param table The table
+ * @param size The size of @a table
+ */
+static void _MAP_FREE_TABLE (struct _MAP_BUCKET * table, MAP_CFG_SIZE_TYPE size)
+{
+#  if defined(MAP_CFG_ARENA) && !defined(MAP_CFG_VALUE_DTOR) && !defined(MAP_CFG_KEY_DTOR)
+    /* the entry arrays belong to the arena, there's nothing to do */
+    (void) size;
+#  else /* MAP_CFG_ARENA && !MAP_CFG_VALUE_DTOR && !MAP_CFG_KEY_DTOR */
+    for (MAP_CFG_SIZE_TYPE i = 0; i < size; i++) {
+        if (table[i].entries != NULL) {
+
+#   if defined(MAP_CFG_VALUE_DTOR) || defined(MAP_CFG_KEY_DTOR)
+            for (MAP_CFG_SIZE_TYPE j = 0; j < table[i].length; j++) {
+#    ifdef MAP_CFG_VALUE_DTOR
+                MAP_CFG_VALUE_DTOR(table[i].entries[j].value);
+#    endif /* MAP_CFG_VALUE_DTOR */
+
+#    ifdef MAP_CFG_KEY_DTOR
+                MAP_CFG_KEY_DTOR(table[i].entries[j].key);
+#    endif /* MAP_CFG_KEY_DTOR */
+            }
+#   endif /* MAP_CFG_VALUE_DTOR || MAP_CFG_KEY_DTOR */
+
+#   ifndef MAP_CFG_ARENA
+            MAP_CFG_FREE(table[i].entries);
+#   endif /* MAP_CFG_ARENA */
+        }
+    }
+#  endif /* MAP_CFG_ARENA && !MAP_CFG_VALUE_DTOR && !MAP_CFG_KEY_DTOR */
+
+    MAP_CFG_FREE(table);
+}
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+
+#   ifndef MAP_CFG_RESIZE_STEP
+/*
+ * How many (non-empty) entry arrays each operation moves from the old
+ * table to the new one, while resizing incrementally. Up to 10 times as
+ * many empty entry arrays may be skipped as well
+ */
+#    define MAP_CFG_RESIZE_STEP 4
+#   endif /* MAP_CFG_RESIZE_STEP */
+
+/**
+ * @brief Moves every entry of an entry array of the old table into the
+ *        new table
+ * @param self The map
+ * @param oldidx The index of the entry array in the old table
+ * @returns `true` if every entry was moved. Otherwise, the entries that
+ *          weren't moved are still in the old entry array
+ */
+static bool _MAP_MIGRATE_BUCKET (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE oldidx)
+{
+    struct _MAP_BUCKET * bucket = self->old_table + oldidx;
+
+    /* from the end, so the old entry array is still valid if it fails */
+    while (bucket->length > 0) {
+        struct _MAP_ENTRY * entry = bucket->entries + bucket->length - 1;
+        MAP_CFG_SIZE_TYPE tblidx = _MAP_INDEX(entry->hash, self->size);
+
+        if (!_MAP_INSERT_SORTED(self, entry, tblidx))
+            return false;
+
+        /* it was already counted */
+        self->cardinal--;
+        bucket->length--;
+    }
+
+    _MAP_CHANGE_CAPACITY(self, bucket, 0);
+
+    return true;
+}
+
+/**
+ * @brief Moves up to @a n non-empty entry arrays of the old table into
+ *        the new table, and frees the old table when it's empty
+ * @param self The map
+ * @param n Maximum number of non-empty entry arrays to move
+ * @returns `false` if it wasn't possible to move an entry array
+ */
+static bool _MAP_MIGRATE_STEP (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE n)
+{
+    MAP_CFG_SIZE_TYPE empty = (n > _MAP_SIZE_MAX / 10) ?
+        _MAP_SIZE_MAX:
+        n * 10;
+
+    while (self->migrated < self->old_size && n > 0) {
+        if (self->old_table[self->migrated].length > 0)
+            n--;
+        else if (empty-- == 0)
+            break;
+
+        if (!_MAP_MIGRATE_BUCKET(self, self->migrated))
+            return false;
+
+        self->migrated++;
+    }
+
+    if (self->old_table != NULL && self->migrated == self->old_size) {
+        MAP_CFG_FREE(self->old_table);
+        self->old_table = NULL;
+        self->old_size = 0;
+        self->migrated = 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Makes some progress resizing the map (if it is resizing), and
+ *        moves the entry array where an entry with hash @a hash would
+ *        be in the old table
+ * @param self The map
+ * @param hash The hash of the key about to be used
+ * @returns `true` if an entry with hash @a hash can only be in the new
+ *          table. `false` if it wasn't possible to move every entry of
+ *          its entry array in the old table, so it may be in either
+ */
+static bool _MAP_MIGRATE (struct MAP_CFG_MAP * self, MAP_CFG_HASH_TYPE hash)
+{
+    if (self->old_table == NULL)
+        return true;
+
+    _MAP_MIGRATE_STEP(self, MAP_CFG_RESIZE_STEP);
+
+    return self->old_table == NULL
+        || _MAP_MIGRATE_BUCKET(self, _MAP_INDEX(hash, self->old_size));
+}
+
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief Finds the entry with key @a key, without changing the map
+ * @param self The map (must be initialized)
+ * @param lc A lookup cache (may be NULL)
+ * @param key The key
+ * @param hash The hash of @a key
+ * @returns The entry, or NULL if there's no entry with key @a key
+ *
+ * With MAP_CFG_INCREMENTAL_RESIZE, the entry array of `old_table` is
+ *     searched first (entry arrays already moved are empty), and @a lc
+ *     is only used for `table`
+ */
+static const struct _MAP_ENTRY * _MAP_FIND (const struct MAP_CFG_MAP * self, struct MAP_LC * lc, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash)
+{
+    MAP_CFG_SIZE_TYPE i = 0;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (lc != NULL
+            && lc->valid
+            && lc->hash == hash
+            && lc->idx < self->size
+            && _MAP_CTRL_FULL(self->ctrl[lc->idx])
+            && self->slots[lc->idx].hash == hash
+            && MAP_CFG_KEY_CMP(key, self->slots[lc->idx].key) == 0)
+        return self->slots + lc->idx;
+
+    if (!_MAP_OA_SEARCH(self, key, hash, &i))
+        return NULL;
+
+    if (lc != NULL) {
+        lc->valid = true;
+        lc->hash = hash;
+        lc->idx = i;
+    }
+
+    return self->slots + i;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (self->old_table != NULL) {
+        const struct _MAP_BUCKET * old = self->old_table + _MAP_INDEX(hash, self->old_size);
+        if (_MAP_BUCKET_SEARCH(old, key, hash, &i))
+            return old->entries + i;
+    }
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+    MAP_CFG_SIZE_TYPE tblidx = _MAP_INDEX(hash, self->size);
+
+    return (_MAP_SEARCH(self, lc, key, hash, tblidx, &i)) ?
+        self->table[tblidx].entries + i:
+        NULL;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Calculates the table size needed to hold @a n entries
+ *        without going over MAP_CFG_MAX_LOAD
+ * @param n The number of entries
+ * @returns The table size, or 0 if it isn't representable
+ */
+static MAP_CFG_SIZE_TYPE _MAP_SIZE_FOR (MAP_CFG_SIZE_TYPE n)
+{
+    double max_load = MAP_CFG_MAX_LOAD;
+    double needed = (max_load > 0) ?
+        (double) n / max_load:
+        0;
+    if (needed >= (double) _MAP_SIZE_MAX)
+        return 0;
+
+    MAP_CFG_SIZE_TYPE size = (MAP_CFG_SIZE_TYPE) needed;
+    if ((double) size < needed)
+        size++;
+    if (size < 3)
+        size = 3;
+
+# if defined(MAP_CFG_OPEN_ADDRESSING) || defined(MAP_CFG_POW2)
+    size = _MAP_POW2(size);
+    while (size != 0 && _MAP_LOAD_LIMIT(size) < n)
+        size <<= 1;
+# endif /* MAP_CFG_OPEN_ADDRESSING || MAP_CFG_POW2 */
+
+    return size;
+}
+
+/**
+ * @brief Looks up @a n keys, a batch of MAP_CFG_BATCH at a time. Every
+ *        key of a batch is hashed and the memory it will need is
+ *        prefetched before any of them is looked up, so the cache
+ *        misses of a batch overlap instead of happening one by one
+ * @param self The map
+ * @param keys The keys
+ * @param n The number of keys
+ * @param[out] out_values Where to put the value of each key that is
+ *             found (may be NULL, not with MAP_CFG_NO_VALUE)
+ * @param[out] out_found Whether each key was found (may be NULL)
+ * @returns The number of keys found
+ */
+# ifdef MAP_CFG_NO_VALUE
+static MAP_CFG_SIZE_TYPE _MAP_LOOKUP_MANY (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, bool * out_found)
+# else /* MAP_CFG_NO_VALUE */
+static MAP_CFG_SIZE_TYPE _MAP_LOOKUP_MANY (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, MAP_CFG_VALUE_DATA_TYPE * out_values, bool * out_found)
+# endif /* MAP_CFG_NO_VALUE */
+{
+    MAP_CFG_SIZE_TYPE ret = 0;
+
+    if (keys == NULL)
+        return 0;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    bool valid = self != NULL && self->size >= 3 && self->slots != NULL;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    bool valid = self != NULL && self->size >= 3 && self->table != NULL;
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    /* the entries may be in either table, take the slow path */
+    if (valid && self->old_table != NULL) {
+        for (MAP_CFG_SIZE_TYPE i = 0; i < n; i++) {
+            const struct _MAP_ENTRY * entry = _MAP_FIND(self, NULL, keys[i], _MAP_HASH(self, keys[i]));
+            bool found = entry != NULL;
+
+#   ifndef MAP_CFG_NO_VALUE
+            if (found && out_values != NULL)
+                out_values[i] = entry->value;
+#   endif /* MAP_CFG_NO_VALUE */
+            if (out_found != NULL)
+                out_found[i] = found;
+            ret += found;
+        }
+
+        return ret;
+    }
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    if (!valid) {
+        if (out_found != NULL)
+            memset(out_found, 0, sizeof(*out_found) * n);
+        return 0;
+    }
+
+    for (MAP_CFG_SIZE_TYPE base = 0; base < n; base += MAP_CFG_BATCH) {
+        MAP_CFG_HASH_TYPE hashes[MAP_CFG_BATCH];
+        MAP_CFG_SIZE_TYPE idxs[MAP_CFG_BATCH];
+        const MAP_CFG_KEY_DATA_TYPE * batch = keys + base;
+        MAP_CFG_SIZE_TYPE len = (n - base < MAP_CFG_BATCH) ?
+            n - base:
+            MAP_CFG_BATCH;
+
+        for (MAP_CFG_SIZE_TYPE i = 0; i < len; i++) {
+            hashes[i] = _MAP_HASH(self, batch[i]);
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+#  ifdef MAP_CFG_ROBIN_HOOD
+            /* the home slot */
+            idxs[i] = _MAP_FIB(hashes[i], self->size);
+#  else /* MAP_CFG_ROBIN_HOOD */
+            /* the first group of the probe sequence */
+            idxs[i] = _MAP_FIB(hashes[i], self->size)
+                & ~(MAP_CFG_SIZE_TYPE) (_MAP_GROUP_WIDTH - 1);
+#  endif /* MAP_CFG_ROBIN_HOOD */
+            _MAP_PREFETCH(self->ctrl + idxs[i]);
+            _MAP_PREFETCH(self->slots + idxs[i]);
+# else /* MAP_CFG_OPEN_ADDRESSING */
+            idxs[i] = _MAP_INDEX(hashes[i], self->size);
+            _MAP_PREFETCH(self->table + idxs[i]);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+        }
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+        /* the entry arrays, now that (hopefully) their pointers are in cache */
+        for (MAP_CFG_SIZE_TYPE i = 0; i < len; i++)
+            _MAP_PREFETCH(self->table[idxs[i]].entries);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+        for (MAP_CFG_SIZE_TYPE i = 0; i < len; i++) {
+            MAP_CFG_SIZE_TYPE j = 0;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+            bool found = _MAP_OA_SEARCH(self, batch[i], hashes[i], &j);
+
+#  ifndef MAP_CFG_NO_VALUE
+            if (found && out_values != NULL)
+                out_values[base + i] = self->slots[j].value;
+#  endif /* MAP_CFG_NO_VALUE */
+# else /* MAP_CFG_OPEN_ADDRESSING */
+            const struct _MAP_BUCKET * bucket = self->table + idxs[i];
+            bool found = _MAP_BUCKET_SEARCH(bucket, batch[i], hashes[i], &j);
+
+#  ifndef MAP_CFG_NO_VALUE
+            if (found && out_values != NULL)
+                out_values[base + i] = bucket->entries[j].value;
+#  endif /* MAP_CFG_NO_VALUE */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+            if (out_found != NULL)
+                out_found[base + i] = found;
+            ret += found;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Finds the entry with key @a key, or inserts a new one (growing
+ *        the table if needed) with a zeroed value. Searches for @a key
+ *        once (twice only if the table grows)
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key
+ * @param[out] inserted Whether the entry was inserted (!NULL)
+ * @returns The entry, or NULL if the map isn't valid or it wasn't
+ *          possible to insert it
+ */
+static struct _MAP_ENTRY * _MAP_FIND_OR_INSERT (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, bool * inserted)
+{
+    struct _MAP_ENTRY * entry = NULL;
+    MAP_CFG_SIZE_TYPE i = 0;
+
+    *inserted = false;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
+        return NULL;
+
+    if (_MAP_OA_SEARCH(self, key, hash, &i))
+        return self->slots + i;
+
+    /* the slots move around if the table is rehashed */
+    const struct _MAP_ENTRY * slots = self->slots;
+    if (!_MAP_OA_GROW(self))
+        return NULL;
+    if (self->slots != slots)
+        _MAP_OA_SEARCH(self, key, hash, &i);
+    assert(i < self->size);
+
+#  ifdef MAP_CFG_ROBIN_HOOD
+    _MAP_OA_MAKE_ROOM(self, i);
+#  else /* MAP_CFG_ROBIN_HOOD */
+    if (self->ctrl[i] == _MAP_CTRL_DELETED)
+        self->deleted--;
+#  endif /* MAP_CFG_ROBIN_HOOD */
+
+    self->ctrl[i] = _MAP_H2(hash);
+    self->slots[i].hash = hash;
+    self->cardinal++;
+
+    entry = self->slots + i;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return NULL;
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (!_MAP_MIGRATE(self, hash))
+        return NULL;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+    MAP_CFG_SIZE_TYPE tblidx = _MAP_INDEX(hash, self->size);
+
+    if (_MAP_SEARCH(self, NULL, key, hash, tblidx, &i))
+        return self->table[tblidx].entries + i;
+
+    /*
+     * If a new entry would go over the maximum load, try to grow first.
+     * If that's not possible, the entry is added anyway
+     */
+    if (MAP_CFG_MAX_LOAD > 0
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+            && self->old_table == NULL
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+            && self->cardinal >= _MAP_LOAD_LIMIT(self->size)
+            && _MAP_GROW(self))
+    {
+        tblidx = _MAP_INDEX(hash, self->size);
+        _MAP_SEARCH(self, NULL, key, hash, tblidx, &i);
+    }
+
+    if (!_MAP_INSERT_AT(self, hash, tblidx, i))
+        return NULL;
+
+    entry = self->table[tblidx].entries + i;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    entry->key = key;
+# ifndef MAP_CFG_NO_VALUE
+    memset(&entry->value, 0, sizeof(entry->value));
+# endif /* MAP_CFG_NO_VALUE */
+    *inserted = true;
+
+    return entry;
+}
+
+/**
+ * @brief State shared by the threads of MAP_FROM_ARRAYS() and
+ *        MAP_RESIZE_PARALLEL()
+ */
+struct _MAP_BUILD {
+    /** The map being built */
+    struct MAP_CFG_MAP * self;
+
+    /** The keys and values given to MAP_FROM_ARRAYS() */
+    const MAP_CFG_KEY_DATA_TYPE * keys;
+# ifndef MAP_CFG_NO_VALUE
+    const MAP_CFG_VALUE_DATA_TYPE * values;
+# endif /* MAP_CFG_NO_VALUE */
+
+    /** The hash of every key */
+    MAP_CFG_HASH_TYPE * hashes;
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+    /**
+     * The table of the map being resized by MAP_RESIZE_PARALLEL(),
+     * whose entries are used instead of `keys`, `values` and `hashes`
+     */
+    const struct _MAP_BUCKET * old_table;
+
+    /** Size of `old_table` */
+    MAP_CFG_SIZE_TYPE old_size;
+
+    /** Indices of the keys, grouped by partition */
+    MAP_CFG_SIZE_TYPE * order;
+
+    /** Copies of the entries of `old_table`, grouped by partition */
+    struct _MAP_ENTRY * moved;
+
+    /**
+     * Number of keys of each thread in each partition (`nthreads` rows
+     * of `nparts`), then where each thread puts them in `order` (or
+     * `moved`)
+     */
+    MAP_CFG_SIZE_TYPE * counts;
+
+    /** Number of partitions */
+    MAP_CFG_SIZE_TYPE nparts;
+
+    /** Number of entry arrays in each partition (but maybe the last) */
+    MAP_CFG_SIZE_TYPE width;
+
+#  ifdef MAP_CFG_ARENA
+    /**
+     * Room for `n` entries, from the arena. Each partition gets the
+     * slice at the same offset as its keys in `order` (or `moved`)
+     */
+    struct _MAP_ENTRY * entries;
+#  endif /* MAP_CFG_ARENA */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    /** Number of keys */
+    MAP_CFG_SIZE_TYPE n;
+
+    /** Number of threads */
+    MAP_CFG_SIZE_TYPE nthreads;
+};
+
+/**
+ * @brief What each thread of MAP_FROM_ARRAYS() and
+ *        MAP_RESIZE_PARALLEL() works on
+ */
+struct _MAP_BUILD_JOB {
+    /** The shared state */
+    struct _MAP_BUILD * build;
+
+    /** Which thread (less than `build->nthreads`) */
+    MAP_CFG_SIZE_TYPE id;
+
+    /** Number of entries this thread added to the map */
+    MAP_CFG_SIZE_TYPE cardinal;
+
+    /** Whether this thread did all its work */
+    bool ok;
+
+# ifdef MAP_CFG_THREADS
+    /** Whether `thread` was started */
+    bool started;
+
+    /** The thread */
+    pthread_t thread;
+# endif /* MAP_CFG_THREADS */
+};
+
+/**
+ * @brief Gets the range of work of a thread. Every thread gets about
+ *        the same number of keys (or entry arrays), in order
+ * @param build The shared state
+ * @param n Number of keys (or entry arrays) to split
+ * @param id Which thread
+ * @param[out] lo Index of the first key
+ * @param[out] hi Index after the last key
+ */
+static void _MAP_BUILD_CHUNK (const struct _MAP_BUILD * build, MAP_CFG_SIZE_TYPE n, MAP_CFG_SIZE_TYPE id, MAP_CFG_SIZE_TYPE * lo, MAP_CFG_SIZE_TYPE * hi)
+{
+    MAP_CFG_SIZE_TYPE len = n / build->nthreads;
+    MAP_CFG_SIZE_TYPE extra = n % build->nthreads;
+
+    *lo = id * len + ((id < extra) ? id : extra);
+    *hi = *lo + len + (id < extra);
+}
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief Gets the partition of the entry array where an entry with
+ *        hash @a hash goes. Partitions are ranges of entry arrays, so
+ *        no two threads ever touch the same entry array
+ * @param build The shared state
+ * @param hash The hash
+ * @returns The partition
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_BUILD_PART (const struct _MAP_BUILD * build, MAP_CFG_HASH_TYPE hash)
+{
+    return _MAP_INDEX(hash, build->self->size) / build->width;
+}
+
+/**
+ * @brief Gets the entry at position @a pos of the partitions
+ * @param build The shared state
+ * @param pos The position (in `order` or `moved`)
+ * @returns The entry: a copy of the one in `moved` when resizing,
+ *          or else made of the key (and value) at `order[pos]`
+ */
+static inline struct _MAP_ENTRY _MAP_BUILD_AT (const struct _MAP_BUILD * build, MAP_CFG_SIZE_TYPE pos)
+{
+    if (build->moved != NULL)
+        return build->moved[pos];
+
+    MAP_CFG_SIZE_TYPE k = build->order[pos];
+    return (struct _MAP_ENTRY) {
+        .hash = build->hashes[k],
+        .key = build->keys[k],
+#  ifndef MAP_CFG_NO_VALUE
+        .value = build->values[k],
+#  endif /* MAP_CFG_NO_VALUE */
+    };
+}
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief First step of MAP_FROM_ARRAYS(): hashes the keys of a thread,
+ *        and counts how many go to each partition
+ * @param arg The thread's job
+ * @returns NULL
+ */
+static void * _MAP_BUILD_HASH (void * arg)
+{
+    struct _MAP_BUILD_JOB * job = arg;
+    struct _MAP_BUILD * build = job->build;
+    MAP_CFG_SIZE_TYPE lo = 0;
+    MAP_CFG_SIZE_TYPE hi = 0;
+
+    _MAP_BUILD_CHUNK(build, build->n, job->id, &lo, &hi);
+
+    for (MAP_CFG_SIZE_TYPE i = lo; i < hi; i++) {
+        MAP_CFG_HASH_TYPE hash = _MAP_HASH(build->self, build->keys[i]);
+        build->hashes[i] = hash;
+# ifndef MAP_CFG_OPEN_ADDRESSING
+        build->counts[job->id * build->nparts + _MAP_BUILD_PART(build, hash)]++;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+    }
+
+    return NULL;
+}
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief First step of MAP_RESIZE_PARALLEL(): counts how many
+ *        entries of the entry arrays of a thread go to each partition.
+ *        The entries already have their hashes
+ * @param arg The thread's job
+ * @returns NULL
+ */
+static void * _MAP_BUILD_COUNT (void * arg)
+{
+    struct _MAP_BUILD_JOB * job = arg;
+    struct _MAP_BUILD * build = job->build;
+    MAP_CFG_SIZE_TYPE * counts = build->counts + job->id * build->nparts;
+    MAP_CFG_SIZE_TYPE lo = 0;
+    MAP_CFG_SIZE_TYPE hi = 0;
+
+    _MAP_BUILD_CHUNK(build, build->old_size, job->id, &lo, &hi);
+
+    for (MAP_CFG_SIZE_TYPE tblidx = lo; tblidx < hi; tblidx++)
+        for (MAP_CFG_SIZE_TYPE i = 0; i < build->old_table[tblidx].length; i++)
+            counts[_MAP_BUILD_PART(build, build->old_table[tblidx].entries[i].hash)]++;
+
+    return NULL;
+}
+
+/**
+ * @brief Second step of MAP_RESIZE_PARALLEL(): copies the entries
+ *        of the entry arrays of a thread to their partitions of `moved`
+ * @param arg The thread's job
+ * @returns NULL
+ */
+static void * _MAP_BUILD_MOVE (void * arg)
+{
+    struct _MAP_BUILD_JOB * job = arg;
+    struct _MAP_BUILD * build = job->build;
+    MAP_CFG_SIZE_TYPE * counts = build->counts + job->id * build->nparts;
+    MAP_CFG_SIZE_TYPE lo = 0;
+    MAP_CFG_SIZE_TYPE hi = 0;
+
+    _MAP_BUILD_CHUNK(build, build->old_size, job->id, &lo, &hi);
+
+    for (MAP_CFG_SIZE_TYPE tblidx = lo; tblidx < hi; tblidx++)
+        for (MAP_CFG_SIZE_TYPE i = 0; i < build->old_table[tblidx].length; i++) {
+            const struct _MAP_ENTRY * entry = build->old_table[tblidx].entries + i;
+            build->moved[counts[_MAP_BUILD_PART(build, entry->hash)]++] = *entry;
+        }
+
+    return NULL;
+}
+
+/**
+ * @brief Second step of MAP_FROM_ARRAYS(): puts the indices of the keys
+ *        of a thread in their partitions of `order`. Keys keep their
+ *        order inside a partition
+ * @param arg The thread's job
+ * @returns NULL
+ */
+static void * _MAP_BUILD_SCATTER (void * arg)
+{
+    struct _MAP_BUILD_JOB * job = arg;
+    struct _MAP_BUILD * build = job->build;
+    MAP_CFG_SIZE_TYPE * counts = build->counts + job->id * build->nparts;
+    MAP_CFG_SIZE_TYPE lo = 0;
+    MAP_CFG_SIZE_TYPE hi = 0;
+
+    _MAP_BUILD_CHUNK(build, build->n, job->id, &lo, &hi);
+
+    for (MAP_CFG_SIZE_TYPE i = lo; i < hi; i++)
+        build->order[counts[_MAP_BUILD_PART(build, build->hashes[i])]++] = i;
+
+    return NULL;
+}
+
+/**
+ * @brief Last step of MAP_FROM_ARRAYS() and MAP_RESIZE_PARALLEL():
+ *        fills the entry arrays of the partitions of a thread (every
+ *        `nthreads`th partition). Each entry array is allocated once
+ *        with the exact capacity, and kept sorted as the entries are
+ *        added. If a key is repeated, the last one wins, as if
+ *        MAP_ADD() was called for each key
+ * @param arg The thread's job
+ * @returns NULL
+ */
+static void * _MAP_BUILD_FILL (void * arg)
+{
+    struct _MAP_BUILD_JOB * job = arg;
+    struct _MAP_BUILD * build = job->build;
+    struct _MAP_BUCKET * table = build->self->table;
+    MAP_CFG_SIZE_TYPE size = build->self->size;
+    const MAP_CFG_SIZE_TYPE * ends = build->counts + (build->nthreads - 1) * build->nparts;
+
+    for (MAP_CFG_SIZE_TYPE p = job->id; p < build->nparts; p += build->nthreads) {
+        MAP_CFG_SIZE_TYPE first = (p > 0) ? ends[p - 1] : 0;
+        MAP_CFG_SIZE_TYPE last = ends[p];
+
+        /* count the entries of each entry array... */
+        for (MAP_CFG_SIZE_TYPE pos = first; pos < last; pos++)
+            table[_MAP_INDEX(_MAP_BUILD_AT(build, pos).hash, size)].capacity++;
+
+        /* ... allocate them... */
+#  ifdef MAP_CFG_ARENA
+        /* ... one after the other, in table order... */
+        struct _MAP_ENTRY * entries = build->entries + first;
+        MAP_CFG_SIZE_TYPE lo = p * build->width;
+        MAP_CFG_SIZE_TYPE hi = lo + build->width;
+        if (hi > size)
+            hi = size;
+        for (MAP_CFG_SIZE_TYPE tblidx = lo; tblidx < hi; tblidx++) {
+            if (table[tblidx].capacity > 0) {
+                table[tblidx].entries = entries;
+                entries += table[tblidx].capacity;
+            }
+        }
+#  else /* MAP_CFG_ARENA */
+        for (MAP_CFG_SIZE_TYPE pos = first; pos < last; pos++) {
+            struct _MAP_BUCKET * bucket = table + _MAP_INDEX(_MAP_BUILD_AT(build, pos).hash, size);
+            if (bucket->entries == NULL
+                    && (bucket->entries = MAP_CFG_MALLOC(bucket->capacity * sizeof(*bucket->entries))) == NULL)
+                return (job->ok = false), NULL;
+        }
+#  endif /* MAP_CFG_ARENA */
+
+        /* ... and fill them */
+        for (MAP_CFG_SIZE_TYPE pos = first; pos < last; pos++) {
+            struct _MAP_ENTRY entry = _MAP_BUILD_AT(build, pos);
+            struct _MAP_BUCKET * bucket = table + _MAP_INDEX(entry.hash, size);
+            MAP_CFG_SIZE_TYPE i = 0;
+
+            if (!_MAP_BUCKET_SEARCH(bucket, entry.key, entry.hash, &i)) {
+                memmove(bucket->entries + i + 1,
+                        bucket->entries + i,
+                        (bucket->length - i) * sizeof(*bucket->entries));
+                bucket->length++;
+                job->cardinal++;
+            }
+
+            bucket->entries[i] = entry;
+        }
+    }
+
+    return NULL;
+}
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief Runs @a func once for each job, each in its own thread (with
+ *        MAP_CFG_THREADS), and waits for all of them
+ * @param jobs The jobs
+ * @param njobs Number of jobs
+ * @param func What to run
+ *
+ * If a thread can't be created, its job is run in the calling thread
+ */
+static void _MAP_BUILD_RUN (struct _MAP_BUILD_JOB * jobs, MAP_CFG_SIZE_TYPE njobs, void * (* func) (void *))
+{
+# ifdef MAP_CFG_THREADS
+    for (MAP_CFG_SIZE_TYPE i = 1; i < njobs; i++)
+        jobs[i].started = pthread_create(&jobs[i].thread, NULL, func, jobs + i) == 0;
+
+    func(jobs + 0);
+
+    for (MAP_CFG_SIZE_TYPE i = 1; i < njobs; i++) {
+        if (jobs[i].started)
+            pthread_join(jobs[i].thread, NULL);
+        else
+            func(jobs + i);
+    }
+# else /* MAP_CFG_THREADS */
+    for (MAP_CFG_SIZE_TYPE i = 0; i < njobs; i++)
+        func(jobs + i);
+# endif /* MAP_CFG_THREADS */
+}
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief Fills the (empty) table of `build->self` with the `build->n`
+ *        keys (or the entries of `old_table`): groups them by the
+ *        partition of entry arrays they go to, then fills every
+ *        partition, all in parallel
+ * @param build The shared state (`self`, `n`, `nthreads` and either
+ *        `keys`, `values` and `hashes` or `old_table` and `old_size`)
+ * @param jobs One job per thread
+ * @returns `true` if it filled the table. Otherwise, the table is left
+ *          empty again
+ */
+static bool _MAP_BUILD_SPREAD (struct _MAP_BUILD * build, struct _MAP_BUILD_JOB * jobs)
+{
+    struct MAP_CFG_MAP * self = build->self;
+    MAP_CFG_SIZE_TYPE nthreads = build->nthreads;
+    bool resizing = build->old_table != NULL;
+
+    /* a few partitions per thread, so they all get about the same work */
+    build->nparts = (self->size / 16 > nthreads) ?
+        nthreads * 16:
+        nthreads;
+    build->width = self->size / build->nparts + (self->size % build->nparts != 0);
+    build->counts = MAP_CFG_CALLOC((size_t) nthreads * build->nparts, sizeof(*build->counts));
+    if (resizing)
+        build->moved = MAP_CFG_MALLOC(build->n * sizeof(*build->moved));
+    else
+        build->order = MAP_CFG_MALLOC(build->n * sizeof(*build->order));
+    bool ret = build->counts != NULL
+        && (build->order != NULL || build->moved != NULL);
+
+#  ifdef MAP_CFG_ARENA
+    /* every entry array of the map, in a single chunk */
+    build->entries = (ret) ?
+        (void *) _MAP_ARENA_CHUNK(&self->arena, build->n * sizeof(*build->entries)):
+        NULL;
+    ret = ret && build->entries != NULL;
+#  endif /* MAP_CFG_ARENA */
+
+    if (ret) {
+        _MAP_BUILD_RUN(jobs, nthreads, (resizing) ? _MAP_BUILD_COUNT : _MAP_BUILD_HASH);
+
+        /* where each thread puts the keys of each partition */
+        MAP_CFG_SIZE_TYPE offset = 0;
+        for (MAP_CFG_SIZE_TYPE p = 0; p < build->nparts; p++) {
+            for (MAP_CFG_SIZE_TYPE t = 0; t < nthreads; t++) {
+                MAP_CFG_SIZE_TYPE count = build->counts[t * build->nparts + p];
+                build->counts[t * build->nparts + p] = offset;
+                offset += count;
+            }
+        }
+
+        _MAP_BUILD_RUN(jobs, nthreads, (resizing) ? _MAP_BUILD_MOVE : _MAP_BUILD_SCATTER);
+        _MAP_BUILD_RUN(jobs, nthreads, _MAP_BUILD_FILL);
+
+        for (MAP_CFG_SIZE_TYPE t = 0; t < nthreads; t++) {
+            ret = ret && jobs[t].ok;
+            self->cardinal += jobs[t].cardinal;
+        }
+    }
+
+    if (build->order != NULL)
+        MAP_CFG_FREE(build->order);
+    if (build->moved != NULL)
+        MAP_CFG_FREE(build->moved);
+    if (build->counts != NULL)
+        MAP_CFG_FREE(build->counts);
+
+    /* the keys and values still belong to the caller (or the old table) */
+    if (!ret) {
+        for (MAP_CFG_SIZE_TYPE i = 0; i < self->size; i++) {
+#  ifndef MAP_CFG_ARENA /* MAP_FREE() releases the arena */
+            if (self->table[i].entries != NULL)
+                MAP_CFG_FREE(self->table[i].entries);
+#  endif /* MAP_CFG_ARENA */
+            self->table[i] = (struct _MAP_BUCKET) {0};
+        }
+        self->cardinal = 0;
+    }
+
+    return ret;
+}
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+# ifdef MAP_CFG_IMAGE
+/*
+ * First bytes of an image, and a number to tell the byte order
+ */
+#  define _MAP_IMAGE_MAGIC "c-utils map image\n"
+#  define _MAP_IMAGE_ORDER UINT32_C(0x01020304)
+
+/*
+ * Whether the hashes in an image depend on a seed
+ */
+#  ifdef MAP_CFG_SEEDED_HASH
+#   define _MAP_IMAGE_SEEDED 1
+#  else /* MAP_CFG_SEEDED_HASH */
+#   define _MAP_IMAGE_SEEDED 0
+#  endif /* MAP_CFG_SEEDED_HASH */
+
+/*
+ * Size of the values in an image (0 for sets)
+ */
+#  ifdef MAP_CFG_NO_VALUE
+#   define _MAP_IMAGE_VALUE_SIZE 0
+#  else /* MAP_CFG_NO_VALUE */
+#   define _MAP_IMAGE_VALUE_SIZE sizeof(MAP_CFG_VALUE_DATA_TYPE)
+#  endif /* MAP_CFG_NO_VALUE */
+
+/**
+ * @brief The start of an image. The bucket starts and the entries come
+ *        after it, at the given offsets (from the start of the file)
+ */
+struct _MAP_IMAGE_HEADER {
+    /** _MAP_IMAGE_MAGIC */
+    char magic[sizeof(_MAP_IMAGE_MAGIC)];
+
+    /** _MAP_IMAGE_ORDER, in the writer's byte order */
+    uint32_t order;
+
+    /** Sizes of the types of the writer */
+    uint32_t hash_size;
+    uint32_t size_size;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint32_t entry_size;
+
+    /** Whether the writer had MAP_CFG_SEEDED_HASH */
+    uint32_t seeded;
+
+    /** Seed of the hash function (0 if not seeded) */
+    uint64_t seed;
+
+    /** Number of buckets */
+    uint64_t nbuckets;
+
+    /** Number of entries */
+    uint64_t cardinal;
+
+    /** Offset of the bucket starts */
+    uint64_t starts;
+
+    /** Offset of the entries */
+    uint64_t entries;
+};
+
+/**
+ * @brief Rounds @a offset up to a multiple of @a align
+ * @param offset The offset
+ * @param align The alignment (a power of two)
+ * @returns The rounded offset
+ */
+static inline uint64_t _MAP_IMAGE_ALIGN (uint64_t offset, uint64_t align)
+{
+    return (offset + align - 1) & ~(align - 1);
+}
+
+/**
+ * @brief Finds the entry with key @a key in an image
+ * @param img The image
+ * @param key The key
+ * @returns The entry, or NULL if there's no entry with key @a key
+ */
+static const struct _MAP_ENTRY * _MAP_IMAGE_FIND (const struct MAP_IMAGE * img, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    if (img == NULL || img->base == NULL)
+        return NULL;
+
+    MAP_CFG_HASH_TYPE hash = _MAP_HASH(img, key);
+    MAP_CFG_SIZE_TYPE b = (MAP_CFG_SIZE_TYPE) (hash % img->nbuckets);
+    MAP_CFG_SIZE_TYPE first = img->starts[b];
+    MAP_CFG_SIZE_TYPE last = img->starts[b + 1];
+
+    /* don't trust the file more than needed */
+    if (first > last || last > img->cardinal)
+        return NULL;
+
+    for (MAP_CFG_SIZE_TYPE i = first; i < last; i++)
+        if (img->entries[i].hash == hash
+                && MAP_CFG_KEY_CMP(key, img->entries[i].key) == 0)
+            return img->entries + i;
+
+    return NULL;
+}
+# endif /* MAP_CFG_IMAGE */
+
+/**
+ * @brief Gets the bucket of a frozen map of a hash
+ * @param hash The hash
+ * @param nbuckets The number of buckets
+ * @returns The bucket
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_FROZEN_BUCKET (MAP_CFG_HASH_TYPE hash, MAP_CFG_SIZE_TYPE nbuckets)
+{
+    return (MAP_CFG_SIZE_TYPE) (_MAP_MIX64((uint64_t) hash) % nbuckets);
+}
+
+/**
+ * @brief Gets the position of a frozen map of a hash, given the pilot
+ *        of its bucket
+ * @param hash The hash
+ * @param pilot The pilot
+ * @param npos The number of positions
+ * @returns The position
+ */
+static inline MAP_CFG_SIZE_TYPE _MAP_FROZEN_POS (MAP_CFG_HASH_TYPE hash, uint16_t pilot, MAP_CFG_SIZE_TYPE npos)
+{
+    uint64_t seed = ((uint64_t) pilot + 1) * UINT64_C(0x9e3779b97f4a7c15);
+    return (MAP_CFG_SIZE_TYPE) (_MAP_MIX64((uint64_t) hash ^ seed) % npos);
+}
+
+/**
+ * @brief Compares the hashes of two entries, to sort the overflow of a
+ *        frozen map with `qsort()`
+ */
+static int _MAP_FROZEN_CMP (const void * _a, const void * _b)
+{
+    const struct _MAP_ENTRY * a = _a;
+    const struct _MAP_ENTRY * b = _b;
+    return (a->hash > b->hash) - (a->hash < b->hash);
+}
+
+/**
+ * @brief Finds the entry with key @a key in a frozen map
+ * @param frozen The frozen map
+ * @param key The key
+ * @returns The entry, or NULL if there's no entry with key @a key
+ */
+static const struct _MAP_ENTRY * _MAP_FROZEN_FIND (const struct MAP_FROZEN * frozen, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    if (frozen == NULL || frozen->pilots == NULL)
+        return NULL;
+
+    MAP_CFG_HASH_TYPE hash = _MAP_HASH(frozen, key);
+
+    if (frozen->nslots > 0) {
+        MAP_CFG_SIZE_TYPE b = _MAP_FROZEN_BUCKET(hash, frozen->nbuckets);
+        MAP_CFG_SIZE_TYPE i = _MAP_FROZEN_POS(hash, frozen->pilots[b], frozen->npos);
+
+        if (i >= frozen->nslots)
+            i = frozen->remap[i - frozen->nslots];
+
+        const struct _MAP_ENTRY * entry = frozen->slots + i;
+        if (entry->hash == hash && MAP_CFG_KEY_CMP(key, entry->key) == 0)
+            return entry;
+    }
+
+    /* the first overflow entry with a hash not less than `hash` */
+    MAP_CFG_SIZE_TYPE lo = 0;
+    MAP_CFG_SIZE_TYPE hi = frozen->noverflow;
+    while (lo < hi) {
+        MAP_CFG_SIZE_TYPE mid = lo + (hi - lo) / 2;
+        if (frozen->overflow[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (MAP_CFG_SIZE_TYPE i = lo; i < frozen->noverflow && frozen->overflow[i].hash == hash; i++)
+        if (MAP_CFG_KEY_CMP(key, frozen->overflow[i].key) == 0)
+            return frozen->overflow + i;
+
+    return NULL;
+}
+
+/**
+ * @brief Gets the key of the iterator's current entry.
+ *        The map must be iterating
+ * @param self The map
+ * @returns The key of the iterator's current entry
+ */
+MAP_CFG_KEY_DATA_TYPE MAP_ITER_KEY (const struct MAP_CFG_MAP * self)
+{
+    assert(self->iter.ing);
+    assert(self->iter.tblidx < self->size);
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    assert(_MAP_CTRL_FULL(self->ctrl[self->iter.tblidx]));
+    return self->slots[self->iter.tblidx].key;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    assert(self->iter.entidx < self->table[self->iter.tblidx].length);
+    return self->table[self->iter.tblidx].entries[self->iter.entidx].key;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Calculates the hash of @a key the way the map does (with its
+ *        seed, with MAP_CFG_SEEDED_HASH), for the `*_WITH_HASH()`
+ *        functions
+ * @param self The map
+ * @param key The key
+ * @returns The hash of @a key
+ */
+MAP_CFG_STATIC MAP_CFG_HASH_TYPE MAP_HASH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+{
+# ifndef MAP_CFG_SEEDED_HASH
+    (void) self;
+# endif /* MAP_CFG_SEEDED_HASH */
+    return _MAP_HASH(self, key);
+}
+
+# ifndef MAP_CFG_NO_VALUE
+/**
+ * @brief Same as MAP_GET(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @returns The same as MAP_GET()
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE MAP_GET_WITH_HASH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash)
+{
+    assert(self != NULL);
+    assert(self->size >= 3);
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    assert(self->slots != NULL);
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    assert(self->table != NULL);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    const struct _MAP_ENTRY * entry = _MAP_FIND(self, NULL, key, hash);
+    assert(entry != NULL);
+    return entry->value;
+}
+
+/**
+ * @brief Gets the value associated with a given key
+ *        The map must have been successfully initialized with
+ *        MAP_NEW() or MAP_WITH_SIZE()
+ * @param self The map
+ * @param key The key (must be the key of an entry in the map)
+ * @returns The value associated with @a key
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE MAP_GET (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    return MAP_GET_WITH_HASH(self, key, _MAP_HASH(self, key));
+}
+
+/**
+ * @brief Same as MAP_GET(), but checks @a lc first, and saves where
+ *        the entry was found in it. Faster when the same key is looked
+ *        up many times in a row
+ * @param self The map
+ * @param lc A lookup cache, owned by the caller (e.g., one per thread)
+ * @param key The key (must be the key of an entry in the map)
+ * @returns The value associated with @a key
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE MAP_GET_LC (const struct MAP_CFG_MAP * self, struct MAP_LC * lc, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    assert(self != NULL);
+    assert(self->size >= 3);
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    assert(self->slots != NULL);
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    assert(self->table != NULL);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    const struct _MAP_ENTRY * entry = _MAP_FIND(self, lc, key, _MAP_HASH(self, key));
+    assert(entry != NULL);
+    return entry->value;
+}
+
+/**
+ * @brief Gets the values of many keys at once. Faster than calling
+ *        MAP_GET() for each key, because the lookups of up to
+ *        MAP_CFG_BATCH keys are interleaved
+ * @param self The map
+ * @param keys The keys
+ * @param n The number of keys
+ * @param[out] out_values Where to put the value of each key. Left
+ *             untouched for keys that aren't in the map. May be NULL
+ * @param[out] out_found Where to put whether each key is in the map.
+ *             May be NULL
+ * @returns The number of keys in the map
+ */
+MAP_CFG_STATIC MAP_CFG_SIZE_TYPE MAP_GET_MANY (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, MAP_CFG_VALUE_DATA_TYPE * out_values, bool * out_found)
+{
+    return _MAP_LOOKUP_MANY(self, keys, n, out_values, out_found);
+}
+
+/**
+ * @brief Gets the value of the iterator's current entry.
+ *        The map must be iterating
+ * @param self The map
+ * @returns The value of the iterator's current entry
+ */
+MAP_CFG_VALUE_DATA_TYPE MAP_ITER_VAL (const struct MAP_CFG_MAP * self)
+{
+    assert(self->iter.ing);
+    assert(self->iter.tblidx < self->size);
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    assert(_MAP_CTRL_FULL(self->ctrl[self->iter.tblidx]));
+    return self->slots[self->iter.tblidx].value;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    assert(self->iter.entidx < self->table[self->iter.tblidx].length);
+    return self->table[self->iter.tblidx].entries[self->iter.entidx].value;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+# endif /* MAP_CFG_NO_VALUE */
+
+/**
+ * @brief Same as MAP_ADD(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @param value The same as for MAP_ADD()
+ * @returns The same as MAP_ADD()
+ */
+# ifdef MAP_CFG_NO_VALUE
+MAP_CFG_STATIC bool MAP_ADD_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash)
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_STATIC bool MAP_ADD_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, const MAP_CFG_VALUE_DATA_TYPE value)
+# endif /* MAP_CFG_NO_VALUE */
+{
+    bool inserted = false;
+    struct _MAP_ENTRY * entry = _MAP_FIND_OR_INSERT(self, key, hash, &inserted);
+
+    if (entry == NULL)
+        return false;
+
+    entry->key = key;
+# ifndef MAP_CFG_NO_VALUE
+    entry->value = value;
+# endif /* MAP_CFG_NO_VALUE */
+
+    return true;
+}
+
+/**
+ * @brief Adds or updates an entry to the map with @a key and @a value.
+ *        The map must have been successfully initialized with
+ *        MAP_NEW() or MAP_WITH_SIZE()
+ * @param self The map
+ * @param key The key
+ * @param value The value (not with MAP_CFG_NO_VALUE)
+ * @returns `true` if it successfully added the entry to the map.
+ *          This function fails (returns `false`) if the map isn't
+ *          valid, or it wasn't possible to get space for the new entry
+ *
+ * With MAP_CFG_INCREMENTAL_RESIZE, it also fails if it wasn't possible
+ *     to move the entries that could have key @a key to the new table
+ */
+# ifdef MAP_CFG_NO_VALUE
+MAP_CFG_STATIC bool MAP_ADD (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    return MAP_ADD_WITH_HASH(self, key, _MAP_HASH(self, key));
+}
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_STATIC bool MAP_ADD (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value)
+{
+    return MAP_ADD_WITH_HASH(self, key, _MAP_HASH(self, key), value);
+}
+# endif /* MAP_CFG_NO_VALUE */
+
+# ifndef MAP_CFG_NO_VALUE
+/**
+ * @brief Same as MAP_GET_PTR(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @returns The same as MAP_GET_PTR()
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE * MAP_GET_PTR_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash)
+{
+    MAP_CFG_SIZE_TYPE i = 0;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
+        return NULL;
+
+    return (_MAP_OA_SEARCH(self, key, hash, &i)) ?
+        &self->slots[i].value:
+        NULL;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return NULL;
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (!_MAP_MIGRATE(self, hash)) {
+        struct _MAP_BUCKET * old = self->old_table + _MAP_INDEX(hash, self->old_size);
+        if (_MAP_BUCKET_SEARCH(old, key, hash, &i))
+            return &old->entries[i].value;
+    }
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+    MAP_CFG_SIZE_TYPE tblidx = _MAP_INDEX(hash, self->size);
+
+    return (_MAP_SEARCH(self, NULL, key, hash, tblidx, &i)) ?
+        &self->table[tblidx].entries[i].value:
+        NULL;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Gets a pointer to the value of the entry with key @a key,
+ *        which can be used to read or modify it in place
+ * @param self The map
+ * @param key The key
+ * @returns A pointer to the value, or NULL if there's no entry with
+ *          key @a key. It is only valid until the map is next changed
+ *          (with MAP_ADD(), MAP_REMOVE(), MAP_RESIZE(), ...)
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE * MAP_GET_PTR (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    return MAP_GET_PTR_WITH_HASH(self, key, _MAP_HASH(self, key));
+}
+
+/**
+ * @brief Same as MAP_ENTRY(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @param[out] inserted The same as for MAP_ENTRY()
+ * @returns The same as MAP_ENTRY()
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE * MAP_ENTRY_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, bool * inserted)
+{
+    bool _inserted = false;
+    struct _MAP_ENTRY * entry = _MAP_FIND_OR_INSERT(self, key, hash, &_inserted);
+
+    if (inserted != NULL)
+        *inserted = _inserted;
+
+    return (entry != NULL) ?
+        &entry->value:
+        NULL;
+}
+
+/**
+ * @brief Gets a pointer to the value of the entry with key @a key,
+ *        adding an entry with a zeroed value first if there's none.
+ *        E.g., to count occurrences: `(*MAP_ENTRY(&map, key, NULL))++`
+ *        (if it can't fail)
+ * @param self The map
+ * @param key The key
+ * @param[out] inserted Whether the entry was added (may be NULL)
+ * @returns A pointer to the value, or NULL if the map isn't valid or
+ *          it wasn't possible to add the entry. It is only valid
+ *          until the map is next changed
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE * MAP_ENTRY (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, bool * inserted)
+{
+    return MAP_ENTRY_WITH_HASH(self, key, _MAP_HASH(self, key), inserted);
+}
+
+/**
+ * @brief Same as MAP_UPSERT(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @param value The same as for MAP_UPSERT()
+ * @returns The same as MAP_UPSERT()
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE * MAP_UPSERT_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, const MAP_CFG_VALUE_DATA_TYPE value)
+{
+    bool inserted = false;
+    struct _MAP_ENTRY * entry = _MAP_FIND_OR_INSERT(self, key, hash, &inserted);
+
+    if (entry == NULL)
+        return NULL;
+
+    entry->key = key;
+    entry->value = value;
+
+    return &entry->value;
+}
+
+/**
+ * @brief Adds or updates an entry, like MAP_ADD(), but returns a
+ *        pointer to its value
+ * @param self The map
+ * @param key The key
+ * @param value The value
+ * @returns A pointer to the value, or NULL if the map isn't valid or
+ *          it wasn't possible to add the entry. It is only valid
+ *          until the map is next changed
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE * MAP_UPSERT (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value)
+{
+    return MAP_UPSERT_WITH_HASH(self, key, _MAP_HASH(self, key), value);
+}
+# endif /* MAP_CFG_NO_VALUE */
+
+/**
+ * @brief Same as MAP_CONTAINS(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @returns The same as MAP_CONTAINS()
+ */
+MAP_CFG_STATIC bool MAP_CONTAINS_WITH_HASH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
+        return false;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return false;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    return _MAP_FIND(self, NULL, key, hash) != NULL;
+}
+
+/**
+ * @brief Checks if the map contains a given @a key
+ * @param self The map
+ * @param key The key
+ * @returns `true` if the map contains @a key
+ */
+MAP_CFG_STATIC bool MAP_CONTAINS (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    return MAP_CONTAINS_WITH_HASH(self, key, _MAP_HASH(self, key));
+}
+
+/**
+ * @brief Same as MAP_CONTAINS(), but checks @a lc first, and saves
+ *        where the entry was found in it. Faster when the same key is
+ *        looked up many times in a row
+ * @param self The map
+ * @param lc A lookup cache, owned by the caller (e.g., one per thread)
+ * @param key The key
+ * @returns `true` if the map contains @a key
+ */
+MAP_CFG_STATIC bool MAP_CONTAINS_LC (const struct MAP_CFG_MAP * self, struct MAP_LC * lc, const MAP_CFG_KEY_DATA_TYPE key)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
+        return false;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return false;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    return _MAP_FIND(self, lc, key, _MAP_HASH(self, key)) != NULL;
+}
+
+/**
+ * @brief Checks if the map contains each of many keys. Faster than
+ *        calling MAP_CONTAINS() for each key, because the lookups of
+ *        up to MAP_CFG_BATCH keys are interleaved
+ * @param self The map
+ * @param keys The keys
+ * @param n The number of keys
+ * @param[out] out_found Where to put whether each key is in the map.
+ *             May be NULL
+ * @returns The number of keys in the map
+ */
+MAP_CFG_STATIC MAP_CFG_SIZE_TYPE MAP_CONTAINS_MANY (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, bool * out_found)
+{
+# ifdef MAP_CFG_NO_VALUE
+    return _MAP_LOOKUP_MANY(self, keys, n, out_found);
+# else /* MAP_CFG_NO_VALUE */
+    return _MAP_LOOKUP_MANY(self, keys, n, NULL, out_found);
+# endif /* MAP_CFG_NO_VALUE */
+}
+
+# ifndef MAP_CFG_NO_VALUE
+/**
+ * @brief Same as MAP_LOOKUP(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @param[out] value The same as for MAP_LOOKUP()
+ * @returns The same as MAP_LOOKUP()
+ */
+MAP_CFG_STATIC bool MAP_LOOKUP_WITH_HASH (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_VALUE_DATA_TYPE * value)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
+        return false;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return false;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    const struct _MAP_ENTRY * entry = _MAP_FIND(self, NULL, key, hash);
+
+    if (entry != NULL && value != NULL)
+        *value = entry->value;
+
+    return entry != NULL;
+}
+
+/**
+ * @brief Looks up the value associated with a given key. Unlike
+ *        MAP_GET(), the key doesn't have to be in the map
+ * @param self The map
+ * @param key The key
+ * @param[out] value Where to put the value. Left untouched if there's
+ *             no entry with @a key. May be NULL
+ * @returns `true` if there's an entry with @a key
+ */
+MAP_CFG_STATIC bool MAP_LOOKUP (const struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value)
+{
+    return MAP_LOOKUP_WITH_HASH(self, key, _MAP_HASH(self, key), value);
+}
+# endif /* MAP_CFG_NO_VALUE */
+
+/**
+ * @brief Checks if the map is empty (i.e., has no entries)
+ * @param self The map
+ * @returns `true` if the map is empty, `false` otherwise
+ */
+bool MAP_IS_EMPTY (const struct MAP_CFG_MAP * self)
+{
+    return MAP_CARDINAL(self) == 0;
+}
+
+/**
+ * @brief Starts iterating over the map
+ * @param self The map
+ * @returns `false` if the map is already iterating or is empty
+ *
+ * With MAP_CFG_INCREMENTAL_RESIZE, a resize in progress is finished
+ *     first, and if that fails so does this function
+ */
+bool MAP_ITER (struct MAP_CFG_MAP * self)
+{
+    if (self->iter.ing || MAP_IS_EMPTY(self))
+        return false;
+
+# if !defined(MAP_CFG_OPEN_ADDRESSING) && defined(MAP_CFG_INCREMENTAL_RESIZE)
+    /* the iterator only knows about one table */
+    if (self->old_table != NULL && !_MAP_MIGRATE_STEP(self, _MAP_SIZE_MAX))
+        return false;
+# endif /* !MAP_CFG_OPEN_ADDRESSING && MAP_CFG_INCREMENTAL_RESIZE */
+
+    MAP_CFG_SIZE_TYPE tblidx = 0;
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    for (; tblidx < self->size && !_MAP_CTRL_FULL(self->ctrl[tblidx]); tblidx++)
+        ;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    for (; tblidx < self->size && self->table[tblidx].length == 0; tblidx++)
+        ;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    self->iter.ing = true;
+    self->iter.tblidx = tblidx;
+    self->iter.entidx = 0;
+
+    return true;
+}
+
+/**
+ * @brief Checks if the map is iterating
+ * @param self The map
+ * @returns `true` if the map is iterating
+ */
+bool MAP_ITERING (const struct MAP_CFG_MAP * self)
+{
+    return self && self->iter.ing;
+}
+
+/**
+ * @brief Stops iterating over the map. Has no effect if is wasn't
+ *        iterating
+ * @param self The map
+ * @returns `true` if the map is not NULL
+ */
+bool MAP_ITER_END (struct MAP_CFG_MAP * self)
+{
+    return self
+        && !(self->iter.ing = false);
+}
+
+/**
+ * @brief Advances the iterator to the next entry (if any)
+ * @param self The map
+ * @returns `true` if the map is still iterating. After the last entry,
+ *          the iteration is automatically stopped
+ */
+bool MAP_ITER_NEXT (struct MAP_CFG_MAP * self)
+{
+    if (!MAP_ITERING(self) || self->iter.tblidx >= self->size)
+        return MAP_ITER_END(self), false;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    MAP_CFG_SIZE_TYPE tblidx = self->iter.tblidx + 1;
+    for (; tblidx < self->size && !_MAP_CTRL_FULL(self->ctrl[tblidx]); tblidx++)
+        ;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self->iter.entidx + 1 < self->table[self->iter.tblidx].length)
+        return self->iter.entidx++, true;
+
+    MAP_CFG_SIZE_TYPE tblidx = self->iter.tblidx + 1;
+    for (; tblidx < self->size && self->table[tblidx].length == 0; tblidx++)
+        ;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    bool ret = tblidx < self->size;
+    if (ret) {
+        self->iter.tblidx = tblidx;
+        self->iter.entidx = 0;
+    } else {
+        MAP_ITER_END(self);
+    }
+
+    return ret;
+}
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief Gets the entry array of a cursor's table index
+ * @param self The map
+ * @param tblidx The table index
+ * @returns The entry array
+ */
+static inline const struct _MAP_BUCKET * _MAP_CURSOR_BUCKET (const struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE tblidx)
+{
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (tblidx < self->old_size)
+        return self->old_table + tblidx;
+    tblidx -= self->old_size;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+    return self->table + tblidx;
+}
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief Gets the entry a cursor is at
+ * @param cur The cursor (must be at an entry)
+ * @returns The entry
+ */
+static inline const struct _MAP_ENTRY * _MAP_CURSOR_ENTRY (const struct MAP_CURSOR * cur)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    return cur->map->slots + cur->tblidx;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    return _MAP_CURSOR_BUCKET(cur->map, cur->tblidx)->entries + cur->entidx;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Moves a cursor forward, starting at its current table index,
+ *        until it is at an entry or at its end
+ * @param cur The cursor
+ * @returns `true` if the cursor is at an entry
+ */
+static bool _MAP_CURSOR_SEEK (struct MAP_CURSOR * cur)
+{
+    const struct MAP_CFG_MAP * self = cur->map;
+
+    cur->entidx = 0;
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    for (; cur->tblidx < cur->end && !_MAP_CTRL_FULL(self->ctrl[cur->tblidx]); cur->tblidx++)
+        ;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    for (; cur->tblidx < cur->end && _MAP_CURSOR_BUCKET(self, cur->tblidx)->length == 0; cur->tblidx++)
+        ;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    return cur->tblidx < cur->end;
+}
+
+/**
+ * @brief Starts a cursor over the @a part th of @a nparts parts of the
+ *        map. Parts don't overlap, and together they cover the whole map
+ * @param self The map
+ * @param cur The cursor
+ * @param part Which part (less than @a nparts)
+ * @param nparts Number of parts (at least 1)
+ * @returns `true` if the cursor is at an entry
+ */
+static bool _MAP_CURSOR_PART (const struct MAP_CFG_MAP * self, struct MAP_CURSOR * cur, MAP_CFG_SIZE_TYPE part, MAP_CFG_SIZE_TYPE nparts)
+{
+    MAP_CFG_SIZE_TYPE total = 0;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self != NULL && self->slots != NULL)
+        total = self->size;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self != NULL && self->table != NULL)
+        total = self->size;
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (self != NULL && self->old_table != NULL)
+        total += self->old_size;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    /* the first `total % nparts` parts get one more table index */
+    MAP_CFG_SIZE_TYPE len = total / nparts;
+    MAP_CFG_SIZE_TYPE extra = total % nparts;
+
+    cur->map = self;
+    cur->tblidx = part * len + ((part < extra) ? part : extra);
+    cur->end = cur->tblidx + len + (part < extra);
+
+    return _MAP_CURSOR_SEEK(cur);
+}
+
+/**
+ * @brief Starts a cursor over the whole map, at its first entry
+ * @param self The map
+ * @param cur The cursor
+ * @returns `true` if the cursor is at an entry, `false` if the map is
+ *          empty
+ *
+ * Usage:
+ *     struct map_cursor cur;
+ *     for (bool ok = map_cursor_begin(&m, &cur); ok; ok = map_cursor_next(&cur))
+ *         ... map_cursor_key(&cur) ... map_cursor_value(&cur) ...
+ */
+MAP_CFG_STATIC bool MAP_CURSOR_BEGIN (const struct MAP_CFG_MAP * self, struct MAP_CURSOR * cur)
+{
+    return cur != NULL
+        && _MAP_CURSOR_PART(self, cur, 0, 1);
+}
+
+/**
+ * @brief Gets the key of a cursor's current entry.
+ *        The cursor must be at an entry
+ * @param cur The cursor
+ * @returns The key of the cursor's current entry
+ */
+MAP_CFG_STATIC MAP_CFG_KEY_DATA_TYPE MAP_CURSOR_KEY (const struct MAP_CURSOR * cur)
+{
+    assert(MAP_CURSOR_VALID(cur));
+    return _MAP_CURSOR_ENTRY(cur)->key;
+}
+
+/**
+ * @brief Advances a cursor to its next entry (if any)
+ * @param cur The cursor
+ * @returns `true` if the cursor is at an entry, `false` if it went past
+ *          its last one
+ */
+MAP_CFG_STATIC bool MAP_CURSOR_NEXT (struct MAP_CURSOR * cur)
+{
+    if (!MAP_CURSOR_VALID(cur))
+        return false;
+
+# ifndef MAP_CFG_OPEN_ADDRESSING
+    if (cur->entidx + 1 < _MAP_CURSOR_BUCKET(cur->map, cur->tblidx)->length)
+        return cur->entidx++, true;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    cur->tblidx++;
+    return _MAP_CURSOR_SEEK(cur);
+}
+
+/**
+ * @brief Splits the map into @a k parts, and starts a cursor over each.
+ *        Every entry is seen by exactly one of the cursors, so each can
+ *        be given to a different thread
+ * @param self The map
+ * @param[out] cursors Where to put the @a k cursors
+ * @param k Number of cursors
+ * @returns The number of cursors that are at an entry (the others have
+ *          nothing to go over)
+ *
+ * The map is split by table index, so the cursors get about the same
+ *     number of entries if the hash function is good
+ */
+MAP_CFG_STATIC MAP_CFG_SIZE_TYPE MAP_CURSOR_SPLIT (const struct MAP_CFG_MAP * self, struct MAP_CURSOR * cursors, MAP_CFG_SIZE_TYPE k)
+{
+    MAP_CFG_SIZE_TYPE ret = 0;
+
+    if (cursors == NULL)
+        return 0;
+
+    for (MAP_CFG_SIZE_TYPE i = 0; i < k; i++)
+        ret += _MAP_CURSOR_PART(self, cursors + i, i, k);
+
+    return ret;
+}
+
+/**
+ * @brief Checks if a cursor is at an entry
+ * @param cur The cursor
+ * @returns `true` if the cursor is at an entry
+ */
+MAP_CFG_STATIC bool MAP_CURSOR_VALID (const struct MAP_CURSOR * cur)
+{
+    return cur != NULL
+        && cur->map != NULL
+        && cur->tblidx < cur->end;
+}
+
+# ifndef MAP_CFG_NO_VALUE
+/**
+ * @brief Gets the value of a cursor's current entry.
+ *        The cursor must be at an entry
+ * @param cur The cursor
+ * @returns The value of the cursor's current entry
+ */
+MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE MAP_CURSOR_VALUE (const struct MAP_CURSOR * cur)
+{
+    assert(MAP_CURSOR_VALID(cur));
+    return _MAP_CURSOR_ENTRY(cur)->value;
+}
+# endif /* MAP_CFG_NO_VALUE */
+
+/**
+ * @brief Initializes a map with @a n entries at once, much faster than
+ *        adding them one by one. Entry `i` has key `keys[i]` and value
+ *        `values[i]`. If a key is repeated, the last entry wins, as
+ *        with MAP_ADD()
+ * @param self The map
+ * @param keys The keys
+ * @param values The values (not with MAP_CFG_NO_VALUE)
+ * @param n The number of entries
+ * @param nthreads How many threads to use (only with MAP_CFG_THREADS)
+ * @returns `true` if it successfully initialized the map. Otherwise,
+ *          the map is left uninitialized, and the keys and values
+ *          still belong to the caller
+ *
+ * With separate chaining, the keys are hashed and grouped by the range
+ *     of entry arrays they go to (radix-sort-like), then every entry
+ *     array is allocated once with the exact capacity, all in parallel.
+ *     With open addressing only the hashing is done in parallel, since
+ *     probe sequences cross any range of slots.
+ *     Needs memory for a hash and an index per entry while building
+ */
+# ifdef MAP_CFG_NO_VALUE
+MAP_CFG_STATIC bool MAP_FROM_ARRAYS (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, MAP_CFG_SIZE_TYPE n, MAP_CFG_SIZE_TYPE nthreads)
+{
+    if (self == NULL || (n > 0 && keys == NULL))
+        return false;
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_STATIC bool MAP_FROM_ARRAYS (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE * keys, const MAP_CFG_VALUE_DATA_TYPE * values, MAP_CFG_SIZE_TYPE n, MAP_CFG_SIZE_TYPE nthreads)
+{
+    if (self == NULL || (n > 0 && (keys == NULL || values == NULL)))
+        return false;
+# endif /* MAP_CFG_NO_VALUE */
+
+    MAP_CFG_SIZE_TYPE size = (MAP_CFG_MAX_LOAD > 0) ?
+        _MAP_SIZE_FOR(n):
+        MAP_CFG_DEFAULT_SIZE;
+    if (size == 0 || !MAP_WITH_SIZE(self, size))
+        return false;
+    if (n == 0)
+        return true;
+
+# ifndef MAP_CFG_THREADS
+    nthreads = 1;
+# endif /* MAP_CFG_THREADS */
+    if (nthreads == 0)
+        nthreads = 1;
+    if (nthreads > n)
+        nthreads = n;
+
+    struct _MAP_BUILD build = {
+        .self = self,
+        .keys = keys,
+# ifndef MAP_CFG_NO_VALUE
+        .values = values,
+# endif /* MAP_CFG_NO_VALUE */
+        .hashes = MAP_CFG_MALLOC(n * sizeof(MAP_CFG_HASH_TYPE)),
+        .n = n,
+        .nthreads = nthreads,
+    };
+    struct _MAP_BUILD_JOB * jobs = MAP_CFG_CALLOC(nthreads, sizeof(*jobs));
+    bool ret = build.hashes != NULL && jobs != NULL;
+
+    for (MAP_CFG_SIZE_TYPE t = 0; ret && t < nthreads; t++)
+        jobs[t] = (struct _MAP_BUILD_JOB) { .build = &build, .id = t, .ok = true, };
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (ret)
+        _MAP_BUILD_RUN(jobs, nthreads, _MAP_BUILD_HASH);
+
+    /* the slots were sized for n entries, there's always a free one */
+    for (MAP_CFG_SIZE_TYPE k = 0; ret && k < n; k++) {
+        MAP_CFG_SIZE_TYPE i = 0;
+
+        if (!_MAP_OA_SEARCH(self, keys[k], build.hashes[k], &i)) {
+#  ifdef MAP_CFG_ROBIN_HOOD
+            _MAP_OA_MAKE_ROOM(self, i);
+#  endif /* MAP_CFG_ROBIN_HOOD */
+            self->ctrl[i] = _MAP_H2(build.hashes[k]);
+            self->cardinal++;
+        }
+
+        self->slots[i] = (struct _MAP_ENTRY) {
+            .hash = build.hashes[k],
+            .key = keys[k],
+#  ifndef MAP_CFG_NO_VALUE
+            .value = values[k],
+#  endif /* MAP_CFG_NO_VALUE */
+        };
+    }
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    ret = ret && _MAP_BUILD_SPREAD(&build, jobs);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    if (build.hashes != NULL)
+        MAP_CFG_FREE(build.hashes);
+    if (jobs != NULL)
+        MAP_CFG_FREE(jobs);
+
+    if (!ret)
+        *self = MAP_FREE(*self);
+
+    return ret;
+}
+
+# ifdef MAP_CFG_IMAGE
+/**
+ * @brief Unmaps an image opened with MAP_IMAGE_OPEN()
+ * @param img The image
+ * @returns `true` if the image was open
+ */
+MAP_CFG_STATIC bool MAP_IMAGE_CLOSE (struct MAP_IMAGE * img)
+{
+    if (img == NULL || img->base == NULL)
+        return false;
+
+    munmap(img->base, img->length);
+    *img = (struct MAP_IMAGE) {0};
+
+    return true;
+}
+
+/**
+ * @brief Checks if an image has an entry with key @a key
+ * @param img The image
+ * @param key The key
+ * @returns `true` if the image has an entry with key @a key
+ */
+MAP_CFG_STATIC bool MAP_IMAGE_CONTAINS (const struct MAP_IMAGE * img, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    return _MAP_IMAGE_FIND(img, key) != NULL;
+}
+
+#  ifndef MAP_CFG_NO_VALUE
+/**
+ * @brief Gets the value of the entry with key @a key of an image, like
+ *        MAP_LOOKUP()
+ * @param img The image
+ * @param key The key
+ * @param[out] value Where to put the value (may be NULL)
+ * @returns `true` if the image has an entry with key @a key
+ */
+MAP_CFG_STATIC bool MAP_IMAGE_GET (const struct MAP_IMAGE * img, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value)
+{
+    const struct _MAP_ENTRY * entry = _MAP_IMAGE_FIND(img, key);
+
+    if (entry == NULL)
+        return false;
+
+    if (value != NULL)
+        *value = entry->value;
+
+    return true;
+}
+#  endif /* MAP_CFG_NO_VALUE */
+
+/**
+ * @brief Opens an image written by MAP_IMAGE_WRITE(), by mapping it to
+ *        memory (read only). Nothing is read until it is used
+ * @param[out] img The image
+ * @param path Path of the file
+ * @returns `true` if it successfully opened the image. It fails if the
+ *          file isn't an image, or was written with different types
+ */
+MAP_CFG_STATIC bool MAP_IMAGE_OPEN (struct MAP_IMAGE * img, const char * path)
+{
+    if (img == NULL || path == NULL)
+        return false;
+
+    *img = (struct MAP_IMAGE) {0};
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    bool ret = fstat(fd, &st) == 0
+        && (uint64_t) st.st_size >= sizeof(struct _MAP_IMAGE_HEADER)
+        && (uint64_t) st.st_size <= SIZE_MAX;
+    void * base = (ret) ?
+        mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0):
+        MAP_FAILED;
+    close(fd);
+
+    if (base == MAP_FAILED)
+        return false;
+
+    const struct _MAP_IMAGE_HEADER * header = base;
+    uint64_t length = (uint64_t) st.st_size;
+
+    ret = memcmp(header->magic, _MAP_IMAGE_MAGIC, sizeof(header->magic)) == 0
+        && header->order == _MAP_IMAGE_ORDER
+        && header->hash_size == sizeof(MAP_CFG_HASH_TYPE)
+        && header->size_size == sizeof(MAP_CFG_SIZE_TYPE)
+        && header->key_size == sizeof(MAP_CFG_KEY_DATA_TYPE)
+        && header->value_size == _MAP_IMAGE_VALUE_SIZE
+        && header->entry_size == sizeof(struct _MAP_ENTRY)
+        && header->seeded == _MAP_IMAGE_SEEDED
+        && header->nbuckets > 0
+        && header->nbuckets < _MAP_SIZE_MAX
+        && header->cardinal <= _MAP_SIZE_MAX
+        && header->starts % _Alignof(MAP_CFG_SIZE_TYPE) == 0
+        && header->entries % _Alignof(struct _MAP_ENTRY) == 0
+        && header->starts <= length
+        && (length - header->starts) / sizeof(MAP_CFG_SIZE_TYPE) > header->nbuckets
+        && header->entries <= length
+        && (length - header->entries) / sizeof(struct _MAP_ENTRY) >= header->cardinal;
+
+    if (!ret) {
+        munmap(base, (size_t) length);
+        return false;
+    }
+
+    *img = (struct MAP_IMAGE) {
+        .base = base,
+        .length = (size_t) length,
+        .starts = (const MAP_CFG_SIZE_TYPE *) ((const char *) base + header->starts),
+        .entries = (const struct _MAP_ENTRY *) ((const char *) base + header->entries),
+        .nbuckets = (MAP_CFG_SIZE_TYPE) header->nbuckets,
+        .cardinal = (MAP_CFG_SIZE_TYPE) header->cardinal,
+#  ifdef MAP_CFG_SEEDED_HASH
+        .seed = header->seed,
+#  endif /* MAP_CFG_SEEDED_HASH */
+    };
+
+    return true;
+}
+
+/**
+ * @brief Writes an image of a map to a file, that can be opened with
+ *        MAP_IMAGE_OPEN(). The map isn't changed
+ * @param self The map
+ * @param path Path of the file (overwritten if it exists)
+ * @returns `true` if it successfully wrote the image
+ *
+ * The image has a bucket per entry. The entries of each bucket are
+ *     together, and the buckets are found with an array of offsets, so
+ *     a lookup reads an offset and (usually) a single entry
+ */
+MAP_CFG_STATIC bool MAP_IMAGE_WRITE (const struct MAP_CFG_MAP * self, const char * path)
+{
+    if (self == NULL || path == NULL)
+        return false;
+
+    MAP_CFG_SIZE_TYPE cardinal = MAP_CARDINAL(self);
+    MAP_CFG_SIZE_TYPE nbuckets = (cardinal > 0) ? cardinal : 1;
+    if (nbuckets == _MAP_SIZE_MAX)
+        return false;
+
+    struct _MAP_IMAGE_HEADER header = {
+        .magic = _MAP_IMAGE_MAGIC,
+        .order = _MAP_IMAGE_ORDER,
+        .hash_size = sizeof(MAP_CFG_HASH_TYPE),
+        .size_size = sizeof(MAP_CFG_SIZE_TYPE),
+        .key_size = sizeof(MAP_CFG_KEY_DATA_TYPE),
+        .value_size = _MAP_IMAGE_VALUE_SIZE,
+        .entry_size = sizeof(struct _MAP_ENTRY),
+        .seeded = _MAP_IMAGE_SEEDED,
+#  ifdef MAP_CFG_SEEDED_HASH
+        .seed = self->seed,
+#  endif /* MAP_CFG_SEEDED_HASH */
+        .nbuckets = nbuckets,
+        .cardinal = cardinal,
+    };
+    header.starts = _MAP_IMAGE_ALIGN(sizeof(header), _Alignof(MAP_CFG_SIZE_TYPE));
+    header.entries = _MAP_IMAGE_ALIGN(header.starts + ((uint64_t) nbuckets + 1) * sizeof(MAP_CFG_SIZE_TYPE),
+            _Alignof(struct _MAP_ENTRY));
+
+    /* calloc() so the padding of the entries is zeroed */
+    MAP_CFG_SIZE_TYPE * starts = MAP_CFG_CALLOC((size_t) nbuckets + 1, sizeof(*starts));
+    struct _MAP_ENTRY * entries = MAP_CFG_CALLOC((cardinal > 0) ? cardinal : 1, sizeof(*entries));
+    bool ret = starts != NULL && entries != NULL;
+    struct MAP_CURSOR cur;
+
+    if (ret) {
+        /* count the entries of each bucket... */
+        for (bool ok = MAP_CURSOR_BEGIN(self, &cur); ok; ok = MAP_CURSOR_NEXT(&cur))
+            starts[_MAP_CURSOR_ENTRY(&cur)->hash % nbuckets + 1]++;
+
+        for (MAP_CFG_SIZE_TYPE b = 0; b < nbuckets; b++)
+            starts[b + 1] += starts[b];
+
+        /* ... put them in place, moving each start to the next bucket... */
+        for (bool ok = MAP_CURSOR_BEGIN(self, &cur); ok; ok = MAP_CURSOR_NEXT(&cur)) {
+            const struct _MAP_ENTRY * entry = _MAP_CURSOR_ENTRY(&cur);
+            struct _MAP_ENTRY * dst = entries + starts[entry->hash % nbuckets]++;
+            dst->hash = entry->hash;
+            dst->key = entry->key;
+#  ifndef MAP_CFG_NO_VALUE
+            dst->value = entry->value;
+#  endif /* MAP_CFG_NO_VALUE */
+        }
+
+        /* ... and move them back */
+        memmove(starts + 1, starts, nbuckets * sizeof(*starts));
+        starts[0] = 0;
+    }
+
+    /* the gaps left by fseeko() (for alignment) are read as zeros */
+    FILE * f = (ret) ? fopen(path, "wb") : NULL;
+    ret = f != NULL
+        && fwrite(&header, sizeof(header), 1, f) == 1
+        && fseeko(f, (off_t) header.starts, SEEK_SET) == 0
+        && fwrite(starts, sizeof(*starts), (size_t) nbuckets + 1, f) == (size_t) nbuckets + 1
+        && fseeko(f, (off_t) header.entries, SEEK_SET) == 0
+        && fwrite(entries, sizeof(*entries), cardinal, f) == cardinal;
+
+    if (f != NULL && fclose(f) != 0)
+        ret = false;
+
+    if (starts != NULL)
+        MAP_CFG_FREE(starts);
+    if (entries != NULL)
+        MAP_CFG_FREE(entries);
+
+    return ret;
+}
+# endif /* MAP_CFG_IMAGE */
+
+/**
+ * @brief Initializes a map with the default size
+ * @param self The map
+ * @returns `true` if it successfully initialized the map
+ */
+MAP_CFG_STATIC bool MAP_NEW (struct MAP_CFG_MAP * self)
+{
+    return MAP_WITH_SIZE(self, MAP_CFG_DEFAULT_SIZE);
+}
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief Empties a full slot (its key and value must have been dealt
+ *        with already)
+ * @param self The map
+ * @param i The slot
+ */
+static void _MAP_OA_ERASE (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE i)
+{
+#  ifdef MAP_CFG_ROBIN_HOOD
+    /* move the rest of the run back, until an entry at its home slot */
+    MAP_CFG_SIZE_TYPE mask = self->size - 1;
+    for (MAP_CFG_SIZE_TYPE next = (i + 1) & mask;
+            _MAP_CTRL_FULL(self->ctrl[next]) && _MAP_OA_DIST(self, next) > 0;
+            i = next, next = (next + 1) & mask)
+    {
+        self->ctrl[i] = self->ctrl[next];
+        self->slots[i] = self->slots[next];
+    }
+
+    self->ctrl[i] = _MAP_CTRL_EMPTY;
+#  else /* MAP_CFG_ROBIN_HOOD */
+    /*
+     * If the group already has an empty slot no probe sequence goes
+     * past it, so there's no need for a tombstone
+     */
+    if (_MAP_GROUP_MATCH(self->ctrl + (i & ~(MAP_CFG_SIZE_TYPE) (_MAP_GROUP_WIDTH - 1)), _MAP_CTRL_EMPTY) != 0) {
+        self->ctrl[i] = _MAP_CTRL_EMPTY;
+    } else {
+        self->ctrl[i] = _MAP_CTRL_DELETED;
+        self->deleted++;
+    }
+#  endif /* MAP_CFG_ROBIN_HOOD */
+
+    self->cardinal--;
+}
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief Same as MAP_REMOVE(), with the hash of @a key already computed
+ * @param self The map
+ * @param key The key
+ * @param hash The hash of @a key. Must be the same as
+ *        `MAP_HASH(self, key)`
+ * @param[out] value The same as for MAP_REMOVE()
+ * @returns The same as MAP_REMOVE()
+ */
+# ifdef MAP_CFG_NO_VALUE
+MAP_CFG_STATIC bool MAP_REMOVE_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash)
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_STATIC bool MAP_REMOVE_WITH_HASH (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_HASH_TYPE hash, MAP_CFG_VALUE_DATA_TYPE * value)
+# endif /* MAP_CFG_NO_VALUE */
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
+        return false;
+
+    MAP_CFG_SIZE_TYPE i = 0;
+    bool exists = _MAP_OA_SEARCH(self, key, hash, &i);
+    if (!exists)
+        return false;
+
+#ifdef MAP_CFG_KEY_DTOR
+    MAP_CFG_KEY_DTOR(self->slots[i].key);
+#endif /* MAP_CFG_KEY_DTOR */
+
+#  ifndef MAP_CFG_NO_VALUE
+    if (value != NULL)
+        *value = self->slots[i].value;
+#ifdef MAP_CFG_VALUE_DTOR
+    else
+        MAP_CFG_VALUE_DTOR(self->slots[i].value);
+#endif /* MAP_CFG_VALUE_DTOR */
+#  endif /* MAP_CFG_NO_VALUE */
+
+    _MAP_OA_ERASE(self, i);
+
+    return true;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return false;
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (!_MAP_MIGRATE(self, hash))
+        return false;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+    MAP_CFG_SIZE_TYPE tblidx = _MAP_INDEX(hash, self->size);
+
+    MAP_CFG_SIZE_TYPE i = 0;
+    bool exists = _MAP_SEARCH(self, NULL, key, hash, tblidx, &i);
+    if (!exists)
+        return false;
+
+#ifdef MAP_CFG_KEY_DTOR
+    MAP_CFG_KEY_DTOR(self->table[tblidx].entries[i].key);
+#endif /* MAP_CFG_KEY_DTOR */
+
+#  ifndef MAP_CFG_NO_VALUE
+    if (value != NULL)
+        *value = self->table[tblidx].entries[i].value;
+#ifdef MAP_CFG_VALUE_DTOR
+    else
+        MAP_CFG_VALUE_DTOR(self->table[tblidx].entries[i].value);
+#endif /* MAP_CFG_VALUE_DTOR */
+#  endif /* MAP_CFG_NO_VALUE */
+
+    self->table[tblidx].length--;
+    memmove(&self->table[tblidx].entries[i],
+            &self->table[tblidx].entries[i + 1],
+            sizeof(*self->table[tblidx].entries) * (self->table[tblidx].length - i));
+
+    _MAP_DECREASE_CAPACITY(self, tblidx);
+
+    self->cardinal--;
+
+    return true;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Remove the entry with a given key
+ * @param self The map
+ * @param key The key
+ * @param[out] value Where to save the value associated with @a key. If it is
+ *             NULL the value is free()d. Not with MAP_CFG_NO_VALUE
+ * @retuns `true` if there was an entry with key @a key, or `false` if there
+ *         was no such entry or the map is not valid
+ *
+ * If defined, MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are called on the
+ *     entry to be removed
+ */
+# ifdef MAP_CFG_NO_VALUE
+MAP_CFG_STATIC bool MAP_REMOVE (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+{
+    return MAP_REMOVE_WITH_HASH(self, key, _MAP_HASH(self, key));
+}
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_STATIC bool MAP_REMOVE (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value)
+{
+    return MAP_REMOVE_WITH_HASH(self, key, _MAP_HASH(self, key), value);
+}
+# endif /* MAP_CFG_NO_VALUE */
+
+#  ifndef MAP_CFG_OPEN_ADDRESSING
+/**
+ * @brief Removes the entries of an entry array that @a keep doesn't
+ *        keep, see _MAP_FILTER(). The entries left are moved down in
+ *        place, so they stay sorted
+ * @param self The map
+ * @param bucket The entry array
+ * @param keep Whether to keep an entry
+ * @param ctx Passed on to @a keep
+ */
+static void _MAP_FILTER_BUCKET (struct MAP_CFG_MAP * self, struct _MAP_BUCKET * bucket, bool (* keep) (const struct MAP_CFG_MAP *, struct _MAP_ENTRY *, const void *), const void * ctx)
+{
+    MAP_CFG_SIZE_TYPE len = 0;
+
+    for (MAP_CFG_SIZE_TYPE i = 0; i < bucket->length; i++) {
+        struct _MAP_ENTRY * entry = bucket->entries + i;
+
+        if (keep(self, entry, ctx)) {
+            bucket->entries[len++] = *entry;
+            continue;
+        }
+
+#   ifdef MAP_CFG_KEY_DTOR
+        MAP_CFG_KEY_DTOR(entry->key);
+#   endif /* MAP_CFG_KEY_DTOR */
+
+#   if defined(MAP_CFG_VALUE_DTOR) && !defined(MAP_CFG_NO_VALUE)
+        MAP_CFG_VALUE_DTOR(entry->value);
+#   endif /* MAP_CFG_VALUE_DTOR && !MAP_CFG_NO_VALUE */
+    }
+
+    self->cardinal -= bucket->length - len;
+    bucket->length = len;
+}
+#  endif /* MAP_CFG_OPEN_ADDRESSING */
+
+/**
+ * @brief Removes the entries of @a self that @a keep doesn't keep, in
+ *        a single pass over the table. With separate chaining, each
+ *        entry array is compacted in place, and shrunk (at most) once
+ * @param self The map (valid)
+ * @param keep Whether to keep an entry (it may change the value)
+ * @param ctx Passed on to @a keep
+ * @returns The number of entries removed
+ *
+ * If defined, MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are called on
+ *     the entries removed
+ */
+static MAP_CFG_SIZE_TYPE _MAP_FILTER (struct MAP_CFG_MAP * self, bool (* keep) (const struct MAP_CFG_MAP *, struct _MAP_ENTRY *, const void *), const void * ctx)
+{
+    MAP_CFG_SIZE_TYPE cardinal = self->cardinal;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    MAP_CFG_SIZE_TYPE start = 0;
+
+#  ifdef MAP_CFG_ROBIN_HOOD
+    /*
+     * Start right after an empty slot (there's always one): entries are
+     * only moved back inside their run, so none of them wraps around to
+     * the slots that were already looked at
+     */
+    while (self->ctrl[start] != _MAP_CTRL_EMPTY)
+        start++;
+#  endif /* MAP_CFG_ROBIN_HOOD */
+
+    for (MAP_CFG_SIZE_TYPE n = 0; n < self->size; ) {
+        MAP_CFG_SIZE_TYPE i = (start + n) & (self->size - 1);
+        struct _MAP_ENTRY * entry = self->slots + i;
+
+        if (_MAP_CTRL_FULL(self->ctrl[i]) && !keep(self, entry, ctx)) {
+#  ifdef MAP_CFG_KEY_DTOR
+            MAP_CFG_KEY_DTOR(entry->key);
+#  endif /* MAP_CFG_KEY_DTOR */
+
+#  if defined(MAP_CFG_VALUE_DTOR) && !defined(MAP_CFG_NO_VALUE)
+            MAP_CFG_VALUE_DTOR(entry->value);
+#  endif /* MAP_CFG_VALUE_DTOR && !MAP_CFG_NO_VALUE */
+
+            _MAP_OA_ERASE(self, i);
+
+#  ifdef MAP_CFG_ROBIN_HOOD
+            /* the rest of the run moved back, look at this slot again */
+            continue;
+#  endif /* MAP_CFG_ROBIN_HOOD */
+        }
+
+        n++;
+    }
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < self->size; tblidx++) {
+        _MAP_FILTER_BUCKET(self, self->table + tblidx, keep, ctx);
+
+        /* it's fine if it can't shrink */
+        _MAP_DECREASE_CAPACITY(self, tblidx);
+    }
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    /* the entries that weren't moved yet */
+    if (self->old_table != NULL)
+        for (MAP_CFG_SIZE_TYPE oldidx = 0; oldidx < self->old_size; oldidx++)
+            _MAP_FILTER_BUCKET(self, self->old_table + oldidx, keep, ctx);
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    return cardinal - self->cardinal;
+}
+
+/**
+ * @brief What MAP_RETAIN() keeps entries with
+ */
+struct _MAP_RETAIN {
+    /** The predicate given to MAP_RETAIN() */
+# ifdef MAP_CFG_NO_VALUE
+    bool (* pred) (const MAP_CFG_KEY_DATA_TYPE key, void * ctx);
+# else /* MAP_CFG_NO_VALUE */
+    bool (* pred) (const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value, void * ctx);
+# endif /* MAP_CFG_NO_VALUE */
+
+    /** The context given to MAP_RETAIN() */
+    void * ctx;
+};
+
+/**
+ * @brief Keeps the entries that the predicate of MAP_RETAIN() keeps,
+ *        see _MAP_FILTER()
+ * @param self The map
+ * @param entry An entry of @a self
+ * @param ctx The predicate and its context (a `struct _MAP_RETAIN`)
+ * @returns What the predicate returns for @a entry
+ */
+static bool _MAP_KEEP_PRED (const struct MAP_CFG_MAP * self, struct _MAP_ENTRY * entry, const void * ctx)
+{
+    const struct _MAP_RETAIN * retain = ctx;
+    (void) self;
+
+# ifdef MAP_CFG_NO_VALUE
+    return retain->pred(entry->key, retain->ctx);
+# else /* MAP_CFG_NO_VALUE */
+    return retain->pred(entry->key, &entry->value, retain->ctx);
+# endif /* MAP_CFG_NO_VALUE */
+}
+
+/**
+ * @brief Removes every entry for which @a pred returns `false`, in a
+ *        single pass over the table
+ * @param self The map
+ * @param pred Whether to keep an entry, given its key, a pointer to its
+ *        value (not with MAP_CFG_NO_VALUE) and @a ctx. It may change
+ *        the value, but not the map
+ * @param ctx Passed on to @a pred (may be NULL)
+ * @returns The number of entries removed (0 if @a self isn't valid)
+ *
+ * If defined, MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are called on
+ *     the entries removed.
+ *
+ * Unlike calling MAP_REMOVE() for each key, the keys aren't hashed or
+ *     looked up again, and, with separate chaining, each entry array
+ *     is compacted in one go and its memory given back once (see
+ *     MAP_CFG_BUCKET_SHRINK()). With MAP_CFG_INCREMENTAL_RESIZE, the
+ *     entries that weren't moved to the new table yet are left where
+ *     they are
+ */
+# ifdef MAP_CFG_NO_VALUE
+MAP_CFG_STATIC MAP_CFG_SIZE_TYPE MAP_RETAIN (struct MAP_CFG_MAP * self, bool (* pred) (const MAP_CFG_KEY_DATA_TYPE key, void * ctx), void * ctx)
+# else /* MAP_CFG_NO_VALUE */
+MAP_CFG_STATIC MAP_CFG_SIZE_TYPE MAP_RETAIN (struct MAP_CFG_MAP * self, bool (* pred) (const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value, void * ctx), void * ctx)
+# endif /* MAP_CFG_NO_VALUE */
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL || pred == NULL)
+        return 0;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL || pred == NULL)
+        return 0;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    struct _MAP_RETAIN retain = {
+        .pred = pred,
+        .ctx = ctx,
+    };
+
+    return _MAP_FILTER(self, _MAP_KEEP_PRED, &retain);
+}
+
+/**
+ * @brief Makes sure the map can hold at least @a n entries without
+ *        having to grow. If the map hasn't been initialized yet, it is
+ *        initialized with a big enough size
+ * @param self The map
+ * @param n The expected number of entries
+ * @returns `true` if the map can hold @a n entries without growing
+ *
+ * With separate chaining and MAP_CFG_MAX_LOAD defined as 0, the table
+ *     never grows, so this only initializes the map if needed
+ */
+MAP_CFG_STATIC bool MAP_RESERVE (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE n)
+{
+    if (self == NULL)
+        return false;
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    bool initialized = self->slots != NULL;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    bool initialized = self->table != NULL;
+
+    if (!(MAP_CFG_MAX_LOAD > 0))
+        return initialized || MAP_NEW(self);
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    MAP_CFG_SIZE_TYPE size = _MAP_SIZE_FOR(n);
+    if (size == 0)
+        return false;
+
+    return (initialized) ?
+        (size <= self->size || MAP_RESIZE(self, size)):
+        MAP_WITH_SIZE(self, size);
+}
+
+/**
+ * @brief Resizes a map
+ * @param self The map
+ * @param new_size The new size for the map
+ * @returns `true` if it successfully resized the map,
+ *          `false` otherwise
+ *
+ * Initializes a map with the requested size and tries to insert every
+ *     entry of the original map into the new one. After all entries
+ *     have been inserted, the original map is freed. This is not very
+ *     efficient memory-wise, but reduces the risk of corrupting the
+ *     original map. If any of the insertions fail, the new map is
+ *     freed and the original is left untouched.
+ *
+ * With open addressing, @a new_size is rounded up to a power of two,
+ *     and must be bigger than the number of entries. With
+ *     MAP_CFG_POW2 it is rounded up as well
+ *
+ * With MAP_CFG_INCREMENTAL_RESIZE, only the new (empty) table is
+ *     allocated here. The entries are moved a few entry arrays at a
+ *     time by the following operations on the map (see
+ *     MAP_CFG_RESIZE_STEP), and the old table is freed once it's empty
+ */
+MAP_CFG_STATIC bool MAP_RESIZE (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE new_size)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->slots == NULL)
+        return false;
+
+    new_size = _MAP_POW2(new_size);
+    return new_size > self->cardinal
+        && _MAP_OA_REHASH(self, new_size);
+# elif defined(MAP_CFG_INCREMENTAL_RESIZE)
+    if (self == NULL || self->table == NULL || new_size < 3)
+        return false;
+
+#  ifdef MAP_CFG_POW2
+    new_size = _MAP_POW2(new_size);
+    if (new_size == 0)
+        return false;
+#  endif /* MAP_CFG_POW2 */
+
+    /* only one resize at a time */
+    if (self->old_table != NULL && !_MAP_MIGRATE_STEP(self, _MAP_SIZE_MAX))
+        return false;
+
+    struct _MAP_BUCKET * table = MAP_CFG_CALLOC(new_size, sizeof(*table));
+    if (table == NULL)
+        return false;
+
+    self->old_table = self->table;
+    self->old_size = self->size;
+    self->migrated = 0;
+
+    self->table = table;
+    self->size = new_size;
+
+    return true;
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    struct MAP_CFG_MAP ret = {0};
+    if (self == NULL || !MAP_WITH_SIZE(&ret, new_size))
+        return false;
+
+    /* MAP_WITH_SIZE() may have rounded it up */
+    new_size = ret.size;
+
+#  ifdef MAP_CFG_SEEDED_HASH
+    /* the entries keep their hashes */
+    ret.seed = self->seed;
+#  endif /* MAP_CFG_SEEDED_HASH */
+
+    MAP_CFG_SIZE_TYPE cur_size = self->size;
+
+#  ifdef MAP_CFG_ARENA
+    /*
+     * Count the entries of each new bucket (in its length, for now), and
+     * give the buckets their entry arrays in table order, so that
+     * neighbouring buckets end up next to each other in the new arena
+     */
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < cur_size; tblidx++)
+        for (MAP_CFG_SIZE_TYPE entidx = 0; entidx < self->table[tblidx].length; entidx++)
+            ret.table[_MAP_INDEX(self->table[tblidx].entries[entidx].hash, new_size)].length++;
+
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < new_size; tblidx++) {
+        struct _MAP_BUCKET * bucket = ret.table + tblidx;
+        MAP_CFG_SIZE_TYPE count = bucket->length;
+
+        bucket->length = 0;
+        if (count > 0 && !_MAP_CHANGE_CAPACITY(&ret, bucket, count))
+            goto ret_cleanup;
+    }
+#  endif /* MAP_CFG_ARENA */
+
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < cur_size; tblidx++) {
+        MAP_CFG_SIZE_TYPE length = self->table[tblidx].length;
+
+        for (MAP_CFG_SIZE_TYPE entidx = 0; entidx < length; entidx++) {
+            const struct _MAP_ENTRY * entry = self->table[tblidx].entries + entidx;
+            MAP_CFG_SIZE_TYPE targtblidx = _MAP_INDEX(entry->hash, new_size);
+
+            if (!_MAP_INSERT_SORTED(&ret, entry, targtblidx))
+                goto ret_cleanup;
+        }
+    }
+
+    /* self cleanup */
+#  ifdef MAP_CFG_ARENA
+    _MAP_ARENA_RELEASE(&self->arena);
+#  else /* MAP_CFG_ARENA */
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < cur_size; tblidx++)
+        if (self->table[tblidx].entries != NULL)
+            MAP_CFG_FREE(self->table[tblidx].entries);
+#  endif /* MAP_CFG_ARENA */
+    MAP_CFG_FREE(self->table);
+
+    return (*self = ret), true;
+
+ret_cleanup:
+#  ifdef MAP_CFG_ARENA
+    _MAP_ARENA_RELEASE(&ret.arena);
+#  else /* MAP_CFG_ARENA */
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < new_size; tblidx++)
+        if (ret.table[tblidx].entries != NULL)
+            MAP_CFG_FREE(ret.table[tblidx].entries);
+#  endif /* MAP_CFG_ARENA */
+    MAP_CFG_FREE(ret.table);
+    return false;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Resizes a map like MAP_RESIZE(), with @a nthreads threads
+ * @param self The map
+ * @param new_size The new size for the map
+ * @param nthreads How many threads to use (only with MAP_CFG_THREADS)
+ * @returns `true` if it successfully resized the map,
+ *          `false` otherwise (and the map is left untouched)
+ *
+ * With separate chaining, the entries of the map are counted and
+ *     copied to the range of (new) entry arrays they go to, each
+ *     thread with its own range of (old) entry arrays, then every new
+ *     entry array is allocated once with the exact capacity and
+ *     filled, each thread with its own ranges of entry arrays, as
+ *     with MAP_FROM_ARRAYS(). No locks are needed, and the hashes
+ *     aren't computed again. Needs memory for a copy of the entries
+ *     while resizing, besides the new table.
+ *     With MAP_CFG_INCREMENTAL_RESIZE, a resize in progress is
+ *     finished first, and this one isn't incremental.
+ *
+ * With open addressing, it's the same as MAP_RESIZE()
+ */
+MAP_CFG_STATIC bool MAP_RESIZE_PARALLEL (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE new_size, MAP_CFG_SIZE_TYPE nthreads)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    (void) nthreads;
+    return MAP_RESIZE(self, new_size);
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->table == NULL || new_size < 3)
+        return false;
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    /* only one resize at a time */
+    if (self->old_table != NULL && !_MAP_MIGRATE_STEP(self, _MAP_SIZE_MAX))
+        return false;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+    if (self->cardinal == 0)
+        return MAP_RESIZE(self, new_size);
+
+    struct MAP_CFG_MAP ret = {0};
+    if (!MAP_WITH_SIZE(&ret, new_size))
+        return false;
+
+#  ifdef MAP_CFG_SEEDED_HASH
+    /* the entries keep their hashes */
+    ret.seed = self->seed;
+#  endif /* MAP_CFG_SEEDED_HASH */
+
+#  ifndef MAP_CFG_THREADS
+    nthreads = 1;
+#  endif /* MAP_CFG_THREADS */
+    if (nthreads == 0)
+        nthreads = 1;
+    if (nthreads > self->cardinal)
+        nthreads = self->cardinal;
+
+    struct _MAP_BUILD build = {
+        .self = &ret,
+        .old_table = self->table,
+        .old_size = self->size,
+        .n = self->cardinal,
+        .nthreads = nthreads,
+    };
+    struct _MAP_BUILD_JOB * jobs = MAP_CFG_CALLOC(nthreads, sizeof(*jobs));
+    bool ok = jobs != NULL;
+
+    for (MAP_CFG_SIZE_TYPE t = 0; ok && t < nthreads; t++)
+        jobs[t] = (struct _MAP_BUILD_JOB) { .build = &build, .id = t, .ok = true, };
+
+    ok = ok
+        && _MAP_BUILD_SPREAD(&build, jobs);
+
+    if (jobs != NULL)
+        MAP_CFG_FREE(jobs);
+
+    if (!ok) {
+        ret = MAP_FREE(ret);
+        return false;
+    }
+
+    /* the entries belong to the new table now */
+#  ifdef MAP_CFG_ARENA
+    _MAP_ARENA_RELEASE(&self->arena);
+#  else /* MAP_CFG_ARENA */
+    for (MAP_CFG_SIZE_TYPE tblidx = 0; tblidx < self->size; tblidx++)
+        if (self->table[tblidx].entries != NULL)
+            MAP_CFG_FREE(self->table[tblidx].entries);
+#  endif /* MAP_CFG_ARENA */
+    MAP_CFG_FREE(self->table);
+
+    return (*self = ret), true;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Initializes a map with a given size
+ * @param self The map
+ * @param size The size of the table (must be >= 3). With open
+ *        addressing or MAP_CFG_POW2 it is rounded up to a power of two
+ * @returns `true` if it successfully initialized the map
+ */
+MAP_CFG_STATIC bool MAP_WITH_SIZE (struct MAP_CFG_MAP * self, MAP_CFG_SIZE_TYPE size)
+{
+    if (self == NULL || size < 3)
+        return false;
+
+    *self = (struct MAP_CFG_MAP) {0};
+
+# ifdef MAP_CFG_SEEDED_HASH
+    self->seed = _MAP_SEED(self);
+# endif /* MAP_CFG_SEEDED_HASH */
+
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    size = _MAP_POW2(size);
+    return size != 0
+        && _MAP_OA_ALLOC(self, size);
+# else /* MAP_CFG_OPEN_ADDRESSING */
+#  ifdef MAP_CFG_POW2
+    size = _MAP_POW2(size);
+    if (size == 0)
+        return false;
+#  endif /* MAP_CFG_POW2 */
+
+    self->table = MAP_CFG_CALLOC(size, sizeof(*self->table));
+
+    bool ret = self->table != NULL;
+
+    if (ret)
+        self->size = size;
+
+    return ret;
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+}
+
+/**
+ * @brief Cleans and frees the map. It also frees keys and values if
+ *        MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are defined
+ * @param self The map
+ * @returns A new empty (clean) map
+ */
+MAP_CFG_STATIC struct MAP_CFG_MAP MAP_FREE (struct MAP_CFG_MAP self)
+{
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self.slots != NULL) {
+#  if defined(MAP_CFG_VALUE_DTOR) || defined(MAP_CFG_KEY_DTOR)
+        for (MAP_CFG_SIZE_TYPE i = 0; i < self.size; i++) {
+            if (!_MAP_CTRL_FULL(self.ctrl[i]))
+                continue;
+
+#   ifdef MAP_CFG_VALUE_DTOR
+            MAP_CFG_VALUE_DTOR(self.slots[i].value);
+#   endif /* MAP_CFG_VALUE_DTOR */
+
+#   ifdef MAP_CFG_KEY_DTOR
+            MAP_CFG_KEY_DTOR(self.slots[i].key);
+#   endif /* MAP_CFG_KEY_DTOR */
+        }
+#  endif /* MAP_CFG_VALUE_DTOR || MAP_CFG_KEY_DTOR */
+
+        MAP_CFG_FREE(self.slots);
+    }
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self.table != NULL)
+        _MAP_FREE_TABLE(self.table, self.size);
+
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    if (self.old_table != NULL)
+        _MAP_FREE_TABLE(self.old_table, self.old_size);
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+
+#  ifdef MAP_CFG_ARENA
+    _MAP_ARENA_RELEASE(&self.arena);
+#  endif /* MAP_CFG_ARENA */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+
+    return (struct MAP_CFG_MAP) {0};
+}
+
+/**
+ * @brief Turns a map into a frozen map, that can't be changed but
+ *        finds a key with a single slot and key comparison (see
+ *        struct MAP_FROZEN). The entries are moved: if it succeeds,
+ *        the map is left empty (and uninitialized), and the frozen map
+ *        has to be freed with MAP_FROZEN_FREE() instead
+ * @param self The map
+ * @param[out] frozen The frozen map
+ * @returns `true` if it successfully froze the map. Otherwise, the map
+ *          is left untouched
+ *
+ * There is a bucket for every 4 entries and 3% more positions than
+ *     entries, so a frozen map takes about 5 bits per entry more than
+ *     the entries themselves. Buckets are placed from the biggest to
+ *     the smallest, each with the first pilot whose positions are all
+ *     free. Keys with the same hash as another key, and buckets with no
+ *     pilot that works, go to the overflow, sorted by hash
+ */
+MAP_CFG_STATIC bool MAP_FREEZE (struct MAP_CFG_MAP * self, struct MAP_FROZEN * frozen)
+{
+    if (self == NULL || frozen == NULL)
+        return false;
+
+    MAP_CFG_SIZE_TYPE n = MAP_CARDINAL(self);
+    if (n > _MAP_SIZE_MAX - n / 32 - 1)
+        return false;
+
+    /* no array below has more than `npos` elements of these sizes */
+    size_t elem = (sizeof(struct _MAP_ENTRY) > sizeof(MAP_CFG_SIZE_TYPE)) ?
+        sizeof(struct _MAP_ENTRY):
+        sizeof(MAP_CFG_SIZE_TYPE);
+    if ((size_t) (n + n / 32 + 1) > SIZE_MAX / elem)
+        return false;
+
+    struct MAP_FROZEN ret = {
+        .nbuckets = n / 4 + 1,
+        .npos = n + n / 32 + 1,
+# ifdef MAP_CFG_SEEDED_HASH
+        .seed = self->seed,
+# endif /* MAP_CFG_SEEDED_HASH */
+    };
+
+    /* the entries grouped by bucket, and the position of each */
+    struct _MAP_ENTRY * entries = MAP_CFG_MALLOC((n + 1) * sizeof(*entries));
+    MAP_CFG_SIZE_TYPE * where = MAP_CFG_MALLOC((n + 1) * sizeof(*where));
+    MAP_CFG_SIZE_TYPE * starts = MAP_CFG_CALLOC((size_t) ret.nbuckets + 1, sizeof(*starts));
+    MAP_CFG_SIZE_TYPE * order = MAP_CFG_MALLOC(ret.nbuckets * sizeof(*order));
+    MAP_CFG_SIZE_TYPE * bysize = NULL;
+    unsigned char * taken = MAP_CFG_CALLOC(ret.npos, sizeof(*taken));
+    ret.pilots = MAP_CFG_CALLOC(ret.nbuckets, sizeof(*ret.pilots));
+
+    bool ok = entries != NULL
+        && where != NULL
+        && starts != NULL
+        && order != NULL
+        && taken != NULL
+        && ret.pilots != NULL;
+    if (!ok)
+        goto out;
+
+    /* group the entries by bucket */
+    struct MAP_CURSOR cur;
+    for (bool more = MAP_CURSOR_BEGIN(self, &cur); more; more = MAP_CURSOR_NEXT(&cur))
+        starts[_MAP_FROZEN_BUCKET(_MAP_CURSOR_ENTRY(&cur)->hash, ret.nbuckets) + 1]++;
+
+    MAP_CFG_SIZE_TYPE maxlen = 0;
+    for (MAP_CFG_SIZE_TYPE b = 0; b < ret.nbuckets; b++) {
+        if (starts[b + 1] > maxlen)
+            maxlen = starts[b + 1];
+        starts[b + 1] += starts[b];
+    }
+
+    for (bool more = MAP_CURSOR_BEGIN(self, &cur); more; more = MAP_CURSOR_NEXT(&cur)) {
+        const struct _MAP_ENTRY * entry = _MAP_CURSOR_ENTRY(&cur);
+        entries[starts[_MAP_FROZEN_BUCKET(entry->hash, ret.nbuckets)]++] = *entry;
+    }
+
+    memmove(starts + 1, starts, ret.nbuckets * sizeof(*starts));
+    starts[0] = 0;
+
+    /* sort the buckets from the biggest to the smallest */
+    bysize = MAP_CFG_CALLOC((size_t) maxlen + 2, sizeof(*bysize));
+    if (!(ok = bysize != NULL))
+        goto out;
+
+    for (MAP_CFG_SIZE_TYPE b = 0; b < ret.nbuckets; b++)
+        bysize[maxlen - (starts[b + 1] - starts[b]) + 1]++;
+    for (MAP_CFG_SIZE_TYPE l = 0; l <= maxlen; l++)
+        bysize[l + 1] += bysize[l];
+    for (MAP_CFG_SIZE_TYPE b = 0; b < ret.nbuckets; b++)
+        order[bysize[maxlen - (starts[b + 1] - starts[b])]++] = b;
+
+    /* find a pilot for every bucket */
+    for (MAP_CFG_SIZE_TYPE o = 0; o < ret.nbuckets; o++) {
+        MAP_CFG_SIZE_TYPE b = order[o];
+        struct _MAP_ENTRY * first = entries + starts[b];
+        MAP_CFG_SIZE_TYPE len = starts[b + 1] - starts[b];
+        MAP_CFG_SIZE_TYPE * bwhere = where + starts[b];
+
+        if (len == 0)
+            continue;
+
+        /* sort by hash (buckets are small), to find repeated hashes */
+        for (MAP_CFG_SIZE_TYPE i = 1; i < len; i++) {
+            struct _MAP_ENTRY tmp = first[i];
+            MAP_CFG_SIZE_TYPE j = i;
+            for (; j > 0 && first[j - 1].hash > tmp.hash; j--)
+                first[j] = first[j - 1];
+            first[j] = tmp;
+        }
+
+        bool placed = false;
+        for (unsigned long pilot = 0; !placed && pilot <= UINT16_MAX; pilot++) {
+            MAP_CFG_SIZE_TYPE i = 0;
+
+            for (; i < len; i++) {
+                if (i > 0 && first[i].hash == first[i - 1].hash) {
+                    bwhere[i] = ret.npos;
+                    continue;
+                }
 
-    if (!exists) {
-        if (!_MAP_INCREASE_CAPACITY(self, tblidx))
-            return false;
+                bwhere[i] = _MAP_FROZEN_POS(first[i].hash, (uint16_t) pilot, ret.npos);
+                if (taken[bwhere[i]])
+                    break;
+                taken[bwhere[i]] = 1;
+            }
+
+            placed = i == len;
+            if (placed) {
+                ret.pilots[b] = (uint16_t) pilot;
+            } else {
+                while (i-- > 0)
+                    if (bwhere[i] < ret.npos)
+                        taken[bwhere[i]] = 0;
+            }
+        }
 
-        /* move entries to the right */
-        unsigned len = self->table[tblidx].length;
-        if (i < len)
-            memmove(&self->table[tblidx].entries[i + 1],
-                    &self->table[tblidx].entries[i],
-                    sizeof(*self->table[tblidx].entries) * (len - i));
+        /* no luck, they all go to the overflow */
+        if (!placed)
+            for (MAP_CFG_SIZE_TYPE i = 0; i < len; i++)
+                bwhere[i] = ret.npos;
+    }
+
+    for (MAP_CFG_SIZE_TYPE i = 0; i < n; i++)
+        if (where[i] < ret.npos)
+            ret.nslots++;
+        else
+            ret.noverflow++;
 
-        self->cardinal++;
+    ret.slots = MAP_CFG_MALLOC((ret.nslots + 1) * sizeof(*ret.slots));
+    /* unused positions point to slot 0, for keys that aren't there */
+    ret.remap = MAP_CFG_CALLOC(ret.npos - ret.nslots, sizeof(*ret.remap));
+    ret.overflow = MAP_CFG_MALLOC((ret.noverflow + 1) * sizeof(*ret.overflow));
+    if (!(ok = ret.slots != NULL && ret.remap != NULL && ret.overflow != NULL))
+        goto out;
 
-        self->lc.valid = true;
-        self->lc.hash = hash;
-        self->lc.idx = i;
+    /* positions past the last slot go to the free slots */
+    for (MAP_CFG_SIZE_TYPE i = ret.nslots, free_slot = 0; i < ret.npos; i++) {
+        if (!taken[i])
+            continue;
+        while (taken[free_slot])
+            free_slot++;
+        ret.remap[i - ret.nslots] = free_slot++;
     }
 
-    self->table[tblidx].entries[i].hash = hash;
-    self->table[tblidx].entries[i].key = key;
-    self->table[tblidx].entries[i].value = value;
-    self->table[tblidx].length++;
+    for (MAP_CFG_SIZE_TYPE i = 0, o = 0; i < n; i++) {
+        if (where[i] == ret.npos)
+            ret.overflow[o++] = entries[i];
+        else if (where[i] < ret.nslots)
+            ret.slots[where[i]] = entries[i];
+        else
+            ret.slots[ret.remap[where[i] - ret.nslots]] = entries[i];
+    }
 
-    return true;
-}
+    /* so that a key that isn't there doesn't go through all of it */
+    qsort(ret.overflow, ret.noverflow, sizeof(*ret.overflow), _MAP_FROZEN_CMP);
 
-/**
- * @brief Gets the key of the iterator's current entry.
- *        The map must be iterating
- * @param self The map
- * @returns The key of the iterator's current entry
- */
-MAP_CFG_KEY_DATA_TYPE MAP_ITER_KEY (const struct MAP_CFG_MAP * self)
-{
-    assert(self->iter.ing);
-    assert(self->iter.tblidx < self->size);
-    assert(self->iter.entidx < self->table[self->iter.tblidx].length);
-    return self->table[self->iter.tblidx].entries[self->iter.entidx].key;
-}
+    /* the entries belong to the frozen map now, don't destroy them */
+# ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self->ctrl != NULL)
+        memset(self->ctrl, _MAP_CTRL_EMPTY, self->size);
+# else /* MAP_CFG_OPEN_ADDRESSING */
+    for (MAP_CFG_SIZE_TYPE i = 0; self->table != NULL && i < self->size; i++)
+        self->table[i].length = 0;
+#  ifdef MAP_CFG_INCREMENTAL_RESIZE
+    for (MAP_CFG_SIZE_TYPE i = 0; self->old_table != NULL && i < self->old_size; i++)
+        self->old_table[i].length = 0;
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
+# endif /* MAP_CFG_OPEN_ADDRESSING */
+    *self = MAP_FREE(*self);
 
-/**
- * @brief Gets the value associated with a given key
- *        The map must have been successfully initialized with
- *        MAP_NEW() or MAP_WITH_SIZE()
- * @param self The map
- * @param key The key (must be the key of an entry in the map)
- * @returns The value associated with @a key
- */
-MAP_CFG_STATIC MAP_CFG_VALUE_DATA_TYPE MAP_GET (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
-{
-    assert(self != NULL);
-    assert(self->size >= 3);
-    assert(self->table != NULL);
+out:
+    if (entries != NULL)
+        MAP_CFG_FREE(entries);
+    if (where != NULL)
+        MAP_CFG_FREE(where);
+    if (starts != NULL)
+        MAP_CFG_FREE(starts);
+    if (order != NULL)
+        MAP_CFG_FREE(order);
+    if (bysize != NULL)
+        MAP_CFG_FREE(bysize);
+    if (taken != NULL)
+        MAP_CFG_FREE(taken);
 
-    unsigned hash = MAP_CFG_HASH_FUNC(key);
-    unsigned tblidx = MAP_MOD(hash, self->size);
-    unsigned i = 0;
+    if (ok) {
+        *frozen = ret;
+    } else {
+        /* nothing was moved yet */
+        ret.nslots = 0;
+        ret.noverflow = 0;
+        MAP_FROZEN_FREE(ret);
+    }
 
-    bool exists = _MAP_SEARCH(self, key, hash, tblidx, &i);
-    assert(exists);
-    return self->table[tblidx].entries[i].value;
+    return ok;
 }
 
 /**
- * @brief Gets the value of the iterator's current entry.
- *        The map must be iterating
- * @param self The map
- * @returns The value of the iterator's current entry
+ * @brief Checks if a frozen map has an entry with key @a key
+ * @param frozen The frozen map
+ * @param key The key
+ * @returns `true` if the frozen map has an entry with key @a key
  */
-MAP_CFG_VALUE_DATA_TYPE MAP_ITER_VAL (const struct MAP_CFG_MAP * self)
+MAP_CFG_STATIC bool MAP_FROZEN_CONTAINS (const struct MAP_FROZEN * frozen, const MAP_CFG_KEY_DATA_TYPE key)
 {
-    assert(self->iter.ing);
-    assert(self->iter.tblidx < self->size);
-    assert(self->iter.entidx < self->table[self->iter.tblidx].length);
-    return self->table[self->iter.tblidx].entries[self->iter.entidx].value;
+    return _MAP_FROZEN_FIND(frozen, key) != NULL;
 }
 
 /**
- * @brief Adds or updates an entry to the map with @a key and @a value.
- *        The map must have been successfully initialized with
- *        MAP_NEW() or MAP_WITH_SIZE()
- * @param self The map
- * @param key The key
- * @param value The value
- * @returns `true` if it successfully added the entry to the map.
- *          This function fails (returns `false`) if the map isn't
- *          valid, or it wasn't possible to get space for the new entry
+ * @brief Cleans and frees a frozen map. It also frees keys and values
+ *        if MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are defined
+ * @param frozen The frozen map
+ * @returns A new empty (clean) frozen map
  */
-MAP_CFG_STATIC bool MAP_ADD (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, const MAP_CFG_VALUE_DATA_TYPE value)
+MAP_CFG_STATIC struct MAP_FROZEN MAP_FROZEN_FREE (struct MAP_FROZEN frozen)
 {
-    if (self == NULL || self->size < 3 || self->table == NULL)
-        return false;
+# if defined(MAP_CFG_VALUE_DTOR) || defined(MAP_CFG_KEY_DTOR)
+    for (MAP_CFG_SIZE_TYPE i = 0; i < frozen.nslots + frozen.noverflow; i++) {
+        const struct _MAP_ENTRY * entry = (i < frozen.nslots) ?
+            frozen.slots + i:
+            frozen.overflow + (i - frozen.nslots);
+
+#  ifdef MAP_CFG_VALUE_DTOR
+        MAP_CFG_VALUE_DTOR(entry->value);
+#  endif /* MAP_CFG_VALUE_DTOR */
+
+#  ifdef MAP_CFG_KEY_DTOR
+        MAP_CFG_KEY_DTOR(entry->key);
+#  endif /* MAP_CFG_KEY_DTOR */
+    }
+# endif /* MAP_CFG_VALUE_DTOR || MAP_CFG_KEY_DTOR */
 
-    unsigned hash = MAP_CFG_HASH_FUNC(key);
-    unsigned tblidx = MAP_MOD(hash, self->size);
+    if (frozen.pilots != NULL)
+        MAP_CFG_FREE(frozen.pilots);
+    if (frozen.slots != NULL)
+        MAP_CFG_FREE(frozen.slots);
+    if (frozen.remap != NULL)
+        MAP_CFG_FREE(frozen.remap);
+    if (frozen.overflow != NULL)
+        MAP_CFG_FREE(frozen.overflow);
 
-    return _MAP_INSERT_SORTED(self, key, value, hash, tblidx);
+    return (struct MAP_FROZEN) {0};
 }
 
+# ifndef MAP_CFG_NO_VALUE
 /**
- * @brief Checks if the map contains a given @a key
- * @param self The map
+ * @brief Gets the value of the entry with key @a key of a frozen map,
+ *        like MAP_LOOKUP()
+ * @param frozen The frozen map
  * @param key The key
- * @returns `true` if the map contains @a key
+ * @param[out] value Where to put the value (may be NULL)
+ * @returns `true` if the frozen map has an entry with key @a key
  */
-MAP_CFG_STATIC bool MAP_CONTAINS (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key)
+MAP_CFG_STATIC bool MAP_FROZEN_GET (const struct MAP_FROZEN * frozen, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value)
 {
-    if (self == NULL || self->size < 3 || self->table == NULL)
+    const struct _MAP_ENTRY * entry = _MAP_FROZEN_FIND(frozen, key);
+
+    if (entry == NULL)
         return false;
 
-    unsigned hash = MAP_CFG_HASH_FUNC(key);
-    unsigned tblidx = MAP_MOD(hash, self->size);
+    if (value != NULL)
+        *value = entry->value;
 
-    unsigned _i;
-    return _MAP_SEARCH(self, key, hash, tblidx, &_i);
+    return true;
 }
+# endif /* MAP_CFG_NO_VALUE */
 
+# ifdef MAP_CFG_NO_VALUE
 /**
- * @brief Checks if the map is empty (i.e., has no entries)
- * @param self The map
- * @returns `true` if the map is empty, `false` otherwise
+ * @brief Gets the hash of the key of an entry of @a from for @a to. It
+ *        is the hash the entry already has, unless the seeds of the
+ *        maps are different (with MAP_CFG_SEEDED_HASH)
+ * @param to The map the hash is for
+ * @param from The map of @a entry
+ * @param entry The entry
+ * @returns The hash
  */
-bool MAP_IS_EMPTY (const struct MAP_CFG_MAP * self)
+static inline MAP_CFG_HASH_TYPE _MAP_REHASH (const struct MAP_CFG_MAP * to, const struct MAP_CFG_MAP * from, const struct _MAP_ENTRY * entry)
 {
-    return MAP_CARDINAL(self) == 0;
+#  ifdef MAP_CFG_SEEDED_HASH
+    if (to->seed != from->seed)
+        return _MAP_HASH(to, entry->key);
+#  else /* MAP_CFG_SEEDED_HASH */
+    (void) to;
+    (void) from;
+#  endif /* MAP_CFG_SEEDED_HASH */
+    return entry->hash;
 }
 
 /**
- * @brief Starts iterating over the map
- * @param self The map
- * @returns `false` if the map is already iterating or is empty
+ * @brief Keeps the keys of @a self that are in another set, see
+ *        _MAP_FILTER()
+ * @param self The set
+ * @param entry An entry of @a self
+ * @param ctx The other set (NULL is the empty set)
+ * @returns Whether the key of @a entry is in the other set
  */
-bool MAP_ITER (struct MAP_CFG_MAP * self)
+static bool _MAP_KEEP_IN (const struct MAP_CFG_MAP * self, struct _MAP_ENTRY * entry, const void * ctx)
 {
-    if (self->iter.ing || MAP_IS_EMPTY(self))
-        return false;
-
-    unsigned tblidx = 0;
-    for (; tblidx < self->size && self->table[tblidx].length == 0; tblidx++)
-        ;
-
-    self->iter.ing = true;
-    self->iter.tblidx = tblidx;
-    self->iter.entidx = 0;
+    const struct MAP_CFG_MAP * other = ctx;
 
-    return true;
+    return other != NULL
+        && MAP_CONTAINS_WITH_HASH(other, entry->key, _MAP_REHASH(other, self, entry));
 }
 
 /**
- * @brief Checks if the map is iterating
- * @param self The map
- * @returns `true` if the map is iterating
+ * @brief Keeps the keys of @a self that aren't in another set, see
+ *        _MAP_FILTER()
+ * @param self The set
+ * @param entry An entry of @a self
+ * @param ctx The other set (NULL is the empty set)
+ * @returns Whether the key of @a entry isn't in the other set
  */
-bool MAP_ITERING (const struct MAP_CFG_MAP * self)
+static bool _MAP_KEEP_NOT_IN (const struct MAP_CFG_MAP * self, struct _MAP_ENTRY * entry, const void * ctx)
 {
-    return self && self->iter.ing;
+    return !_MAP_KEEP_IN(self, entry, ctx);
 }
 
+#  ifndef MAP_CFG_KEY_DTOR
 /**
- * @brief Stops iterating over the map. Has no effect if is wasn't
- *        iterating
- * @param self The map
- * @returns `true` if the map is not NULL
+ * @brief Adds every key of @a other to @a self (the union of both).
+ *        Keys already in @a self are left as they are
+ * @param self The set
+ * @param other The other set (unchanged)
+ * @returns `true` if it successfully added every key. Otherwise, some
+ *          of them may have been added. It fails if @a self isn't
+ *          valid, or it wasn't possible to get space for a new entry
+ *
+ * The keys are copied as they are, so it isn't there with
+ *     MAP_CFG_KEY_DTOR() (both sets would destroy them)
  */
-bool MAP_ITER_END (struct MAP_CFG_MAP * self)
+MAP_CFG_STATIC bool MAP_UNION (struct MAP_CFG_MAP * self, const struct MAP_CFG_MAP * other)
 {
-    return self
-        && !(self->iter.ing = false);
-}
+    struct MAP_CURSOR cur;
 
-/**
- * @brief Advances the iterator to the next entry (if any)
- * @param self The map
- * @returns `true` if the map is still iterating
- */
-bool MAP_ITER_NEXT (struct MAP_CFG_MAP * self)
-{
-    if (!MAP_ITERING(self)
-            || self->iter.tblidx >= self->size
-            || self->iter.entidx >= self->table[self->iter.tblidx].length)
+#  ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
         return false;
+#  else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return false;
+#  endif /* MAP_CFG_OPEN_ADDRESSING */
 
-    if (self->iter.entidx < self->table[self->iter.tblidx].length - 1)
-        return self->iter.entidx++, true;
+    if (self == other)
+        return true;
 
-    unsigned tblidx = 0;
-    for (; tblidx < self->size && self->table[tblidx].length == 0; tblidx++)
-        ;
+    for (bool ok = MAP_CURSOR_BEGIN(other, &cur); ok; ok = MAP_CURSOR_NEXT(&cur)) {
+        const struct _MAP_ENTRY * entry = _MAP_CURSOR_ENTRY(&cur);
+        bool inserted = false;
 
-    bool ret = tblidx < self->size;
-    if (ret) {
-        self->iter.tblidx = tblidx;
-        self->iter.entidx = 0;
+        if (_MAP_FIND_OR_INSERT(self, entry->key, _MAP_REHASH(self, other, entry), &inserted) == NULL)
+            return false;
     }
 
-    return ret;
-}
-
-/**
- * @brief Initializes a map with the default size
- * @param self The map
- * @returns `true` if it successfully initialized the map
- */
-MAP_CFG_STATIC bool MAP_NEW (struct MAP_CFG_MAP * self)
-{
-    return MAP_WITH_SIZE(self, MAP_CFG_DEFAULT_SIZE);
+    return true;
 }
+#  endif /* MAP_CFG_KEY_DTOR */
 
 /**
- * @brief Remove the entry with a given key
- * @param self The map
- * @param key The key
- * @param[out] value Where to save the value associated with @a key. If it is
- *             NULL the value is free()d.
- * @retuns `true` if there was an entry with key @a key, or `false` if there
- *         was no such entry or the map is not valid
+ * @brief Removes the keys of @a self that aren't in @a other (the
+ *        intersection of both), in a single pass over @a self
+ * @param self The set
+ * @param other The other set (unchanged)
+ * @returns `false` if @a self isn't valid, `true` otherwise
  *
- * If defined, MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are called on the
- *     entry to be removed
+ * MAP_CFG_KEY_DTOR() is called on the keys removed, if defined
  */
-MAP_CFG_STATIC bool MAP_REMOVE (struct MAP_CFG_MAP * self, const MAP_CFG_KEY_DATA_TYPE key, MAP_CFG_VALUE_DATA_TYPE * value)
+MAP_CFG_STATIC bool MAP_INTERSECTION (struct MAP_CFG_MAP * self, const struct MAP_CFG_MAP * other)
 {
-    if (self == NULL || self->size < 3 || self->table == NULL)
+#  ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
         return false;
-
-    unsigned hash = MAP_CFG_HASH_FUNC(key);
-    unsigned tblidx = MAP_MOD(hash, self->size);
-
-    unsigned i = 0;
-    bool exists = _MAP_SEARCH(self, key, hash, tblidx, &i);
-    if (!exists)
+#  else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
         return false;
+#  endif /* MAP_CFG_OPEN_ADDRESSING */
 
-#ifdef MAP_CFG_KEY_DTOR
-    MAP_CFG_KEY_DTOR(self->table[tblidx].entries[i].key);
-#endif /* MAP_CFG_KEY_DTOR */
-
-    if (value != NULL)
-        *value = self->table[tblidx].entries[i].value;
-#ifdef MAP_CFG_VALUE_DTOR
-    else
-        MAP_CFG_VALUE_DTOR(self->table[tblidx].entries[i].value);
-#endif /* MAP_CFG_VALUE_DTOR */
-
-    self->table[tblidx].length--;
-    memmove(&self->table[tblidx].entries[i],
-            &self->table[tblidx].entries[i + 1],
-            sizeof(*self->table[tblidx].entries) * (self->table[tblidx].length - i));
-
-    _MAP_DECREASE_CAPACITY(self, tblidx);
-
-    self->lc.valid = false;
-    self->cardinal--;
+    if (self != other)
+        _MAP_FILTER(self, _MAP_KEEP_IN, other);
 
     return true;
 }
 
 /**
- * @brief Resizes a map
- * @param self The map
- * @param new_size The new size for the map
- * @returns `true` if it successfully resized the map,
- *          `false` otherwise
+ * @brief Removes the keys of @a other from @a self (the difference of
+ *        both). Goes over whichever set is smaller
+ * @param self The set
+ * @param other The other set (unchanged)
+ * @returns `false` if @a self isn't valid, `true` otherwise
  *
- * Initializes a map with the requested size and tries to insert every
- *     entry of the original map into the new one. After all entries
- *     have been inserted, the original map is freed. This is not very
- *     efficient memory-wise, but reduces the risk of corrupting the
- *     original map. If any of the insertions fail, the new map is
- *     freed and the original is left untouched.
+ * MAP_CFG_KEY_DTOR() is called on the keys removed, if defined
  */
-MAP_CFG_STATIC bool MAP_RESIZE (struct MAP_CFG_MAP * self, unsigned new_size)
+MAP_CFG_STATIC bool MAP_DIFFERENCE (struct MAP_CFG_MAP * self, const struct MAP_CFG_MAP * other)
 {
-    struct MAP_CFG_MAP ret = {0};
-    if (self == NULL || !MAP_WITH_SIZE(&ret, new_size))
+#  ifdef MAP_CFG_OPEN_ADDRESSING
+    if (self == NULL || self->size < 3 || self->slots == NULL)
         return false;
+#  else /* MAP_CFG_OPEN_ADDRESSING */
+    if (self == NULL || self->size < 3 || self->table == NULL)
+        return false;
+#  endif /* MAP_CFG_OPEN_ADDRESSING */
 
-    unsigned cur_size = self->size;
-    for (unsigned tblidx = 0; tblidx < cur_size; tblidx++) {
-        unsigned length = self->table[tblidx].length;
-
-        for (unsigned entidx = 0; entidx < length; entidx++) {
-            MAP_CFG_KEY_DATA_TYPE key = self->table[tblidx].entries[entidx].key;
-            MAP_CFG_VALUE_DATA_TYPE val = self->table[tblidx].entries[entidx].value;
-            unsigned hash = self->table[tblidx].entries[entidx].hash;
-            unsigned targtblidx = MAP_MOD(hash, new_size);
-
-            if (!_MAP_INSERT_SORTED(&ret, key, val, hash, targtblidx))
-                goto ret_cleanup;
-        }
+    if (self == other) {
+        /* every key is in the set itself */
+        _MAP_FILTER(self, _MAP_KEEP_IN, NULL);
+        return true;
     }
 
-    /* self cleanup */
-    for (unsigned tblidx = 0; tblidx < cur_size; tblidx++)
-        if (self->table[tblidx].entries != NULL)
-            MAP_CFG_FREE(self->table[tblidx].entries);
-    MAP_CFG_FREE(self->table);
-
-    return (*self = ret), true;
-
-ret_cleanup:
-    for (unsigned tblidx = 0; tblidx < new_size; tblidx++)
-        if (ret.table[tblidx].entries != NULL)
-            MAP_CFG_FREE(ret.table[tblidx].entries);
-    MAP_CFG_FREE(ret.table);
-    return false;
-}
-
-/**
- * @brief Initializes a map with a given size
- * @param self The map
- * @param size The size of the table (must be >= 3)
- * @returns `true` if it successfully initialized the map
- */
-MAP_CFG_STATIC bool MAP_WITH_SIZE (struct MAP_CFG_MAP * self, unsigned size)
-{
-    if (self == NULL || size < 3)
-        return false;
+#  ifndef MAP_CFG_INCREMENTAL_RESIZE
+    /* (removing may have to move entries to the new table, and fail) */
+    if (MAP_CARDINAL(other) < self->cardinal) {
+        struct MAP_CURSOR cur;
 
-    *self = (struct MAP_CFG_MAP) {0};
-    self->table = MAP_CFG_CALLOC(size, sizeof(*self->table));
+        for (bool ok = MAP_CURSOR_BEGIN(other, &cur); ok; ok = MAP_CURSOR_NEXT(&cur)) {
+            const struct _MAP_ENTRY * entry = _MAP_CURSOR_ENTRY(&cur);
+            MAP_REMOVE_WITH_HASH(self, entry->key, _MAP_REHASH(self, other, entry));
+        }
 
-    bool ret = self->table != NULL;
+        return true;
+    }
+#  endif /* MAP_CFG_INCREMENTAL_RESIZE */
 
-    if (ret)
-        self->size = size;
+    _MAP_FILTER(self, _MAP_KEEP_NOT_IN, other);
 
-    return ret;
+    return true;
 }
+# endif /* MAP_CFG_NO_VALUE */
 
+# ifdef MAP_CFG_ROBIN_HOOD
 /**
- * @brief Cleans and frees the map. It also frees keys and values if
- *        MAP_CFG_KEY_DTOR() and MAP_CFG_VALUE_DTOR() are defined
+ * @brief Measures how many slots it takes to find each entry of the map
  * @param self The map
- * @returns A new empty (clean) map
+ * @returns The maximum and mean probe lengths (in slots, at least 1),
+ *          or all 0 if the map is empty (or invalid)
  */
-MAP_CFG_STATIC struct MAP_CFG_MAP MAP_FREE (struct MAP_CFG_MAP self)
+MAP_CFG_STATIC struct MAP_PROBE_STATS MAP_PROBE_STATS (const struct MAP_CFG_MAP * self)
 {
-    if (self.table != NULL) {
-        for (unsigned i = 0; i < self.size; i++) {
-            if (self.table[i].entries != NULL) {
-
-# if defined(MAP_CFG_VALUE_DTOR) || defined(MAP_CFG_KEY_DTOR)
-                for (unsigned j = 0; j < self.table[i].length; j++) {
-#  ifdef MAP_CFG_VALUE_DTOR
-                    MAP_CFG_VALUE_DTOR(self.table[i].entries[j].value);
-#  endif /* MAP_CFG_VALUE_DTOR */
+    struct MAP_PROBE_STATS ret = {0};
+    double total = 0;
 
-#  ifdef MAP_CFG_KEY_DTOR
-                    MAP_CFG_KEY_DTOR(self.table[i].entries[j].key);
-#  endif /* MAP_CFG_KEY_DTOR */
-                }
-# endif /* MAP_CFG_VALUE_DTOR || MAP_CFG_KEY_DTOR */
+    if (self == NULL || self->slots == NULL || self->cardinal == 0)
+        return ret;
 
-                MAP_CFG_FREE(self.table[i].entries);
-            }
-        }
+    for (MAP_CFG_SIZE_TYPE i = 0; i < self->size; i++) {
+        if (!_MAP_CTRL_FULL(self->ctrl[i]))
+            continue;
 
-        MAP_CFG_FREE(self.table);
+        MAP_CFG_SIZE_TYPE len = _MAP_OA_DIST(self, i) + 1;
+        if (len > ret.max)
+            ret.max = len;
+        total += (double) len;
     }
 
-    return (struct MAP_CFG_MAP) {0};
+    ret.mean = total / (double) self->cardinal;
+    return ret;
 }
+# endif /* MAP_CFG_ROBIN_HOOD */
 
 /**
  * @brief Calculates the cardinal (number of entries) in the map
  * @param self The map
  * @returns The number of entries in the map
  */
-unsigned MAP_CARDINAL (const struct MAP_CFG_MAP * self)
+MAP_CFG_SIZE_TYPE MAP_CARDINAL (const struct MAP_CFG_MAP * self)
 {
     return (self) ? self->cardinal : 0;
 }
@@ -794,22 +5156,115 @@ unsigned MAP_CARDINAL (const struct MAP_CFG_MAP * self)
 /*
  * Functions
  */
+#undef _MAP_ARENA_ALLOC
+#undef _MAP_ARENA_CHUNK
+#undef _MAP_ARENA_CLASS
+#undef _MAP_ARENA_FREE
+#undef _MAP_ARENA_RELEASE
+#undef _MAP_BUCKET_SEARCH
+#undef _MAP_BUILD
+#undef _MAP_BUILD_AT
+#undef _MAP_BUILD_CHUNK
+#undef _MAP_BUILD_COUNT
+#undef _MAP_BUILD_FILL
+#undef _MAP_BUILD_HASH
+#undef _MAP_BUILD_JOB
+#undef _MAP_BUILD_MOVE
+#undef _MAP_BUILD_PART
+#undef _MAP_BUILD_RUN
+#undef _MAP_BUILD_SCATTER
+#undef _MAP_BUILD_SPREAD
+#undef _MAP_CHANGE_CAPACITY
+#undef _MAP_CTZ
+#undef _MAP_CURSOR_BUCKET
+#undef _MAP_CURSOR_ENTRY
+#undef _MAP_CURSOR_PART
+#undef _MAP_CURSOR_SEEK
 #undef _MAP_DECREASE_CAPACITY
 #undef _MAP_ENTRY_CMP
+#undef _MAP_FILTER
+#undef _MAP_FILTER_BUCKET
+#undef _MAP_FIB
+#undef _MAP_FIND
+#undef _MAP_FIND_OR_INSERT
+#undef _MAP_FREE_TABLE
+#undef _MAP_FROZEN_BUCKET
+#undef _MAP_FROZEN_CMP
+#undef _MAP_FROZEN_FIND
+#undef _MAP_FROZEN_POS
+#undef _MAP_GROUP_FREE
+#undef _MAP_GROUP_MATCH
+#undef _MAP_GROW
+#undef _MAP_H2
+#undef _MAP_HASH_KEY
+#undef _MAP_IMAGE_ALIGN
+#undef _MAP_IMAGE_FIND
+#undef _MAP_IMAGE_HEADER
+#undef _MAP_IMAGE_MAGIC
+#undef _MAP_IMAGE_ORDER
+#undef _MAP_IMAGE_SEEDED
+#undef _MAP_IMAGE_VALUE_SIZE
 #undef _MAP_INCREASE_CAPACITY
+#undef _MAP_INDEX
+#undef _MAP_INSERT_AT
 #undef _MAP_INSERT_SORTED
+#undef _MAP_KEEP_IN
+#undef _MAP_KEEP_NOT_IN
+#undef _MAP_KEEP_PRED
+#undef _MAP_LOAD_LIMIT
+#undef _MAP_LOOKUP_MANY
+#undef _MAP_MIGRATE
+#undef _MAP_MIGRATE_BUCKET
+#undef _MAP_MIGRATE_STEP
+#undef _MAP_MIX64
+#undef _MAP_OA_ALLOC
+#undef _MAP_OA_DIST
+#undef _MAP_OA_ERASE
+#undef _MAP_OA_GROW
+#undef _MAP_OA_MAKE_ROOM
+#undef _MAP_OA_REHASH
+#undef _MAP_OA_SEARCH
+#undef _MAP_POW2
+#undef _MAP_REHASH
+#undef _MAP_RETAIN
 #undef _MAP_SEARCH
+#undef _MAP_SEED
+#undef _MAP_SIZE_FOR
 
 /*
  * Other
  */
+#undef MAP_CFG_ARENA_CHUNK
+#undef MAP_CFG_BATCH
+#undef MAP_CFG_BUCKET_GROW
+#undef MAP_CFG_BUCKET_SHRINK
 #undef MAP_CFG_CALLOC
 #undef MAP_CFG_DEFAULT_SIZE
 #undef MAP_CFG_FREE
+#undef MAP_CFG_HASH_BYTES
 #undef MAP_CFG_HASH_FUNC
+#undef MAP_CFG_HASH_INT
+#undef MAP_CFG_HASH_PTR
+#undef MAP_CFG_HASH_STR
 #undef MAP_CFG_MALLOC
+#undef MAP_CFG_MAX_LOAD
+#undef MAP_CFG_NO_SIMD
+#undef MAP_CFG_POW2
+#undef MAP_CFG_POW2_MASK
 #undef MAP_CFG_REALLOC
+#undef MAP_CFG_RESIZE_STEP
+#undef MAP_CFG_SEED_FUNC
 #undef MAP_CFG_STATIC
+#undef MAP_CFG_THREADS
+#undef _MAP_CTRL_DELETED
+#undef _MAP_ARENA_HEADER
+#undef _MAP_CTRL_EMPTY
+#undef _MAP_CTRL_FULL
+#undef _MAP_GROUP_WIDTH
+#undef _MAP_HASH
+#undef _MAP_HASH_BUILTIN
+#undef _MAP_PREFETCH
+#undef _MAP_SIZE_MAX
 
 #endif /* MAP_CFG_IMPLEMENTATION */
 
@@ -821,10 +5276,40 @@ unsigned MAP_CARDINAL (const struct MAP_CFG_MAP * self)
  * Functions
  */
 #undef MAP_ADD
+#undef MAP_ADD_WITH_HASH
 #undef MAP_CARDINAL
 #undef MAP_CONTAINS
+#undef MAP_CONTAINS_LC
+#undef MAP_CONTAINS_MANY
+#undef MAP_CONTAINS_WITH_HASH
+#undef MAP_CURSOR_BEGIN
+#undef MAP_CURSOR_KEY
+#undef MAP_CURSOR_NEXT
+#undef MAP_CURSOR_SPLIT
+#undef MAP_CURSOR_VALID
+#undef MAP_CURSOR_VALUE
+#undef MAP_DIFFERENCE
+#undef MAP_ENTRY
+#undef MAP_ENTRY_WITH_HASH
 #undef MAP_FREE
+#undef MAP_FREEZE
+#undef MAP_FROM_ARRAYS
+#undef MAP_FROZEN_CONTAINS
+#undef MAP_FROZEN_FREE
+#undef MAP_FROZEN_GET
 #undef MAP_GET
+#undef MAP_GET_LC
+#undef MAP_GET_MANY
+#undef MAP_GET_PTR
+#undef MAP_GET_PTR_WITH_HASH
+#undef MAP_GET_WITH_HASH
+#undef MAP_HASH
+#undef MAP_IMAGE_CLOSE
+#undef MAP_IMAGE_CONTAINS
+#undef MAP_IMAGE_GET
+#undef MAP_IMAGE_OPEN
+#undef MAP_IMAGE_WRITE
+#undef MAP_INTERSECTION
 #undef MAP_IS_EMPTY
 #undef MAP_ITER
 #undef MAP_ITERING
@@ -832,20 +5317,51 @@ unsigned MAP_CARDINAL (const struct MAP_CFG_MAP * self)
 #undef MAP_ITER_KEY
 #undef MAP_ITER_NEXT
 #undef MAP_ITER_VAL
+#undef MAP_LOOKUP
+#undef MAP_LOOKUP_WITH_HASH
 #undef MAP_NEW
+#undef MAP_PROBE_STATS
 #undef MAP_REMOVE
+#undef MAP_REMOVE_WITH_HASH
+#undef MAP_RESERVE
 #undef MAP_RESIZE
+#undef MAP_RESIZE_PARALLEL
+#undef MAP_RETAIN
+#undef MAP_UNION
+#undef MAP_UPSERT
+#undef MAP_UPSERT_WITH_HASH
 #undef MAP_WITH_SIZE
 
+/*
+ * Types
+ */
+#undef MAP_CURSOR
+#undef MAP_FROZEN
+#undef MAP_IMAGE
+#undef MAP_LC
+#undef _MAP_ARENA
+#undef _MAP_BUCKET
+#undef _MAP_ENTRY
+
 /*
  * Other
  */
+#undef MAP_CFG_64BIT
+#undef MAP_CFG_ARENA
 #undef MAP_CFG_CONCAT
+#undef MAP_CFG_HASH_TYPE
+#undef MAP_CFG_IMAGE
+#undef MAP_CFG_INCREMENTAL_RESIZE
 #undef MAP_CFG_KEY_DATA_TYPE
 #undef MAP_CFG_MAKE_STR
 #undef MAP_CFG_MAKE_STR1
 #undef MAP_CFG_MAP
+#undef MAP_CFG_NO_VALUE
+#undef MAP_CFG_OPEN_ADDRESSING
 #undef MAP_CFG_PREFIX
+#undef MAP_CFG_ROBIN_HOOD
+#undef MAP_CFG_SEEDED_HASH
+#undef MAP_CFG_SIZE_TYPE
 #undef MAP_CFG_VALUE_DATA_TYPE
 
 /*==========================================================
@@ -0,0 +1,554 @@
+/* rcumap - v2026.10.17-0
+ *
+ * A read-mostly Hash Map type, built on top of `map.h`: readers look up
+ * an immutable map through an atomic pointer, without locks and without
+ * writing to any memory shared with other threads. A writer builds a
+ * whole new map and publishes it, and the previous one is freed once
+ * every reader that could still be using it is done (RCU style)
+ *
+ * The most up to date version of this file can be found at
+ * `include/utils/rcumap.h` on [siiky/c-utils](https://github.com/siiky/c-utils)
+ * A concurrent usage example can be found at `examples/rcumap` on the
+ * link above
+ *
+ * # Usage
+ *
+ * The map type has to be created with `map.h` first, then the rcumap
+ * type is created on top of it, with the same key and value types.
+ * Every reader thread uses its own reader slot, a number between 0 and
+ * RCUMAP_CFG_READERS - 1. Link with `-pthread`.
+ */
+
+# if 0
+static unsigned hash_func (unsigned key)
+{
+    return key;
+}
+
+static int cmp_func (unsigned a, unsigned b)
+{
+    return (a < b) ? -1 : (a > b);
+}
+
+#define MAP_CFG_MAP table
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_HASH_FUNC hash_func
+#define MAP_CFG_KEY_CMP cmp_func
+#define MAP_CFG_IMPLEMENTATION
+#include <utils/map.h>
+
+// Must be the struct identifier of the map above
+#define RCUMAP_CFG_MAP table
+#define RCUMAP_CFG_KEY_DATA_TYPE unsigned
+#define RCUMAP_CFG_VALUE_DATA_TYPE unsigned
+#define RCUMAP_CFG_IMPLEMENTATION
+#include <utils/rcumap.h>
+
+int main (void)
+{
+    struct rcumap rcumap = {0};
+    struct table next = {0};
+    unsigned value = 0;
+
+    if (!rcumap_new(&rcumap))
+        return 1;
+
+    // Writer: build the next version and publish it
+    if (table_new(&next) && table_add(&next, 1, 2))
+        if (!rcumap_publish(&rcumap, next))
+            next = table_free(next);
+
+    // Reader (using reader slot 0): never blocks
+    rcumap_get(&rcumap, 0, 1, &value);
+
+    rcumap = rcumap_free(rcumap);
+
+    return 0;
+}
+# endif /* EXAMPLE */
+
+/*
+ * <stdatomic.h>
+ *  atomic_ulong
+ *  _Atomic
+ *
+ * <stdbool.h>
+ *  bool
+ *  false
+ *  true
+ *
+ * <pthread.h>
+ *  pthread_mutex_t
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+/*
+ * Magic from `sort.h`
+ */
+# define RCUMAP_CFG_CONCAT(A, B)    A ## B
+# define RCUMAP_CFG_MAKE_STR1(A, B) RCUMAP_CFG_CONCAT(A, B)
+# define RCUMAP_CFG_MAKE_STR(A)     RCUMAP_CFG_MAKE_STR1(RCUMAP_CFG_PREFIX, A)
+# define RCUMAP_CFG_MAKE_MAP_STR(A) RCUMAP_CFG_MAKE_STR1(RCUMAP_CFG_MAP_PREFIX, A)
+
+/*
+ * Struct identifier of the published map type, created with `map.h`
+ */
+# ifndef RCUMAP_CFG_MAP
+#  error "Must define RCUMAP_CFG_MAP"
+# endif /* RCUMAP_CFG_MAP */
+
+/*
+ * Type of the keys for the map to hold (same as the map's)
+ */
+# ifndef RCUMAP_CFG_KEY_DATA_TYPE
+#  error "Must define RCUMAP_CFG_KEY_DATA_TYPE"
+# endif /* RCUMAP_CFG_KEY_DATA_TYPE */
+
+/*
+ * Type of the values for the map to hold (same as the map's)
+ */
+# ifndef RCUMAP_CFG_VALUE_DATA_TYPE
+#  error "Must define RCUMAP_CFG_VALUE_DATA_TYPE"
+# endif /* RCUMAP_CFG_VALUE_DATA_TYPE */
+
+/*
+ * Prefix of the functions of the published map type, if it was
+ * overwritten with MAP_CFG_PREFIX
+ */
+# ifndef RCUMAP_CFG_MAP_PREFIX
+#  define RCUMAP_CFG_MAP_PREFIX RCUMAP_CFG_MAKE_STR1(RCUMAP_CFG_MAP, _)
+# endif /* RCUMAP_CFG_MAP_PREFIX */
+
+/*
+ * If the map name wasn't overwritten and the prefix wasn't
+ * defined, the map name defaults to `rcumap`
+ */
+# ifndef RCUMAP_CFG_RCUMAP
+#  define RCUMAP_CFG_RCUMAP rcumap
+# endif /* RCUMAP_CFG_RCUMAP */
+
+/*
+ * If no prefix was defined, default to `rcumap_`
+ */
+# ifndef RCUMAP_CFG_PREFIX
+#  define RCUMAP_CFG_PREFIX RCUMAP_CFG_MAKE_STR1(RCUMAP_CFG_RCUMAP, _)
+# endif /* RCUMAP_CFG_PREFIX */
+
+/*
+ * Number of reader slots, i.e., the maximum number of threads that can
+ * read at the same time. Writers check every slot before freeing a map,
+ * so don't make it much bigger than needed
+ */
+# ifndef RCUMAP_CFG_READERS
+#  define RCUMAP_CFG_READERS 64
+# endif /* RCUMAP_CFG_READERS */
+
+/*
+ * Size of a cache line. Every reader slot is on its own cache line, so
+ * readers don't slow each other down
+ */
+# ifndef RCUMAP_CFG_CACHE_LINE
+#  define RCUMAP_CFG_CACHE_LINE 64
+# endif /* RCUMAP_CFG_CACHE_LINE */
+
+/*
+ * Internal types
+ */
+# define _RCUMAP_READER RCUMAP_CFG_MAKE_STR(_reader)
+
+/**
+ * @brief A reader slot
+ */
+struct _RCUMAP_READER {
+    /** The epoch in which the reader started reading, or 0 if it isn't */
+    _Alignas(RCUMAP_CFG_CACHE_LINE) atomic_ulong epoch;
+};
+
+/**
+ * @brief The map type
+ */
+struct RCUMAP_CFG_RCUMAP {
+    /** The published map (NULL if none has been published yet) */
+    _Atomic(struct RCUMAP_CFG_MAP *) map;
+
+    /** Current epoch, incremented by every publication (starts at 1) */
+    atomic_ulong epoch;
+
+    /** The reader slots, RCUMAP_CFG_READERS of them */
+    struct _RCUMAP_READER * readers;
+
+    /** Serializes writers */
+    pthread_mutex_t lock;
+};
+
+/*==========================================================
+ * Function names
+ *=========================================================*/
+#define RCUMAP_CONTAINS   RCUMAP_CFG_MAKE_STR(contains)
+#define RCUMAP_FREE       RCUMAP_CFG_MAKE_STR(free)
+#define RCUMAP_GET        RCUMAP_CFG_MAKE_STR(get)
+#define RCUMAP_NEW        RCUMAP_CFG_MAKE_STR(new)
+#define RCUMAP_PUBLISH    RCUMAP_CFG_MAKE_STR(publish)
+#define RCUMAP_READ_BEGIN RCUMAP_CFG_MAKE_STR(read_begin)
+#define RCUMAP_READ_END   RCUMAP_CFG_MAKE_STR(read_end)
+
+/*==========================================================
+ * Function prototypes
+ *==========================================================*/
+bool                          RCUMAP_CONTAINS   (struct RCUMAP_CFG_RCUMAP * self, unsigned reader, const RCUMAP_CFG_KEY_DATA_TYPE key);
+bool                          RCUMAP_GET        (struct RCUMAP_CFG_RCUMAP * self, unsigned reader, const RCUMAP_CFG_KEY_DATA_TYPE key, RCUMAP_CFG_VALUE_DATA_TYPE * value);
+bool                          RCUMAP_NEW        (struct RCUMAP_CFG_RCUMAP * self);
+bool                          RCUMAP_PUBLISH    (struct RCUMAP_CFG_RCUMAP * self, struct RCUMAP_CFG_MAP map);
+const struct RCUMAP_CFG_MAP * RCUMAP_READ_BEGIN (struct RCUMAP_CFG_RCUMAP * self, unsigned reader);
+struct RCUMAP_CFG_RCUMAP      RCUMAP_FREE       (struct RCUMAP_CFG_RCUMAP self);
+void                          RCUMAP_READ_END   (struct RCUMAP_CFG_RCUMAP * self, unsigned reader);
+
+#ifdef RCUMAP_CFG_IMPLEMENTATION
+
+#define _RCUMAP_SYNCHRONIZE RCUMAP_CFG_MAKE_STR(_synchronize)
+
+/*
+ * Functions of the published map type
+ */
+#define _RCUMAP_MAP_FREE   RCUMAP_CFG_MAKE_MAP_STR(free)
+#define _RCUMAP_MAP_LOOKUP RCUMAP_CFG_MAKE_MAP_STR(lookup)
+
+# ifdef RCUMAP_CFG_STATIC
+#  undef RCUMAP_CFG_STATIC
+#  define RCUMAP_CFG_STATIC static
+# else /* RCUMAP_CFG_STATIC */
+#  undef RCUMAP_CFG_STATIC
+#  define RCUMAP_CFG_STATIC
+# endif /* RCUMAP_CFG_STATIC */
+
+/*
+ * <assert.h>
+ *  assert()
+ *
+ * <sched.h>
+ *  sched_yield()
+ *
+ * <stdlib.h>
+ *  aligned_alloc()
+ *  free()
+ *  malloc()
+ */
+#include <assert.h>
+#include <sched.h>
+#include <stdlib.h>
+
+# ifndef RCUMAP_CFG_MALLOC
+#  define RCUMAP_CFG_MALLOC malloc
+# endif /* RCUMAP_CFG_MALLOC */
+
+/*
+ * The reader slots have to be aligned to RCUMAP_CFG_CACHE_LINE, which
+ * malloc() doesn't guarantee
+ */
+# ifndef RCUMAP_CFG_ALIGNED_ALLOC
+#  define RCUMAP_CFG_ALIGNED_ALLOC aligned_alloc
+# endif /* RCUMAP_CFG_ALIGNED_ALLOC */
+
+# ifndef RCUMAP_CFG_FREE
+#  define RCUMAP_CFG_FREE free
+# endif /* RCUMAP_CFG_FREE */
+
+/*==========================================================
+ * Function definitions
+ *=========================================================*/
+
+/**
+ * @brief Waits for every reader that started before epoch @a epoch to
+ *        finish reading
+ * @param self The map
+ * @param epoch The epoch
+ *
+ * A reader stores the epoch in its slot before loading the map pointer,
+ *     and a writer swaps the map pointer before calling this, both with
+ *     sequentially consistent atomics. So a reader either loads the new
+ *     map, or its slot is seen here with an older epoch
+ */
+static void _RCUMAP_SYNCHRONIZE (struct RCUMAP_CFG_RCUMAP * self, unsigned long epoch)
+{
+    for (unsigned i = 0; i < RCUMAP_CFG_READERS; i++) {
+        for (;;) {
+            unsigned long e = atomic_load(&self->readers[i].epoch);
+            if (e == 0 || e >= epoch)
+                break;
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief Checks if the published map contains a given @a key
+ * @param self The map
+ * @param reader The reader slot of the calling thread
+ * @param key The key
+ * @returns `true` if the published map contains @a key
+ */
+RCUMAP_CFG_STATIC bool RCUMAP_CONTAINS (struct RCUMAP_CFG_RCUMAP * self, unsigned reader, const RCUMAP_CFG_KEY_DATA_TYPE key)
+{
+    return RCUMAP_GET(self, reader, key, NULL);
+}
+
+/**
+ * @brief Gets the value associated with a given key in the published
+ *        map, if there is one. Never blocks
+ * @param self The map
+ * @param reader The reader slot of the calling thread
+ * @param key The key
+ * @param[out] value Where to put the value. Left untouched if there's
+ *             no entry with @a key. May be NULL. If the value owns
+ *             memory (e.g., a pointer, freed by MAP_CFG_VALUE_DTOR()),
+ *             use RCUMAP_READ_BEGIN() instead, this copy may be freed
+ *             as soon as this function returns
+ * @returns `true` if there's an entry with @a key
+ */
+RCUMAP_CFG_STATIC bool RCUMAP_GET (struct RCUMAP_CFG_RCUMAP * self, unsigned reader, const RCUMAP_CFG_KEY_DATA_TYPE key, RCUMAP_CFG_VALUE_DATA_TYPE * value)
+{
+    const struct RCUMAP_CFG_MAP * map = RCUMAP_READ_BEGIN(self, reader);
+
+    if (map == NULL)
+        return false;
+
+    bool ret = _RCUMAP_MAP_LOOKUP(map, key, value);
+    RCUMAP_READ_END(self, reader);
+
+    return ret;
+}
+
+/**
+ * @brief Initializes a map, with no published map
+ * @param self The map
+ * @returns `true` if it successfully initialized the map
+ *
+ * Not thread safe: no other function may use the map before this one
+ *     returns
+ */
+RCUMAP_CFG_STATIC bool RCUMAP_NEW (struct RCUMAP_CFG_RCUMAP * self)
+{
+    if (self == NULL)
+        return false;
+
+    struct _RCUMAP_READER * readers = RCUMAP_CFG_ALIGNED_ALLOC(RCUMAP_CFG_CACHE_LINE, RCUMAP_CFG_READERS * sizeof(*readers));
+
+    if (readers == NULL)
+        return false;
+
+    if (pthread_mutex_init(&self->lock, NULL) != 0) {
+        RCUMAP_CFG_FREE(readers);
+        return false;
+    }
+
+    for (unsigned i = 0; i < RCUMAP_CFG_READERS; i++)
+        atomic_init(&readers[i].epoch, 0);
+
+    atomic_init(&self->map, NULL);
+    atomic_init(&self->epoch, 1);
+    self->readers = readers;
+
+    return true;
+}
+
+/**
+ * @brief Publishes a new version of the map. Readers that start after
+ *        this see only @a map, and the previous version is freed (with
+ *        MAP_FREE()) once the readers that may still be using it are
+ *        done
+ * @param self The map
+ * @param map The new version. Belongs to @a self if this function
+ *        succeeds, and must not be used or changed afterwards
+ * @returns `true` if it successfully published @a map
+ *
+ * Blocks until every reader that started before @a map was published
+ *     finishes reading. Other writers wait for this one
+ */
+RCUMAP_CFG_STATIC bool RCUMAP_PUBLISH (struct RCUMAP_CFG_RCUMAP * self, struct RCUMAP_CFG_MAP map)
+{
+    if (self == NULL || self->readers == NULL)
+        return false;
+
+    struct RCUMAP_CFG_MAP * next = RCUMAP_CFG_MALLOC(sizeof(*next));
+
+    if (next == NULL)
+        return false;
+
+    *next = map;
+
+    pthread_mutex_lock(&self->lock);
+    struct RCUMAP_CFG_MAP * prev = atomic_exchange(&self->map, next);
+    unsigned long epoch = atomic_fetch_add(&self->epoch, 1) + 1;
+
+    if (prev != NULL) {
+        _RCUMAP_SYNCHRONIZE(self, epoch);
+        *prev = _RCUMAP_MAP_FREE(*prev);
+        RCUMAP_CFG_FREE(prev);
+    }
+    pthread_mutex_unlock(&self->lock);
+
+    return true;
+}
+
+/**
+ * @brief Starts reading the published map. Never blocks
+ * @param self The map
+ * @param reader The reader slot of the calling thread
+ * @returns The published map (NULL if none has been published yet),
+ *          which can be looked up with MAP_LOOKUP(), and stays valid
+ *          until RCUMAP_READ_END() is called. If not NULL,
+ *          RCUMAP_READ_END() must be called, and the same thread must
+ *          not call RCUMAP_READ_BEGIN() again before that
+ */
+RCUMAP_CFG_STATIC const struct RCUMAP_CFG_MAP * RCUMAP_READ_BEGIN (struct RCUMAP_CFG_RCUMAP * self, unsigned reader)
+{
+    if (self == NULL || self->readers == NULL)
+        return NULL;
+
+    assert(reader < RCUMAP_CFG_READERS);
+
+    struct _RCUMAP_READER * slot = self->readers + reader;
+
+    atomic_store(&slot->epoch, atomic_load(&self->epoch));
+    const struct RCUMAP_CFG_MAP * ret = atomic_load(&self->map);
+
+    if (ret == NULL)
+        atomic_store_explicit(&slot->epoch, 0, memory_order_release);
+
+    return ret;
+}
+
+/**
+ * @brief Stops reading the published map. The pointer returned by
+ *        RCUMAP_READ_BEGIN() must not be used afterwards
+ * @param self The map
+ * @param reader The reader slot of the calling thread
+ */
+RCUMAP_CFG_STATIC void RCUMAP_READ_END (struct RCUMAP_CFG_RCUMAP * self, unsigned reader)
+{
+    if (self == NULL || self->readers == NULL)
+        return;
+
+    assert(reader < RCUMAP_CFG_READERS);
+
+    atomic_store_explicit(&self->readers[reader].epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief Cleans and frees the map, including the published map
+ * @param self The map
+ * @returns A new empty (clean) map
+ *
+ * Not thread safe: no other function may be using the map
+ */
+RCUMAP_CFG_STATIC struct RCUMAP_CFG_RCUMAP RCUMAP_FREE (struct RCUMAP_CFG_RCUMAP self)
+{
+    if (self.readers != NULL) {
+        struct RCUMAP_CFG_MAP * map = atomic_load(&self.map);
+
+        if (map != NULL) {
+            *map = _RCUMAP_MAP_FREE(*map);
+            RCUMAP_CFG_FREE(map);
+        }
+
+        pthread_mutex_destroy(&self.lock);
+        RCUMAP_CFG_FREE(self.readers);
+    }
+
+    return (struct RCUMAP_CFG_RCUMAP) {0};
+}
+
+/*==========================================================
+ * Implementation clean up
+ *=========================================================*/
+
+/*
+ * Functions
+ */
+#undef _RCUMAP_SYNCHRONIZE
+
+/*
+ * Functions of the published map
+ */
+#undef _RCUMAP_MAP_FREE
+#undef _RCUMAP_MAP_LOOKUP
+
+/*
+ * Other
+ */
+#undef RCUMAP_CFG_ALIGNED_ALLOC
+#undef RCUMAP_CFG_FREE
+#undef RCUMAP_CFG_MALLOC
+#undef RCUMAP_CFG_STATIC
+
+#endif /* RCUMAP_CFG_IMPLEMENTATION */
+
+/*==========================================================
+ * Header clean up
+ *=========================================================*/
+
+/*
+ * Functions
+ */
+#undef RCUMAP_CONTAINS
+#undef RCUMAP_FREE
+#undef RCUMAP_GET
+#undef RCUMAP_NEW
+#undef RCUMAP_PUBLISH
+#undef RCUMAP_READ_BEGIN
+#undef RCUMAP_READ_END
+
+/*
+ * Types
+ */
+#undef _RCUMAP_READER
+
+/*
+ * Other
+ */
+#undef RCUMAP_CFG_CACHE_LINE
+#undef RCUMAP_CFG_CONCAT
+#undef RCUMAP_CFG_KEY_DATA_TYPE
+#undef RCUMAP_CFG_MAKE_MAP_STR
+#undef RCUMAP_CFG_MAKE_STR
+#undef RCUMAP_CFG_MAKE_STR1
+#undef RCUMAP_CFG_MAP
+#undef RCUMAP_CFG_MAP_PREFIX
+#undef RCUMAP_CFG_PREFIX
+#undef RCUMAP_CFG_RCUMAP
+#undef RCUMAP_CFG_READERS
+#undef RCUMAP_CFG_VALUE_DATA_TYPE
+
+/*==========================================================
+ * License
+ *==========================================================
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
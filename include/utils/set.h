@@ -0,0 +1,118 @@
+/* set - v2026.10.18-0
+ *
+ * A Hash Set type, made with `map.h`: a map whose entries have no value
+ * (MAP_CFG_NO_VALUE), so each one takes only the memory of its key and
+ * of its hash, instead of a (padded) dummy value as well. Hashing,
+ * lookups, insertions and removals are the map's, and MAP_UNION(),
+ * MAP_INTERSECTION() and MAP_DIFFERENCE() change a set in place.
+ *
+ * The most up to date version of this file can be found at
+ * `include/utils/set.h` on [siiky/c-utils](https://github.com/siiky/c-utils)
+ * More usage examples can be found at `examples/set` on the link above
+ *
+ * # Usage
+ *
+ * A set is configured with the same `MAP_CFG_*` macros as a map (but
+ * the ones about values), see `map.h`. The struct identifier defaults
+ * to `set` instead, and the prefix to `set_`.
+ */
+
+# if 0
+static unsigned hash_func (unsigned key)
+{
+    return key;
+}
+
+static int cmp_func (unsigned a, unsigned b)
+{
+    return (a < b) ? -1 : (a > b);
+}
+
+#define MAP_CFG_KEY_DATA_TYPE unsigned
+#define MAP_CFG_HASH_FUNC hash_func
+#define MAP_CFG_KEY_CMP cmp_func
+
+// Optionally, define the struct identifier (defaults to `set`) and a
+// prefix for the generated functions (defaults to `MAP_CFG_MAP_`)
+//#define MAP_CFG_MAP my_set
+//#define MAP_CFG_PREFIX my_
+
+#define MAP_CFG_IMPLEMENTATION
+#include <utils/set.h>
+
+int main (void)
+{
+    struct set a = {0};
+    struct set b = {0};
+
+    if (!set_new(&a) || !set_new(&b))
+        return 1;
+
+    set_add(&a, 1);
+    set_add(&a, 2);
+    set_add(&b, 2);
+
+    // a = {1, 2} \ {2} = {1}
+    set_difference(&a, &b);
+    if (set_contains(&a, 2))
+        set_remove(&a, 2);
+
+    a = set_free(a);
+    b = set_free(b);
+
+    return 0;
+}
+# endif /* EXAMPLE */
+
+/*
+ * If the set name wasn't overwritten and the prefix wasn't
+ * defined, the set name defaults to `set`
+ */
+# ifndef MAP_CFG_MAP
+#  define MAP_CFG_MAP set
+# endif /* MAP_CFG_MAP */
+
+# define MAP_CFG_NO_VALUE
+
+/*
+ * "map.h"
+ *  struct MAP_CFG_MAP
+ *  MAP_ADD()
+ *  MAP_CONTAINS()
+ *  MAP_DIFFERENCE()
+ *  MAP_INTERSECTION()
+ *  MAP_REMOVE()
+ *  MAP_UNION() (not with MAP_CFG_KEY_DTOR)
+ *  ...
+ */
+# include "map.h"
+
+/*==========================================================
+ * License
+ *==========================================================
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org/>
+ */
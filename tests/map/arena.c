@@ -0,0 +1,153 @@
+#define MAP_CFG_MAP qc_arena_map
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_ARENA
+/* small chunks, so the maps of the tests take a few of them */
+#define MAP_CFG_ARENA_CHUNK 256
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(arena, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(arena, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_ARENA_THREADS 4
+
+/*
+ * Checks that @a other has exactly the keys of @a map, the even ones
+ * with value `key / 2`, and the odd ones only if @a odd
+ */
+static bool qc_arena_map_eq (const struct map * map, struct qc_arena_map * other, bool odd)
+{
+    unsigned cardinal = 0;
+    bool ret = true;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+
+            if (key % 2 == 0 || odd) {
+                const int * value = qc_arena_map_get_ptr(other, key);
+                ret = value != NULL
+                    && *value == key / 2;
+                cardinal++;
+            } else {
+                ret = !qc_arena_map_contains(other, key);
+            }
+        }
+
+    return ret && qc_arena_map_cardinal(other) == cardinal;
+}
+
+/*
+ * Adds the keys of @a map, removes the odd ones, and resizes the map,
+ * so that entry arrays grow, shrink and go back to the free lists
+ */
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_arena_map other = {0};
+    bool ret = qc_arena_map_with_size(&other, 3);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = qc_arena_map_add(&other, key, key / 2);
+        }
+
+    if (!ret) {
+        other = qc_arena_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    ret = qc_arena_map_eq(map, &other, true);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (key % 2 != 0)
+                ret = qc_arena_map_remove(&other, key, NULL);
+        }
+
+    unsigned new_size = (unsigned) theft_random_choice(t, 125) + 3;
+    ret = ret
+        && qc_arena_map_eq(map, &other, false)
+        && qc_arena_map_resize(&other, new_size)
+        && qc_arena_map_eq(map, &other, false);
+
+    other = qc_arena_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Builds a map with qc_arena_map_from_arrays(), and adds to it, so that
+ * entry arrays of the build's chunk are moved to the other chunks
+ */
+static enum theft_trial_res QC_MKID_PROP(from_arrays) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    unsigned n = qc_map_cardinal(map);
+    int * keys = malloc(sizeof(*keys) * (n + 1));
+    int * values = malloc(sizeof(*values) * (n + 1));
+    struct qc_arena_map other = {0};
+
+    if (keys == NULL || values == NULL) {
+        free(keys);
+        free(values);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned even = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (key % 2 == 0) {
+                keys[even] = key;
+                values[even] = key / 2;
+                even++;
+            }
+        }
+
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_ARENA_THREADS) + 1;
+    bool ret = qc_arena_map_from_arrays(&other, keys, values, even, nthreads)
+        && qc_arena_map_eq(map, &other, false);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (key % 2 != 0)
+                ret = qc_arena_map_add(&other, key, key / 2);
+        }
+
+    ret = ret
+        && qc_arena_map_eq(map, &other, true);
+
+    free(keys);
+    free(values);
+    other = qc_arena_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(from_arrays);
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(arena),
+        QC_MKID_TEST(from_arrays),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_ARENA_THREADS
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,10 @@
+/* 64-bit hashes, and `size_t` sizes and cardinals */
+#define QC_CONFIG bits64
+#define MAP_CFG_64BIT
+#include "config.c"
+
+/* the same, with the 64-bit Fibonacci hashing of the index */
+#define QC_CONFIG bits64_pow2
+#define MAP_CFG_64BIT
+#define MAP_CFG_POW2
+#include "config.c"
@@ -0,0 +1,188 @@
+#define MAP_CFG_MAP qc_cache_index
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE unsigned
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_ROBIN_HOOD
+#include <utils/map.h>
+
+#define CACHE_CFG_MAP qc_cache_index
+#define CACHE_CFG_CACHE qc_cache
+#define CACHE_CFG_KEY_DATA_TYPE int
+#define CACHE_CFG_VALUE_DATA_TYPE int
+#define CACHE_CFG_IMPLEMENTATION
+#include <utils/cache.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(cache, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(cache, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/*
+ * The keys of @a map, in the order they are in the table
+ */
+static int * qc_cache_keys (const struct map * map, unsigned * n)
+{
+    *n = qc_map_cardinal(map);
+    int * keys = malloc(sizeof(*keys) * (*n + 1));
+    unsigned k = 0;
+
+    if (keys != NULL)
+        for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+            for (unsigned i = 0; i < map->table[tblidx].length; i++)
+                keys[k++] = map->table[tblidx].entries[i].key;
+
+    return keys;
+}
+
+/*
+ * Puts every key of @a map in a cache that only fits about half of them
+ */
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_cache cache = {0};
+    unsigned n = 0;
+    int * keys = qc_cache_keys(map, &n);
+    unsigned capacity = n / 2 + 1;
+    (void) t;
+
+    bool ret = keys != NULL
+        && qc_cache_new(&cache, capacity);
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_cache_put(&cache, keys[i], keys[i] / 2);
+
+    if (!ret) {
+        free(keys);
+        cache = qc_cache_free(cache);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned cardinal = (n < capacity) ? n : capacity;
+    unsigned found = 0;
+
+    ret = qc_cache_cardinal(&cache) == cardinal
+        && cache.evictions == n - cardinal;
+    for (unsigned i = 0; ret && i < n; i++) {
+        int value = 0;
+        if (qc_cache_get(&cache, keys[i], &value)) {
+            ret = value == keys[i] / 2;
+            found++;
+        }
+    }
+
+    ret = ret
+        && found == cardinal
+        && cache.hits == found
+        && cache.misses == n - found;
+
+    free(keys);
+    cache = qc_cache_free(cache);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * With a full cache, an entry that was looked up survives the next
+ * eviction, and the one after it (in the clock) doesn't
+ */
+static enum theft_trial_res QC_MKID_PROP(clock) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_cache cache = {0};
+    unsigned n = 0;
+    int * keys = qc_cache_keys(map, &n);
+    (void) t;
+
+    if (keys == NULL || n < 3) {
+        free(keys);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned capacity = n - 1;
+    bool ret = qc_cache_new(&cache, capacity);
+    for (unsigned i = 0; ret && i < capacity; i++)
+        ret = qc_cache_put(&cache, keys[i], keys[i]);
+
+    bool inserted = false;
+    ret = ret
+        && qc_cache_get_ptr(&cache, keys[0]) != NULL
+        && qc_cache_entry(&cache, keys[capacity], &inserted) != NULL;
+
+    if (!ret) {
+        free(keys);
+        cache = qc_cache_free(cache);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    ret = inserted
+        && cache.evictions == 1
+        && qc_cache_contains(&cache, keys[0])
+        && !qc_cache_contains(&cache, keys[1])
+        && qc_cache_contains(&cache, keys[capacity])
+        && qc_cache_cardinal(&cache) == capacity;
+
+    free(keys);
+    cache = qc_cache_free(cache);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Removing an entry keeps the others
+ */
+static enum theft_trial_res QC_MKID_PROP(remove) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_cache cache = {0};
+    unsigned n = 0;
+    int * keys = qc_cache_keys(map, &n);
+
+    if (keys == NULL || n == 0 || !qc_cache_new(&cache, n)) {
+        free(keys);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = true;
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_cache_put(&cache, keys[i], keys[i]);
+
+    unsigned r = (unsigned) theft_random_choice(t, n);
+    int value = 0;
+    ret = ret
+        && qc_cache_remove(&cache, keys[r], &value)
+        && value == keys[r]
+        && !qc_cache_remove(&cache, keys[r], NULL)
+        && qc_cache_cardinal(&cache) == n - 1;
+
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_cache_get(&cache, keys[i], &value) == (i != r)
+            && (i == r || value == keys[i]);
+
+    free(keys);
+    cache = qc_cache_free(cache);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(clock);
+QC_MKTEST_FUNC(remove);
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(cache),
+        QC_MKID_TEST(clock),
+        QC_MKID_TEST(remove),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,357 @@
+/* the map of the shards of both concurrent maps */
+#define MAP_CFG_MAP qc_cmap_shard
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#include <utils/map.h>
+
+#define CMAP_CFG_MAP qc_cmap_shard
+#define CMAP_CFG_CMAP qc_rw_cmap
+#define CMAP_CFG_KEY_DATA_TYPE int
+#define CMAP_CFG_VALUE_DATA_TYPE int
+#define CMAP_CFG_HASH_FUNC qc_map_int_hash
+#define CMAP_CFG_IMPLEMENTATION
+#include <utils/cmap.h>
+
+/* few shards, so the threads often want the same one */
+#define CMAP_CFG_MAP qc_cmap_shard
+#define CMAP_CFG_CMAP qc_spin_cmap
+#define CMAP_CFG_KEY_DATA_TYPE int
+#define CMAP_CFG_VALUE_DATA_TYPE int
+#define CMAP_CFG_HASH_FUNC qc_map_int_hash
+#define CMAP_CFG_SHARD_BITS 2
+#define CMAP_CFG_SPINLOCK
+#define CMAP_CFG_IMPLEMENTATION
+#include <utils/cmap.h>
+
+/* a seeded hash of hash.h, so the shards have no hash function cmap can call */
+#define MAP_CFG_MAP qc_cmap_seeded_shard
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_HASH_INT
+#define MAP_CFG_SEEDED_HASH
+#include <utils/map.h>
+
+#define CMAP_CFG_MAP qc_cmap_seeded_shard
+#define CMAP_CFG_CMAP qc_seeded_cmap
+#define CMAP_CFG_KEY_DATA_TYPE int
+#define CMAP_CFG_VALUE_DATA_TYPE int
+#define CMAP_CFG_SHARD_BITS 2
+#define CMAP_CFG_SEEDED_HASH
+#define CMAP_CFG_IMPLEMENTATION
+#include <utils/cmap.h>
+
+#include <pthread.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(cmap, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(cmap, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_CMAP_ROUNDS  4
+#define QC_CMAP_THREADS 4
+
+/*
+ * The functions of either concurrent map, so the same threads can work
+ * on both
+ */
+struct qc_cmap_ops {
+    void * self;
+    bool (* add) (void * self, int key, int value);
+    bool (* contains) (void * self, int key);
+    bool (* remove) (void * self, int key, int * value);
+};
+
+/*
+ * The work of a thread: the keys at `keys[id]`, `keys[id + nthreads]`,
+ * ... are its own, the others are only looked up
+ */
+struct qc_cmap_work {
+    const struct qc_cmap_ops * ops;
+    const int * keys;
+    unsigned n;
+    unsigned id;
+    unsigned nthreads;
+};
+
+static bool qc_rw_cmap_add_op (void * self, int key, int value)
+{
+    return qc_rw_cmap_add(self, key, value);
+}
+
+static bool qc_rw_cmap_contains_op (void * self, int key)
+{
+    return qc_rw_cmap_contains(self, key);
+}
+
+static bool qc_rw_cmap_remove_op (void * self, int key, int * value)
+{
+    return qc_rw_cmap_remove(self, key, value);
+}
+
+static bool qc_seeded_cmap_add_op (void * self, int key, int value)
+{
+    return qc_seeded_cmap_add(self, key, value);
+}
+
+static bool qc_seeded_cmap_contains_op (void * self, int key)
+{
+    return qc_seeded_cmap_contains(self, key);
+}
+
+static bool qc_seeded_cmap_remove_op (void * self, int key, int * value)
+{
+    return qc_seeded_cmap_remove(self, key, value);
+}
+
+static bool qc_spin_cmap_add_op (void * self, int key, int value)
+{
+    return qc_spin_cmap_add(self, key, value);
+}
+
+static bool qc_spin_cmap_contains_op (void * self, int key)
+{
+    return qc_spin_cmap_contains(self, key);
+}
+
+static bool qc_spin_cmap_remove_op (void * self, int key, int * value)
+{
+    return qc_spin_cmap_remove(self, key, value);
+}
+
+/*
+ * Adds its keys and removes the odd ones, a few times, looking up the
+ * keys of the other threads in between. In the end, only its even keys
+ * are in the map
+ * @returns The number of calls that didn't do what they should
+ */
+static void * qc_cmap_work (void * arg)
+{
+    const struct qc_cmap_work * work = arg;
+    const struct qc_cmap_ops * ops = work->ops;
+    size_t errors = 0;
+
+    for (unsigned round = 0; round < QC_CMAP_ROUNDS; round++) {
+        for (unsigned i = work->id; i < work->n; i += work->nthreads) {
+            int key = work->keys[i];
+            errors += !ops->add(ops->self, key, key / 2);
+        }
+
+        for (unsigned i = 0; i < work->n; i++)
+            (void) ops->contains(ops->self, work->keys[i]);
+
+        for (unsigned i = work->id; i < work->n; i += work->nthreads) {
+            int key = work->keys[i];
+            int value = -1;
+            if (key % 2 != 0)
+                errors += !ops->remove(ops->self, key, &value)
+                    || value != key / 2;
+        }
+    }
+
+    return (void *) errors;
+}
+
+/*
+ * Runs qc_cmap_work() on @a nthreads threads, and checks what's left
+ */
+static bool qc_cmap_run (const struct map * map, const struct qc_cmap_ops * ops, unsigned nthreads)
+{
+    unsigned n = qc_map_cardinal(map);
+    int * keys = malloc(sizeof(*keys) * (n + 1));
+    pthread_t threads[QC_CMAP_THREADS];
+    struct qc_cmap_work works[QC_CMAP_THREADS];
+
+    if (keys == NULL)
+        return false;
+
+    unsigned k = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++)
+            keys[k++] = map->table[tblidx].entries[i].key;
+
+    unsigned started = 0;
+    for (; started < nthreads; started++) {
+        works[started] = (struct qc_cmap_work) {
+            .ops = ops,
+            .keys = keys,
+            .n = n,
+            .id = started,
+            .nthreads = nthreads,
+        };
+        if (pthread_create(threads + started, NULL, qc_cmap_work, works + started) != 0)
+            break;
+    }
+
+    size_t errors = 0;
+    for (unsigned i = 0; i < started; i++) {
+        void * ret = NULL;
+        pthread_join(threads[i], &ret);
+        errors += (size_t) ret;
+    }
+
+    bool ret = started == nthreads && errors == 0;
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = ops->contains(ops->self, keys[i]) == (keys[i] % 2 == 0);
+
+    free(keys);
+
+    return ret;
+}
+
+/*
+ * The final contents of a map with reader/writer locks, after the
+ * threads were done with it
+ */
+static enum theft_trial_res QC_MKID_PROP(rwlock) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_rw_cmap other = {0};
+
+    if (!qc_rw_cmap_new(&other))
+        return THEFT_TRIAL_SKIP;
+
+    const struct qc_cmap_ops ops = {
+        .self = &other,
+        .add = qc_rw_cmap_add_op,
+        .contains = qc_rw_cmap_contains_op,
+        .remove = qc_rw_cmap_remove_op,
+    };
+
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_CMAP_THREADS) + 1;
+    unsigned even = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++)
+            even += map->table[tblidx].entries[i].key % 2 == 0;
+
+    bool ret = qc_cmap_run(map, &ops, nthreads)
+        && qc_rw_cmap_cardinal(&other) == even;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            if (key % 2 == 0)
+                ret = qc_rw_cmap_get(&other, key, &value)
+                    && value == key / 2;
+        }
+
+    other = qc_rw_cmap_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * The same, with spinlocks
+ */
+static enum theft_trial_res QC_MKID_PROP(spinlock) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_spin_cmap other = {0};
+
+    if (!qc_spin_cmap_new(&other))
+        return THEFT_TRIAL_SKIP;
+
+    const struct qc_cmap_ops ops = {
+        .self = &other,
+        .add = qc_spin_cmap_add_op,
+        .contains = qc_spin_cmap_contains_op,
+        .remove = qc_spin_cmap_remove_op,
+    };
+
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_CMAP_THREADS) + 1;
+    unsigned even = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++)
+            even += map->table[tblidx].entries[i].key % 2 == 0;
+
+    bool ret = qc_cmap_run(map, &ops, nthreads)
+        && qc_spin_cmap_cardinal(&other) == even;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            if (key % 2 == 0)
+                ret = qc_spin_cmap_get(&other, key, &value)
+                    && value == key / 2;
+        }
+
+    other = qc_spin_cmap_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * The same, with shards of a seeded hash: they all have the seed the
+ * keys are hashed with, so the keys are found in the shard they were
+ * added to
+ */
+static enum theft_trial_res QC_MKID_PROP(seeded) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_seeded_cmap other = {0};
+
+    if (!qc_seeded_cmap_new(&other))
+        return THEFT_TRIAL_SKIP;
+
+    const struct qc_cmap_ops ops = {
+        .self = &other,
+        .add = qc_seeded_cmap_add_op,
+        .contains = qc_seeded_cmap_contains_op,
+        .remove = qc_seeded_cmap_remove_op,
+    };
+
+    bool ret = true;
+    /* (2^2 shards) */
+    for (unsigned i = 0; ret && i < 4; i++)
+        ret = other.shards[i].map.seed == other.hasher.seed;
+
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_CMAP_THREADS) + 1;
+    unsigned even = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++)
+            even += map->table[tblidx].entries[i].key % 2 == 0;
+
+    ret = ret
+        && qc_cmap_run(map, &ops, nthreads)
+        && qc_seeded_cmap_cardinal(&other) == even;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            if (key % 2 == 0)
+                ret = qc_seeded_cmap_get(&other, key, &value)
+                    && value == key / 2;
+        }
+
+    other = qc_seeded_cmap_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(rwlock);
+QC_MKTEST_FUNC(seeded);
+QC_MKTEST_FUNC(spinlock);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(cmap),
+        QC_MKID_TEST(rwlock),
+        QC_MKID_TEST(seeded),
+        QC_MKID_TEST(spinlock),
+        );
+
+#undef QC_CMAP_ROUNDS
+#undef QC_CMAP_THREADS
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
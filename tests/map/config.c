@@ -0,0 +1,320 @@
+/*
+ * The properties that every build config of map.h must have, checked
+ * against the default config of map.c (`struct map`). Define QC_CONFIG
+ * (the name of the config) and the MAP_CFG_* macros of the config, then
+ * include this file. Keys and values are `int`, and MAP_CFG_HASH_FUNC
+ * defaults to qc_map_int_hash()
+ */
+#ifndef QC_CONFIG
+# error "Must define QC_CONFIG"
+#endif /* QC_CONFIG */
+
+#if !defined(MAP_CFG_HASH_FUNC) && !defined(MAP_CFG_HASH_BYTES) && !defined(MAP_CFG_HASH_INT)
+# define MAP_CFG_HASH_FUNC qc_map_int_hash
+#endif /* !MAP_CFG_HASH_FUNC && !MAP_CFG_HASH_BYTES && !MAP_CFG_HASH_INT */
+
+#define QC_CONFIG_MAKE_STR1(CONFIG, NAME) qc_ ## CONFIG ## _map ## NAME
+#define QC_CONFIG_MAKE_STR(CONFIG, NAME)  QC_CONFIG_MAKE_STR1(CONFIG, NAME)
+
+/* The map type, `qc_<QC_CONFIG>_map`, and its functions */
+#define QC_CONFIG_MAP  QC_CONFIG_MAKE_STR(QC_CONFIG, )
+#define QC_CONFIG_F(F) QC_CONFIG_MAKE_STR(QC_CONFIG, _ ## F)
+
+#define MAP_CFG_MAP QC_CONFIG_MAP
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(QC_CONFIG, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(QC_CONFIG, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/*
+ * Initializes @a other with the smallest size, so that it has to grow a
+ * few times, and adds the keys of @a map, each with value `key / 2`
+ */
+static bool QC_CONFIG_F(qc_fill) (const struct map * map, struct QC_CONFIG_MAP * other)
+{
+    bool ret = QC_CONFIG_F(with_size)(other, 3);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = QC_CONFIG_F(add)(other, key, key / 2);
+        }
+
+    return ret;
+}
+
+/*
+ * Checks that @a other has exactly the keys of @a map, the even ones
+ * with value `key / 2`, and the odd ones only if @a odd
+ */
+static bool QC_CONFIG_F(qc_eq) (const struct map * map, const struct QC_CONFIG_MAP * other, bool odd)
+{
+    unsigned cardinal = 0;
+    bool ret = true;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+
+            if (key % 2 == 0 || odd) {
+                ret = QC_CONFIG_F(lookup)(other, key, &value)
+                    && value == key / 2
+                    && QC_CONFIG_F(get)(other, key) == key / 2;
+                cardinal++;
+            } else {
+                ret = !QC_CONFIG_F(contains)(other, key)
+                    && !QC_CONFIG_F(lookup)(other, key, &value)
+                    && value == -1;
+            }
+        }
+
+    return ret && QC_CONFIG_F(cardinal)(other) == cardinal;
+}
+
+/*
+ * Adds the keys of @a map, then adds them again with other values,
+ * which must only update them
+ */
+static enum theft_trial_res QC_MKID_PROP(add) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct QC_CONFIG_MAP other = {0};
+
+    if (!QC_CONFIG_F(qc_fill)(map, &other)) {
+        other = QC_CONFIG_F(free)(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    int not_in = qc_map_random_not_in(map, (int) theft_random_bits(t, 32));
+    bool ret = QC_CONFIG_F(qc_eq)(map, &other, true)
+        && !QC_CONFIG_F(contains)(&other, not_in);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = QC_CONFIG_F(add)(&other, key, key)
+                && QC_CONFIG_F(get)(&other, key) == key;
+        }
+
+    ret = ret
+        && QC_CONFIG_F(cardinal)(&other) == qc_map_cardinal(map);
+
+    other = QC_CONFIG_F(free)(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Removes the odd keys, then adds them back (to the slots they left,
+ * with open addressing)
+ */
+static enum theft_trial_res QC_MKID_PROP(remove) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct QC_CONFIG_MAP other = {0};
+    (void) t;
+
+    if (!QC_CONFIG_F(qc_fill)(map, &other)) {
+        other = QC_CONFIG_F(free)(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = true;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            if (key % 2 != 0)
+                ret = QC_CONFIG_F(remove)(&other, key, &value)
+                    && value == key / 2
+                    && !QC_CONFIG_F(remove)(&other, key, NULL);
+        }
+
+    ret = ret
+        && QC_CONFIG_F(qc_eq)(map, &other, false);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (key % 2 != 0)
+                ret = QC_CONFIG_F(add)(&other, key, key / 2);
+        }
+
+    ret = ret
+        && QC_CONFIG_F(qc_eq)(map, &other, true);
+
+    other = QC_CONFIG_F(free)(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Iterates over the map, and checks that every key of @a map is seen
+ * exactly once, with its value
+ */
+static enum theft_trial_res QC_MKID_PROP(iter) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    unsigned n = qc_map_cardinal(map);
+    int * keys = malloc(sizeof(*keys) * (n + 1));
+    bool * seen = calloc(n + 1, sizeof(*seen));
+    struct QC_CONFIG_MAP other = {0};
+    (void) t;
+
+    if (keys == NULL || seen == NULL || !QC_CONFIG_F(qc_fill)(map, &other)) {
+        free(keys);
+        free(seen);
+        other = QC_CONFIG_F(free)(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned k = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++)
+            keys[k++] = map->table[tblidx].entries[i].key;
+    qsort(keys, n, sizeof(*keys), qc_int_compar);
+
+    bool ret = true;
+    unsigned visited = 0;
+    for (bool more = QC_CONFIG_F(iter)(&other); ret && more; more = QC_CONFIG_F(iter_next)(&other)) {
+        int key = QC_CONFIG_F(iter_key)(&other);
+        const int * found = bsearch(&key, keys, n, sizeof(*keys), qc_int_compar);
+        ret = found != NULL
+            && !seen[found - keys]
+            && QC_CONFIG_F(iter_val)(&other) == key / 2;
+        if (ret)
+            seen[found - keys] = true;
+        visited++;
+    }
+
+    ret = ret
+        && visited == n
+        && !QC_CONFIG_F(itering)(&other);
+
+    free(keys);
+    free(seen);
+    other = QC_CONFIG_F(free)(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Resizes the map to a random size, and checks that nothing was lost
+ */
+static enum theft_trial_res QC_MKID_PROP(resize) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct QC_CONFIG_MAP other = {0};
+
+    if (!QC_CONFIG_F(qc_fill)(map, &other)) {
+        other = QC_CONFIG_F(free)(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    /* with open addressing, it has to be bigger than the number of entries */
+    unsigned new_size = qc_map_cardinal(map) + (unsigned) theft_random_choice(t, 125) + 3;
+    bool ret = QC_CONFIG_F(resize)(&other, new_size)
+        && QC_CONFIG_F(qc_eq)(map, &other, true);
+
+    other = QC_CONFIG_F(free)(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Adds half of the keys with MAP_ADD_WITH_HASH() and the other half with
+ * MAP_ADD(), and checks that the `*_WITH_HASH()` functions, given the
+ * hash of MAP_HASH(), agree with the plain ones
+ */
+static enum theft_trial_res QC_MKID_PROP(with_hash) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct QC_CONFIG_MAP other = {0};
+    bool ret = QC_CONFIG_F(with_size)(&other, 3);
+    (void) t;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = (i % 2 == 0) ?
+                QC_CONFIG_F(add_with_hash)(&other, key, QC_CONFIG_F(hash)(&other, key), key / 2):
+                QC_CONFIG_F(add)(&other, key, key / 2);
+        }
+
+    if (!ret) {
+        other = QC_CONFIG_F(free)(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    ret = QC_CONFIG_F(qc_eq)(map, &other, true);
+
+    /*
+     * (with MAP_CFG_INCREMENTAL_RESIZE, MAP_GET_PTR() may move the entry,
+     * so only the values are compared)
+     */
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            const int * ptr = NULL;
+            ret = QC_CONFIG_F(contains_with_hash)(&other, key, QC_CONFIG_F(hash)(&other, key))
+                && QC_CONFIG_F(lookup_with_hash)(&other, key, QC_CONFIG_F(hash)(&other, key), &value)
+                && value == key / 2
+                && QC_CONFIG_F(get_with_hash)(&other, key, QC_CONFIG_F(hash)(&other, key)) == QC_CONFIG_F(get)(&other, key)
+                && (ptr = QC_CONFIG_F(get_ptr_with_hash)(&other, key, QC_CONFIG_F(hash)(&other, key))) != NULL
+                && *ptr == key / 2
+                && (ptr = QC_CONFIG_F(get_ptr)(&other, key)) != NULL
+                && *ptr == key / 2;
+        }
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (key % 2 != 0)
+                ret = QC_CONFIG_F(remove_with_hash)(&other, key, QC_CONFIG_F(hash)(&other, key), NULL);
+        }
+
+    ret = ret
+        && QC_CONFIG_F(qc_eq)(map, &other, false);
+
+    other = QC_CONFIG_F(free)(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(add);
+QC_MKTEST_FUNC(iter);
+QC_MKTEST_FUNC(remove);
+QC_MKTEST_FUNC(resize);
+QC_MKTEST_FUNC(with_hash);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(QC_CONFIG),
+        QC_MKID_TEST(add),
+        QC_MKID_TEST(iter),
+        QC_MKID_TEST(remove),
+        QC_MKID_TEST(resize),
+        QC_MKID_TEST(with_hash),
+        );
+
+#undef QC_CONFIG
+#undef QC_CONFIG_F
+#undef QC_CONFIG_MAKE_STR
+#undef QC_CONFIG_MAKE_STR1
+#undef QC_CONFIG_MAP
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -20,7 +20,9 @@ static enum theft_trial_res QC_MKID_PROP(content) (struct theft * t, void * arg1
     if (!qc_map_clone(map, &clone))
         return THEFT_TRIAL_SKIP;
     map_contains(&clone, key);
-    return QC_BOOL2TRIAL(qc_map_content_eq(map, &clone));
+    bool ret = qc_map_content_eq(map, &clone);
+    clone = map_free(clone);
+    return QC_BOOL2TRIAL(ret);
 }
 
 static enum theft_trial_res QC_MKID_PROP(meta) (struct theft * t, void * arg1, void * arg2)
@@ -0,0 +1,57 @@
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(cursor, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(cursor, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_CURSOR_MAX 8
+
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    (void) t;
+    const struct map * map = arg1;
+    struct map_cursor cur;
+    unsigned n = 0;
+    bool ret = true;
+
+    for (bool ok = map_cursor_begin(map, &cur); ok && ret; ok = map_cursor_next(&cur), n++)
+        ret = qc_map_contains(map, map_cursor_key(&cur))
+            && qc_map_get(map, map_cursor_key(&cur)) == map_cursor_value(&cur);
+
+    return QC_BOOL2TRIAL(ret && n == qc_map_cardinal(map));
+}
+
+static enum theft_trial_res QC_MKID_PROP(split) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct map_cursor cursors[QC_CURSOR_MAX];
+    unsigned k = (unsigned) theft_random_choice(t, QC_CURSOR_MAX) + 1;
+    unsigned n = 0;
+    bool ret = true;
+
+    map_cursor_split(map, cursors, k);
+    for (unsigned i = 0; i < k && ret; i++)
+        for (; map_cursor_valid(cursors + i) && ret; map_cursor_next(cursors + i), n++)
+            ret = qc_map_get(map, map_cursor_key(cursors + i)) == map_cursor_value(cursors + i);
+
+    return QC_BOOL2TRIAL(ret && n == qc_map_cardinal(map));
+}
+
+QC_MKTEST_FUNC(res);
+QC_MKTEST_FUNC(split);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(cursor),
+        QC_MKID_TEST(res),
+        QC_MKID_TEST(split),
+        );
+
+#undef QC_CURSOR_MAX
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,136 @@
+/* few different hashes, so most entries go to the overflow */
+static unsigned int qc_freeze_hash (const int k)
+{
+    return (unsigned int) k % 61;
+}
+
+#define MAP_CFG_MAP qc_freeze_map
+#define MAP_CFG_HASH_FUNC qc_freeze_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(freeze, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(freeze, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct map copy = {0};
+    struct map_frozen frozen = {0};
+    (void) t;
+
+    if (!qc_map_clone(map, &copy))
+        return THEFT_TRIAL_SKIP;
+
+    if (!map_freeze(&copy, &frozen)) {
+        copy = map_free(copy);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = frozen.nslots + frozen.noverflow == qc_map_cardinal(map);
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int value = 0;
+            ret = map_frozen_get(&frozen, map->table[tblidx].entries[i].key, &value)
+                && value == map->table[tblidx].entries[i].value;
+        }
+
+    frozen = map_frozen_free(frozen);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+static enum theft_trial_res QC_MKID_PROP(not_in) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct map copy = {0};
+    struct map_frozen frozen = {0};
+    int key = qc_map_random_not_in(map, (int) theft_random_bits(t, 16));
+
+    if (!qc_map_clone(map, &copy))
+        return THEFT_TRIAL_SKIP;
+
+    if (!map_freeze(&copy, &frozen)) {
+        copy = map_free(copy);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = !map_frozen_contains(&frozen, key);
+
+    frozen = map_frozen_free(frozen);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Freezes a map whose keys share a few hashes, and looks up both the
+ * keys of @a map and keys that aren't there, so the overflow is
+ * searched with and without a match
+ */
+static enum theft_trial_res QC_MKID_PROP(overflow) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_freeze_map other = {0};
+    struct qc_freeze_map_frozen frozen = {0};
+    bool ret = qc_freeze_map_new(&other);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = qc_freeze_map_add(&other, key, key / 2);
+        }
+
+    if (!ret || !qc_freeze_map_freeze(&other, &frozen)) {
+        other = qc_freeze_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned n = qc_map_cardinal(map);
+    ret = frozen.nslots + frozen.noverflow == n
+        && frozen.noverflow + 61 >= n;
+
+    for (unsigned i = 1; ret && i < frozen.noverflow; i++)
+        ret = frozen.overflow[i - 1].hash <= frozen.overflow[i].hash;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = 0;
+            ret = qc_freeze_map_frozen_get(&frozen, key, &value)
+                && value == key / 2;
+        }
+
+    for (unsigned i = 0; ret && i < 61; i++) {
+        int key = qc_map_random_not_in(map, (int) theft_random_bits(t, 16));
+        ret = !qc_freeze_map_frozen_contains(&frozen, key);
+    }
+
+    frozen = qc_freeze_map_frozen_free(frozen);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(not_in);
+QC_MKTEST_FUNC(overflow);
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(freeze),
+        QC_MKID_TEST(not_in),
+        QC_MKID_TEST(overflow),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,61 @@
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(from_arrays, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(from_arrays, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_FROM_ARRAYS_THREADS 4
+
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    unsigned n = qc_map_cardinal(map);
+    int * keys = malloc(sizeof(*keys) * (n + 1));
+    int * values = malloc(sizeof(*values) * (n + 1));
+    struct map other = {0};
+    bool ret = true;
+
+    if (keys == NULL || values == NULL) {
+        free(keys);
+        free(values);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    for (unsigned tblidx = 0, i = 0; tblidx < map->size; tblidx++)
+        for (unsigned j = 0; j < map->table[tblidx].length; j++, i++) {
+            keys[i] = map->table[tblidx].entries[j].key;
+            values[i] = map->table[tblidx].entries[j].value;
+        }
+
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_FROM_ARRAYS_THREADS) + 1;
+    if (!map_from_arrays(&other, keys, values, n, nthreads)) {
+        ret = false;
+    } else {
+        ret = map_cardinal(&other) == n;
+        for (unsigned i = 0; ret && i < n; i++)
+            ret = map_get(&other, keys[i]) == values[i];
+    }
+
+    free(keys);
+    free(values);
+    other = map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(from_arrays),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_FROM_ARRAYS_THREADS
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,168 @@
+/* the hash functions of hash.h, unseeded */
+#define QC_CONFIG hash_int
+#define MAP_CFG_HASH_INT
+#include "config.c"
+
+#define QC_CONFIG hash_bytes
+#define MAP_CFG_HASH_BYTES
+#include "config.c"
+
+/* the pointers themselves are the keys */
+typedef const int * qc_hash_ptr;
+
+static int qc_hash_ptr_cmp (qc_hash_ptr a, qc_hash_ptr b)
+{
+    return (a < b) ? -1 : (a > b);
+}
+
+/* (map.h leaves MAP_CFG_KEY_CMP defined, for the next map) */
+#undef MAP_CFG_KEY_CMP
+#define MAP_CFG_MAP qc_hash_ptr_map
+#define MAP_CFG_KEY_CMP qc_hash_ptr_cmp
+#define MAP_CFG_KEY_DATA_TYPE qc_hash_ptr
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_HASH_PTR
+#include <utils/map.h>
+
+/* NUL terminated strings, compared by content */
+typedef const char * qc_hash_str;
+
+#undef MAP_CFG_KEY_CMP
+#define MAP_CFG_MAP qc_hash_str_map
+#define MAP_CFG_KEY_CMP strcmp
+#define MAP_CFG_KEY_DATA_TYPE qc_hash_str
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_HASH_STR
+#define MAP_CFG_SEEDED_HASH
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(hash, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(hash, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/* enough for any `int` */
+#define QC_HASH_STR_LEN 16
+
+/*
+ * Adds pointers to the keys of @a map (in an array), and checks that
+ * they're found, but pointers to copies of the keys aren't
+ */
+static enum theft_trial_res QC_MKID_PROP(ptr) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    unsigned n = qc_map_cardinal(map);
+    int * keys = malloc(sizeof(*keys) * (n + 1));
+    int * copies = malloc(sizeof(*copies) * (n + 1));
+    struct qc_hash_ptr_map other = {0};
+    (void) t;
+
+    if (keys == NULL || copies == NULL || !qc_hash_ptr_map_with_size(&other, 3)) {
+        free(keys);
+        free(copies);
+        other = qc_hash_ptr_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned k = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++)
+            keys[k++] = map->table[tblidx].entries[i].key;
+    memcpy(copies, keys, sizeof(*keys) * n);
+
+    bool ret = true;
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_hash_ptr_map_add(&other, keys + i, keys[i]);
+
+    for (unsigned i = 0; ret && i < n; i++) {
+        int value = -1;
+        ret = qc_hash_ptr_map_lookup(&other, keys + i, &value)
+            && value == keys[i]
+            && !qc_hash_ptr_map_contains(&other, copies + i);
+    }
+
+    for (unsigned i = 0; ret && i < n; i++)
+        if (i % 2 != 0)
+            ret = qc_hash_ptr_map_remove(&other, keys + i, NULL);
+
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_hash_ptr_map_contains(&other, keys + i) == (i % 2 == 0);
+
+    ret = ret
+        && qc_hash_ptr_map_cardinal(&other) == (n + 1) / 2;
+
+    free(keys);
+    free(copies);
+    other = qc_hash_ptr_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Adds the keys of @a map as strings, and looks them up with other
+ * strings of the same content
+ */
+static enum theft_trial_res QC_MKID_PROP(str) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    unsigned n = qc_map_cardinal(map);
+    char (* keys)[QC_HASH_STR_LEN] = malloc(sizeof(*keys) * (n + 1));
+    struct qc_hash_str_map other = {0};
+
+    if (keys == NULL || !qc_hash_str_map_with_size(&other, 3)) {
+        free(keys);
+        other = qc_hash_str_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned k = 0;
+    for (unsigned tblidx = 0; tblidx < map->size; tblidx++)
+        for (unsigned i = 0; i < map->table[tblidx].length; i++, k++)
+            snprintf(keys[k], sizeof(*keys), "%d", map->table[tblidx].entries[i].key);
+
+    bool ret = true;
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_hash_str_map_add(&other, keys[i], (int) i);
+
+    for (unsigned i = 0; ret && i < n; i++) {
+        char copy[QC_HASH_STR_LEN] = "";
+        int value = -1;
+        memcpy(copy, keys[i], sizeof(copy));
+        ret = qc_hash_str_map_lookup(&other, copy, &value)
+            && value == (int) i;
+    }
+
+    int not_in = qc_map_random_not_in(map, (int) theft_random_bits(t, 32));
+    char str[QC_HASH_STR_LEN] = "";
+    snprintf(str, sizeof(str), "%d", not_in);
+
+    ret = ret
+        && !qc_hash_str_map_contains(&other, str)
+        && qc_hash_str_map_cardinal(&other) == n;
+
+    free(keys);
+    other = qc_hash_str_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(ptr);
+QC_MKTEST_FUNC(str);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(hash),
+        QC_MKID_TEST(ptr),
+        QC_MKID_TEST(str),
+        );
+
+#undef MAP_CFG_KEY_CMP
+#undef QC_HASH_STR_LEN
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,231 @@
+#define MAP_CFG_MAP qc_image_map
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_IMAGE
+#include <utils/map.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(image, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(image, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_IMAGE_PATH "/tmp/qc_image_XXXXXX"
+
+/*
+ * Makes a new (empty) file for an image, in @a path
+ */
+static bool qc_image_path (char path[sizeof(QC_IMAGE_PATH)])
+{
+    memcpy(path, QC_IMAGE_PATH, sizeof(QC_IMAGE_PATH));
+    int fd = mkstemp(path);
+    return fd >= 0
+        && close(fd) == 0;
+}
+
+/*
+ * Writes an image of the keys of @a map (with value `key / 2`), or of
+ * an empty map if @a empty, to a new file in @a path
+ */
+static bool qc_image_write (const struct map * map, bool empty, char path[sizeof(QC_IMAGE_PATH)])
+{
+    struct qc_image_map other = {0};
+    bool ret = qc_image_map_new(&other);
+
+    for (unsigned tblidx = 0; ret && !empty && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = qc_image_map_add(&other, key, key / 2);
+        }
+
+    ret = ret
+        && qc_image_path(path)
+        && qc_image_map_image_write(&other, path);
+
+    other = qc_image_map_free(other);
+
+    return ret;
+}
+
+/*
+ * Checks that @a img has exactly the keys of @a map, with value
+ * `key / 2`, or no keys at all if @a empty
+ */
+static bool qc_image_eq (struct theft * t, const struct map * map, const struct qc_image_map_image * img, bool empty)
+{
+    bool ret = img->cardinal == ((empty) ? 0 : qc_map_cardinal(map));
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            ret = (empty) ?
+                !qc_image_map_image_contains(img, key):
+                qc_image_map_image_get(img, key, &value) && value == key / 2;
+        }
+
+    int not_in = qc_map_random_not_in(map, (int) theft_random_bits(t, 32));
+    return ret
+        && !qc_image_map_image_contains(img, not_in);
+}
+
+/*
+ * Writes an image of the map, and opens it
+ */
+static enum theft_trial_res QC_MKID_PROP(round_trip) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    char path[sizeof(QC_IMAGE_PATH)] = "";
+    struct qc_image_map_image img = {0};
+
+    if (!qc_image_write(map, false, path)) {
+        unlink(path);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = qc_image_map_image_open(&img, path)
+        && qc_image_eq(t, map, &img, false)
+        && qc_image_map_image_close(&img);
+
+    unlink(path);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Writes an image of an empty map, and opens it
+ */
+static enum theft_trial_res QC_MKID_PROP(empty) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    char path[sizeof(QC_IMAGE_PATH)] = "";
+    struct qc_image_map_image img = {0};
+
+    if (!qc_image_write(map, true, path)) {
+        unlink(path);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = qc_image_map_image_open(&img, path)
+        && qc_image_eq(t, map, &img, true)
+        && qc_image_map_image_close(&img);
+
+    unlink(path);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Cuts an image anywhere: it can't be opened anymore
+ */
+static enum theft_trial_res QC_MKID_PROP(truncated) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    char path[sizeof(QC_IMAGE_PATH)] = "";
+    struct qc_image_map_image img = {0};
+    bool empty = theft_random_choice(t, 2) == 0;
+
+    if (!qc_image_write(map, empty, path) || !qc_image_map_image_open(&img, path)) {
+        unlink(path);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    off_t length = (off_t) img.length;
+    bool ret = qc_image_map_image_close(&img)
+        && truncate(path, (off_t) theft_random_choice(t, (uint64_t) length)) == 0
+        && !qc_image_map_image_open(&img, path)
+        && img.base == NULL;
+
+    unlink(path);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Corrupts an image: with a byte of the header changed it can't be
+ * opened, and with the bucket starts overwritten, lookups find nothing
+ * (and stay inside the file)
+ */
+static enum theft_trial_res QC_MKID_PROP(corrupted) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    char path[sizeof(QC_IMAGE_PATH)] = "";
+    struct qc_image_map_image img = {0};
+
+    if (!qc_image_write(map, false, path) || !qc_image_map_image_open(&img, path)) {
+        unlink(path);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    long starts = (long) ((const char *) img.starts - (const char *) img.base);
+    size_t nstarts = (size_t) img.nbuckets + 1;
+    bool ret = qc_image_map_image_close(&img);
+
+    /* one of the bytes checked by MAP_IMAGE_OPEN(): the magic */
+    long offset = (long) theft_random_choice(t, sizeof("c-utils map image\n"));
+    FILE * f = (ret) ? fopen(path, "r+b") : NULL;
+    int byte = -1;
+    ret = f != NULL
+        && fseek(f, offset, SEEK_SET) == 0
+        && (byte = fgetc(f)) != EOF
+        && fseek(f, offset, SEEK_SET) == 0
+        && fputc(byte ^ 0x20, f) != EOF
+        && fflush(f) == 0
+        && !qc_image_map_image_open(&img, path);
+
+    /*
+     * put it back, and make every bucket go past the entries, or end
+     * before it starts
+     */
+    ret = ret
+        && fseek(f, offset, SEEK_SET) == 0
+        && fputc(byte, f) != EOF
+        && fseek(f, starts, SEEK_SET) == 0;
+    for (size_t i = 0; ret && i < nstarts; i++) {
+        unsigned start = (i % 2 == 0) ? 0 : (unsigned) -1;
+        ret = fwrite(&start, sizeof(start), 1, f) == 1;
+    }
+
+    if (f != NULL && fclose(f) != 0)
+        ret = false;
+
+    if (ret && qc_image_map_image_open(&img, path)) {
+        for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+            for (unsigned i = 0; ret && i < map->table[tblidx].length; i++)
+                ret = !qc_image_map_image_contains(&img, map->table[tblidx].entries[i].key);
+        ret = qc_image_map_image_close(&img)
+            && ret;
+    }
+
+    unlink(path);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(corrupted);
+QC_MKTEST_FUNC(empty);
+QC_MKTEST_FUNC(round_trip);
+QC_MKTEST_FUNC(truncated);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(image),
+        QC_MKID_TEST(corrupted),
+        QC_MKID_TEST(empty),
+        QC_MKID_TEST(round_trip),
+        QC_MKID_TEST(truncated),
+        );
+
+#undef QC_IMAGE_PATH
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,283 @@
+/* one entry array per step, so most operations find a resize in progress */
+#define QC_CONFIG incremental
+#define MAP_CFG_INCREMENTAL_RESIZE
+#define MAP_CFG_RESIZE_STEP 1
+#include "config.c"
+
+/*
+ * When set, the allocations of qc_migrate_map fail, to test the error
+ * paths of a resize (the new table) and of a migration (the entry
+ * arrays of the new table)
+ */
+static bool qc_migrate_oom = false;
+
+static void * qc_migrate_calloc (size_t nmemb, size_t size)
+{
+    return qc_migrate_oom ? NULL : calloc(nmemb, size);
+}
+
+static void * qc_migrate_realloc (void * ptr, size_t size)
+{
+    return qc_migrate_oom ? NULL : realloc(ptr, size);
+}
+
+#define MAP_CFG_MAP qc_migrate_map
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_INCREMENTAL_RESIZE
+#define MAP_CFG_RESIZE_STEP 1
+#define MAP_CFG_CALLOC qc_migrate_calloc
+#define MAP_CFG_REALLOC qc_migrate_realloc
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(migrate, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(migrate, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/*
+ * Adds the keys of @a map to @a other, each with value `key / 2`, and
+ * starts resizing it to a random (bigger or smaller) size
+ */
+static bool qc_migrate_map_fill (struct theft * t, const struct map * map, struct qc_migrate_map * other)
+{
+    bool ret = qc_migrate_map_with_size(other, 3);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = qc_migrate_map_add(other, key, key / 2);
+        }
+
+    /* (a resize of the adds in progress is finished first) */
+    unsigned new_size = (unsigned) theft_random_choice(t, 2 * qc_map_cardinal(map) + 125) + 3;
+    return ret
+        && qc_migrate_map_resize(other, new_size)
+        && other->old_table != NULL
+        && other->migrated == 0;
+}
+
+/*
+ * Checks that @a other has exactly the keys of @a map, the even ones
+ * with value `key / 2`, and the odd ones only if @a odd. Only uses the
+ * lookups that don't move entries
+ */
+static bool qc_migrate_map_eq (const struct map * map, const struct qc_migrate_map * other, bool odd)
+{
+    unsigned cardinal = 0;
+    bool ret = true;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+
+            if (key % 2 == 0 || odd) {
+                ret = qc_migrate_map_lookup(other, key, &value)
+                    && value == key / 2
+                    && qc_migrate_map_get(other, key) == key / 2;
+                cardinal++;
+            } else {
+                ret = !qc_migrate_map_contains(other, key);
+            }
+        }
+
+    return ret && qc_migrate_map_cardinal(other) == cardinal;
+}
+
+/*
+ * Looks every key up at each step of a resize, first with most of them
+ * in the old table, and then with all of them in the new one
+ */
+static enum theft_trial_res QC_MKID_PROP(lookup) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_migrate_map other = {0};
+
+    if (!qc_migrate_map_fill(t, map, &other)) {
+        other = qc_migrate_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    int not_in = qc_map_random_not_in(map, (int) theft_random_bits(t, 32));
+    bool ret = qc_migrate_map_eq(map, &other, true);
+
+    /* looking up a key that isn't there only to move the next entry array */
+    for (unsigned step = 1; ret && other.old_table != NULL; step++) {
+        unsigned migrated = other.migrated;
+        ret = qc_migrate_map_get_ptr(&other, not_in) == NULL
+            && (other.old_table == NULL || other.migrated > migrated);
+
+        /* every key, every time, is too slow */
+        if ((step & (step - 1)) == 0)
+            ret = ret
+                && qc_migrate_map_eq(map, &other, true);
+    }
+
+    ret = ret
+        && qc_migrate_map_eq(map, &other, true)
+        && !qc_migrate_map_contains(&other, not_in);
+
+    other = qc_migrate_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Removes the odd keys while resizing, and adds them back
+ */
+static enum theft_trial_res QC_MKID_PROP(remove) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_migrate_map other = {0};
+
+    if (!qc_migrate_map_fill(t, map, &other)) {
+        other = qc_migrate_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    bool ret = true;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            if (key % 2 != 0)
+                ret = qc_migrate_map_remove(&other, key, &value)
+                    && value == key / 2
+                    && !qc_migrate_map_remove(&other, key, NULL);
+        }
+
+    ret = ret
+        && qc_migrate_map_eq(map, &other, false);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (key % 2 != 0)
+                ret = qc_migrate_map_add(&other, key, key / 2);
+        }
+
+    ret = ret
+        && qc_migrate_map_eq(map, &other, true);
+
+    other = qc_migrate_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Iterates over a map that is resizing, which finishes the resize first
+ */
+static enum theft_trial_res QC_MKID_PROP(iter) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_migrate_map other = {0};
+
+    if (!qc_migrate_map_fill(t, map, &other)) {
+        other = qc_migrate_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    /* an empty map isn't iterated, and keeps resizing */
+    unsigned cardinal = qc_map_cardinal(map);
+    bool ret = qc_migrate_map_iter(&other) == (cardinal > 0);
+    if (cardinal > 0)
+        ret = ret
+            && other.old_table == NULL;
+
+    unsigned visited = 0;
+    for (bool more = ret && cardinal > 0; ret && more; more = qc_migrate_map_iter_next(&other)) {
+        int key = qc_migrate_map_iter_key(&other);
+        ret = qc_map_contains(map, key)
+            && qc_migrate_map_iter_val(&other) == key / 2;
+        visited++;
+    }
+
+    ret = ret
+        && visited == cardinal
+        && qc_migrate_map_eq(map, &other, true);
+
+    other = qc_migrate_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * Makes the allocations fail: MAP_RESIZE() must leave the map as it
+ * was, and so must MAP_ADD() while the map is resizing
+ */
+static enum theft_trial_res QC_MKID_PROP(oom) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_migrate_map other = {0};
+
+    if (!qc_migrate_map_fill(t, map, &other)) {
+        other = qc_migrate_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    /* finish this resize, to see that the next one doesn't start */
+    int not_in = qc_map_random_not_in(map, (int) theft_random_bits(t, 32));
+    while (other.old_table != NULL)
+        qc_migrate_map_get_ptr(&other, not_in);
+
+    unsigned size = other.size;
+    qc_migrate_oom = true;
+    bool ret = !qc_migrate_map_resize(&other, size + 1);
+    qc_migrate_oom = false;
+
+    ret = ret
+        && other.old_table == NULL
+        && other.size == size
+        && qc_migrate_map_eq(map, &other, true)
+        && qc_migrate_map_resize(&other, size + 1)
+        && other.old_table != NULL;
+
+    /* the entries that can't be moved stay where they are */
+    qc_migrate_oom = true;
+    bool added = ret
+        && qc_migrate_map_add(&other, not_in, not_in / 2);
+    qc_migrate_oom = false;
+
+    ret = ret
+        && (!added || qc_migrate_map_remove(&other, not_in, NULL))
+        && !qc_migrate_map_contains(&other, not_in)
+        && qc_migrate_map_eq(map, &other, true);
+
+    /* and are moved once it's possible again */
+    while (ret && other.old_table != NULL)
+        ret = qc_migrate_map_get_ptr(&other, not_in) == NULL;
+
+    ret = ret
+        && qc_migrate_map_eq(map, &other, true);
+
+    other = qc_migrate_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(iter);
+QC_MKTEST_FUNC(lookup);
+QC_MKTEST_FUNC(oom);
+QC_MKTEST_FUNC(remove);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(migrate),
+        QC_MKID_TEST(iter),
+        QC_MKID_TEST(lookup),
+        QC_MKID_TEST(oom),
+        QC_MKID_TEST(remove),
+        );
+
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -163,17 +163,13 @@ static bool qc_map_insert (struct map * self, int key, int value, unsigned hash,
                     &self->table[tblidx].entries[i],
                     sizeof(*self->table[tblidx].entries) * (len - i));
 
+        self->table[tblidx].length++;
         self->cardinal++;
-
-        self->lc.valid = true;
-        self->lc.hash = hash;
-        self->lc.idx = i;
     }
 
     self->table[tblidx].entries[i].hash = hash;
     self->table[tblidx].entries[i].key = key;
     self->table[tblidx].entries[i].value = value;
-    self->table[tblidx].length++;
 
     return true;
 }
@@ -203,7 +199,7 @@ static bool qc_map_clone (const struct map * map, struct map * other)
     for (unsigned tblidx = 0; tblidx < size; tblidx++) {
         unsigned length = map->table[tblidx].length;
         size_t nbytes = length * ent_size;
-        other->table[tblidx].entries = calloc(map->table[tblidx].length, ent_size);
+        other->table[tblidx].entries = calloc(map->table[tblidx].capacity, ent_size);
         assert(other->table[tblidx].entries != NULL);
         other->table[tblidx].capacity = map->table[tblidx].capacity;
         other->table[tblidx].length = length;
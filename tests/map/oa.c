@@ -0,0 +1,15 @@
+/* group probing, with the SIMD group functions if the target has them */
+#define QC_CONFIG oa
+#define MAP_CFG_OPEN_ADDRESSING
+#include "config.c"
+
+#define QC_CONFIG robin_hood
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_ROBIN_HOOD
+#include "config.c"
+
+/* group probing, with the scalar group functions */
+#define QC_CONFIG oa_no_simd
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_NO_SIMD
+#include "config.c"
@@ -0,0 +1,9 @@
+/* power of two sizes, with Fibonacci hashing of the index */
+#define QC_CONFIG pow2
+#define MAP_CFG_POW2
+#include "config.c"
+
+/* power of two sizes, with the low bits of the hash as the index */
+#define QC_CONFIG pow2_mask
+#define MAP_CFG_POW2_MASK
+#include "config.c"
@@ -0,0 +1,71 @@
+#define MAP_CFG_MAP qc_probe_map
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_OPEN_ADDRESSING
+#define MAP_CFG_ROBIN_HOOD
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(probe_stats, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(probe_stats, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/* way below what a home slot of `hash & (size - 1)` gives */
+#define QC_PROBE_STATS_MAX  32
+#define QC_PROBE_STATS_MEAN 8
+
+/*
+ * Adds keys with a power of two stride (`i << shift`), that only differ
+ * in their high bits with qc_map_int_hash(), and checks that they
+ * don't pile up in a few long runs
+ */
+static enum theft_trial_res QC_MKID_PROP(strided) (struct theft * t, void * arg1)
+{
+    (void) arg1;
+    /* (so that `n << shift` doesn't wrap around) */
+    unsigned shift = (unsigned) theft_random_choice(t, 18);
+    unsigned n = (unsigned) theft_random_choice(t, 1u << 14) + 1;
+    struct qc_probe_map other = {0};
+    bool ret = qc_probe_map_new(&other);
+
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_probe_map_add(&other, (int) (i << shift), (int) i);
+
+    if (!ret) {
+        other = qc_probe_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    struct qc_probe_map_probe_stats stats = qc_probe_map_probe_stats(&other);
+    ret = qc_probe_map_cardinal(&other) == n
+        && stats.max <= QC_PROBE_STATS_MAX
+        && stats.mean <= QC_PROBE_STATS_MEAN;
+
+    for (unsigned i = 0; ret && i < n; i++)
+        ret = qc_probe_map_contains(&other, (int) (i << shift));
+
+    other = qc_probe_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(strided);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(probe_stats),
+        QC_MKID_TEST(strided),
+        );
+
+#undef QC_PROBE_STATS_MAX
+#undef QC_PROBE_STATS_MEAN
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -1,7 +1,27 @@
 #include "map.c"
 
+#include "arena.c"
+#include "bits64.c"
+#include "cache.c"
+#include "cmap.c"
 #include "contains.c"
+#include "cursor.c"
+#include "freeze.c"
+#include "from_arrays.c"
 #include "get.c"
+#include "get_lc.c"
+#include "get_ptr.c"
+#include "hash.c"
+#include "image.c"
+#include "incremental.c"
+#include "lookup.c"
+#include "oa.c"
+#include "pow2.c"
+#include "probe_stats.c"
+#include "resize_parallel.c"
+#include "retain.c"
+#include "seeded.c"
+#include "set.c"
 
 /* redefine warning */
 #define QC_MKID_PROP
@@ -9,6 +29,35 @@
 #define QC_MKTEST_FUNC
 
 QC_MKTEST_ALL(qc_map_test_all,
+        QC_MKID_MOD_ALL(arena),
+        QC_MKID_MOD_ALL(bits64),
+        QC_MKID_MOD_ALL(bits64_pow2),
+        QC_MKID_MOD_ALL(cache),
+        QC_MKID_MOD_ALL(cmap),
         QC_MKID_MOD_ALL(contains),
+        QC_MKID_MOD_ALL(cursor),
+        QC_MKID_MOD_ALL(freeze),
+        QC_MKID_MOD_ALL(from_arrays),
         QC_MKID_MOD_ALL(get),
+        QC_MKID_MOD_ALL(get_lc),
+        QC_MKID_MOD_ALL(get_ptr),
+        QC_MKID_MOD_ALL(hash),
+        QC_MKID_MOD_ALL(hash_bytes),
+        QC_MKID_MOD_ALL(hash_int),
+        QC_MKID_MOD_ALL(image),
+        QC_MKID_MOD_ALL(incremental),
+        QC_MKID_MOD_ALL(lookup),
+        QC_MKID_MOD_ALL(migrate),
+        QC_MKID_MOD_ALL(oa),
+        QC_MKID_MOD_ALL(oa_no_simd),
+        QC_MKID_MOD_ALL(robin_hood),
+        QC_MKID_MOD_ALL(pow2),
+        QC_MKID_MOD_ALL(pow2_mask),
+        QC_MKID_MOD_ALL(probe_stats),
+        QC_MKID_MOD_ALL(resize_parallel),
+        QC_MKID_MOD_ALL(retain),
+        QC_MKID_MOD_ALL(seed),
+        QC_MKID_MOD_ALL(seeded),
+        QC_MKID_MOD_ALL(seeded_oa),
+        QC_MKID_MOD_ALL(set),
         );
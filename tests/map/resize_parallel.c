@@ -0,0 +1,61 @@
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(resize_parallel, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(resize_parallel, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_RESIZE_PARALLEL_THREADS 4
+
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct map other = {0};
+    bool ret = map_new(&other);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++)
+            ret = map_add(&other,
+                    map->table[tblidx].entries[i].key,
+                    map->table[tblidx].entries[i].key / 2);
+
+    if (!ret) {
+        other = map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned n = qc_map_cardinal(map);
+    unsigned new_size = (unsigned) theft_random_choice(t, 1000) + 3;
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_RESIZE_PARALLEL_THREADS) + 1;
+
+    ret = map_resize_parallel(&other, new_size, nthreads)
+        && other.size == new_size
+        && map_cardinal(&other) == n;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = map_contains(&other, key)
+                && map_get(&other, key) == key / 2;
+        }
+
+    other = map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(resize_parallel),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_RESIZE_PARALLEL_THREADS
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
@@ -0,0 +1,77 @@
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(retain, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(retain, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/*
+ * Keeps the entries with an even key, and doubles their values.
+ * Counts how many times it's called in @a ctx
+ */
+static bool qc_retain_even (const int key, int * value, void * ctx)
+{
+    unsigned * calls = ctx;
+    (*calls)++;
+
+    if (key % 2 != 0)
+        return false;
+
+    *value *= 2;
+    return true;
+}
+
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct map other = {0};
+    unsigned odd = 0;
+    bool ret = map_new(&other);
+    (void) t;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = map_add(&other, key, key / 4);
+            odd += key % 2 != 0;
+        }
+
+    if (!ret) {
+        other = map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned n = qc_map_cardinal(map);
+    unsigned calls = 0;
+
+    ret = map_retain(&other, qc_retain_even, &calls) == odd
+        && calls == n
+        && map_cardinal(&other) == n - odd;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = (key % 2 != 0) ?
+                !map_contains(&other, key):
+                map_get(&other, key) == key / 4 * 2;
+        }
+
+    other = map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(retain),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
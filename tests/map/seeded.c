@@ -0,0 +1,144 @@
+/*
+ * A random seed per map, so the hashes of MAP_HASH() (and the ones the
+ * `*_WITH_HASH()` functions get) depend on the map
+ */
+#define QC_CONFIG seeded
+#define MAP_CFG_SEEDED_HASH
+#define MAP_CFG_HASH_INT
+#include "config.c"
+
+#define QC_CONFIG seeded_oa
+#define MAP_CFG_SEEDED_HASH
+#define MAP_CFG_HASH_INT
+#define MAP_CFG_OPEN_ADDRESSING
+#include "config.c"
+
+/* a new seed for every new map, to tell them apart */
+static uint64_t qc_seed_last = 0;
+
+static uint64_t qc_seed_func (void)
+{
+    return ++qc_seed_last;
+}
+
+#define MAP_CFG_MAP qc_seed_map
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#define MAP_CFG_VALUE_DATA_TYPE int
+#define MAP_CFG_SEEDED_HASH
+#define MAP_CFG_HASH_INT
+#define MAP_CFG_SEED_FUNC qc_seed_func
+#include <utils/map.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(seed, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(seed, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+#define QC_SEED_THREADS 4
+
+/*
+ * Checks that @a other has exactly the keys of @a map, with value
+ * `key / 2`
+ */
+static bool qc_seed_map_eq (const struct map * map, const struct qc_seed_map * other)
+{
+    bool ret = true;
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            int value = -1;
+            ret = qc_seed_map_lookup(other, key, &value)
+                && value == key / 2;
+        }
+
+    return ret && qc_seed_map_cardinal(other) == qc_map_cardinal(map);
+}
+
+/*
+ * MAP_RESIZE() and MAP_RESIZE_PARALLEL() move the entries to a new
+ * table, but the map keeps its seed (and the hashes of its entries)
+ */
+static enum theft_trial_res QC_MKID_PROP(resize) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_seed_map other = {0};
+    bool ret = qc_seed_map_new(&other);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = qc_seed_map_add(&other, key, key / 2);
+        }
+
+    if (!ret) {
+        other = qc_seed_map_free(other);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    uint64_t seed = other.seed;
+    unsigned new_size = (unsigned) theft_random_choice(t, 125) + 3;
+    unsigned nthreads = (unsigned) theft_random_choice(t, QC_SEED_THREADS) + 1;
+
+    ret = qc_seed_map_resize(&other, new_size)
+        && other.seed == seed
+        && qc_seed_map_eq(map, &other)
+        && qc_seed_map_resize_parallel(&other, new_size + 1, nthreads)
+        && other.seed == seed
+        && qc_seed_map_eq(map, &other);
+
+    other = qc_seed_map_free(other);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+/*
+ * MAP_NEW() and MAP_WITH_SIZE() pick a new seed with MAP_CFG_SEED_FUNC()
+ */
+static enum theft_trial_res QC_MKID_PROP(new) (struct theft * t, void * arg1)
+{
+    (void) arg1;
+    unsigned size = (unsigned) theft_random_choice(t, 125) + 3;
+    struct qc_seed_map a = {0};
+    struct qc_seed_map b = {0};
+
+    uint64_t last = qc_seed_last;
+    bool ret = qc_seed_map_new(&a)
+        && a.seed == last + 1
+        && qc_seed_map_with_size(&b, size)
+        && b.seed == last + 2;
+
+    /* (so the keys hash differently in each) */
+    bool differ = false;
+    for (int key = 0; ret && !differ && key < 64; key++)
+        differ = qc_seed_map_hash(&a, key) != qc_seed_map_hash(&b, key);
+
+    ret = ret
+        && differ;
+
+    a = qc_seed_map_free(a);
+    b = qc_seed_map_free(b);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(new);
+QC_MKTEST_FUNC(resize);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(seed),
+        QC_MKID_TEST(new),
+        QC_MKID_TEST(resize),
+        );
+
+#undef QC_SEED_THREADS
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC
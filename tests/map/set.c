@@ -0,0 +1,114 @@
+#define MAP_CFG_MAP qc_set
+#define MAP_CFG_HASH_FUNC qc_map_int_hash
+#define MAP_CFG_KEY_CMP qc_map_int_cmp
+#define MAP_CFG_KEY_DATA_TYPE int
+#include <utils/set.h>
+
+#define QC_MKID_PROP(TEST) \
+    QC_MKID_MOD_PROP(set, TEST)
+
+#define QC_MKID_TEST(TEST) \
+    QC_MKID_MOD_TEST(set, TEST)
+
+#define QC_MKTEST_FUNC(TEST)      \
+    QC_MKTEST(QC_MKID_TEST(TEST), \
+            prop1,                \
+            QC_MKID_PROP(TEST),   \
+            &qc_map_info)
+
+/*
+ * Adds the keys of @a map to @a set, all of them or only the even ones
+ */
+static bool qc_set_add_keys (const struct map * map, struct qc_set * set, bool only_even)
+{
+    bool ret = true;
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            if (!only_even || key % 2 == 0)
+                ret = qc_set_add(set, key);
+        }
+    return ret;
+}
+
+static enum theft_trial_res QC_MKID_PROP(res) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_set set = {0};
+    int key = qc_map_random_not_in(map, (int) theft_random_bits(t, 16));
+    bool ret = qc_set_new(&set)
+        && qc_set_add_keys(map, &set, false);
+
+    if (!ret) {
+        set = qc_set_free(set);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    ret = qc_set_cardinal(&set) == qc_map_cardinal(map)
+        && !qc_set_contains(&set, key);
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++)
+            ret = qc_set_contains(&set, map->table[tblidx].entries[i].key);
+
+    set = qc_set_free(set);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+static enum theft_trial_res QC_MKID_PROP(ops) (struct theft * t, void * arg1)
+{
+    const struct map * map = arg1;
+    struct qc_set all = {0};
+    struct qc_set even = {0};
+    struct qc_set odd = {0};
+    (void) t;
+
+    bool ret = qc_set_new(&all)
+        && qc_set_new(&even)
+        && qc_set_new(&odd)
+        && qc_set_add_keys(map, &all, false)
+        && qc_set_add_keys(map, &even, true)
+        && qc_set_union(&odd, &all);
+
+    if (!ret) {
+        all = qc_set_free(all);
+        even = qc_set_free(even);
+        odd = qc_set_free(odd);
+        return THEFT_TRIAL_SKIP;
+    }
+
+    unsigned nall = qc_set_cardinal(&all);
+    unsigned neven = qc_set_cardinal(&even);
+
+    ret = qc_set_cardinal(&odd) == nall
+        && qc_set_difference(&odd, &even)
+        && qc_set_cardinal(&odd) == nall - neven
+        && qc_set_intersection(&all, &even)
+        && qc_set_cardinal(&all) == neven
+        && qc_set_intersection(&odd, &even)
+        && qc_set_is_empty(&odd);
+
+    for (unsigned tblidx = 0; ret && tblidx < map->size; tblidx++)
+        for (unsigned i = 0; ret && i < map->table[tblidx].length; i++) {
+            int key = map->table[tblidx].entries[i].key;
+            ret = qc_set_contains(&all, key) == (key % 2 == 0);
+        }
+
+    all = qc_set_free(all);
+    even = qc_set_free(even);
+    odd = qc_set_free(odd);
+
+    return QC_BOOL2TRIAL(ret);
+}
+
+QC_MKTEST_FUNC(ops);
+QC_MKTEST_FUNC(res);
+
+QC_MKTEST_ALL(QC_MKID_MOD_ALL(set),
+        QC_MKID_TEST(ops),
+        QC_MKID_TEST(res),
+        );
+
+#undef QC_MKID_PROP
+#undef QC_MKID_TEST
+#undef QC_MKTEST_FUNC